@@ -58,6 +58,16 @@ VNOTE_ALL_NOTES_MAP::~VNOTE_ALL_NOTES_MAP()
     }
 }
 
+/**
+ * @brief VNOTE_NOTES_SNAPSHOT_DATA::~VNOTE_NOTES_SNAPSHOT_DATA
+ */
+VNOTE_NOTES_SNAPSHOT_DATA::~VNOTE_NOTES_SNAPSHOT_DATA()
+{
+    for (auto it : retiredNotes) {
+        delete it;
+    }
+}
+
 /**
  * @brief VNOTE_DATAS::~VNOTE_DATAS
  */
@@ -9,6 +9,8 @@
 #include "common/opsstateinterface.h"
 
 #include <QMap>
+#include <QHash>
+#include <QSharedPointer>
 #include <QVector>
 #include <QReadWriteLock>
 #include <QDateTime>
@@ -19,8 +21,9 @@ struct VNoteBlock;
 struct VNOTE_ITEMS_MAP;
 
 typedef QMap<qint64, VNoteFolder *> VNOTE_FOLDERS_DATA_MAP;
-typedef QMap<qint64, VNoteItem *> VNOTE_ITEMS_DATA_MAP;
-typedef QMap<qint64, VNOTE_ITEMS_MAP *> VNOTE_ALL_NOTES_DATA_MAP;
+//记事项按id查找，不依赖id顺序，界面显示时另行排序
+typedef QHash<qint64, VNoteItem *> VNOTE_ITEMS_DATA_MAP;
+typedef QHash<qint64, VNOTE_ITEMS_MAP *> VNOTE_ALL_NOTES_DATA_MAP;
 typedef QVector<VNoteBlock *> VNOTE_DATA_VECTOR;
 
 //记事本数据
@@ -53,6 +56,9 @@ struct VNOTE_ALL_NOTES_MAP {
     ~VNOTE_ALL_NOTES_MAP();
 
     VNOTE_ALL_NOTES_DATA_MAP notes;
+    //note_id全局唯一，按note_id索引所有记事项，不依赖记事本id
+    //只由数据管理类在lock的写锁内维护，记事项在记事本间移动时不需要更新
+    VNOTE_ITEMS_DATA_MAP noteIndex;
     QReadWriteLock lock;
 
     //TODO:
@@ -61,6 +67,51 @@ struct VNOTE_ALL_NOTES_MAP {
     bool autoRelease {false};
 };
 
+//记事项只读快照，按记事本分组，读取时不需要加锁
+//快照生成后被删除的记事项挂在最新的快照上，所有引用它的快照释放后才销毁
+struct VNOTE_NOTES_SNAPSHOT_DATA {
+    ~VNOTE_NOTES_SNAPSHOT_DATA();
+
+    //数据版本
+    quint64 version {0};
+    //按记事本分组的记事项
+    QHash<qint64, QVector<VNoteItem *>> folderNotes;
+    //生成下一版本快照后延迟释放的记事项，只在数据管理类的锁内修改
+    QVector<VNoteItem *> retiredNotes;
+    //较新的快照，旧快照存在时新快照中延迟释放的记事项也不能销毁
+    QSharedPointer<VNOTE_NOTES_SNAPSHOT_DATA> newer;
+};
+
+typedef QSharedPointer<const VNOTE_NOTES_SNAPSHOT_DATA> VNOTE_NOTES_SNAPSHOT;
+
+//分批加载记事项的查询范围，按note_id递增分页
+struct VNOTE_NOTES_RANGE {
+    //只查询该记事本，-1不限制
+    qint64 folderId {-1};
+    //排除该记事本，-1不排除
+    qint64 excludeFolderId {-1};
+    //只查询id大于该值的记事项
+    qint32 afterNoteId {0};
+    //最大数量，-1不限制
+    qint32 limit {-1};
+};
+
+//记事项正文缓存统计
+struct VNOTE_BODY_CACHE_STATS {
+    //正文已在内存中
+    qint64 hits {0};
+    //从数据库加载正文
+    qint64 misses {0};
+    //超出内存预算释放的正文数
+    qint64 evictions {0};
+    //缓存中的正文数
+    qint32 notesResident {0};
+    //缓存中正文估算占用的字节数
+    qint64 bytesResident {0};
+    //内存预算，0不限制
+    qint64 budgetBytes {0};
+};
+
 struct VNOTE_DATAS {
     ~VNOTE_DATAS();
 
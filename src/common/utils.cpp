@@ -17,6 +17,91 @@
 #include <QBuffer>
 #include <QFileInfo>
 #include <QProcess>
+#include <QCryptographicHash>
+#include <QtEndian>
+
+namespace {
+//转义字符最大长度，超过时不再查找结尾的';'
+const int MAX_ENTITY_LENGTH = 10;
+
+/**
+ * @brief isBlockEndTag
+ * @param name 标签名
+ * @param isEndTag true 结束标签
+ * @return true 需要换行
+ */
+bool isBlockEndTag(const QStringRef &name, bool isEndTag)
+{
+    static const char *const blockTags[] = {"p", "div", "li", "h1", "h2", "h3", "h4", "h5", "h6"};
+
+    if (0 == name.compare(QLatin1String("br"), Qt::CaseInsensitive)) {
+        return true;
+    }
+
+    if (isEndTag) {
+        for (auto tag : blockTags) {
+            if (0 == name.compare(QLatin1String(tag), Qt::CaseInsensitive)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief isRawTextTag
+ * @param name 标签名
+ * @return true 内容不是正文的标签
+ */
+bool isRawTextTag(const QStringRef &name)
+{
+    return 0 == name.compare(QLatin1String("script"), Qt::CaseInsensitive)
+           || 0 == name.compare(QLatin1String("style"), Qt::CaseInsensitive);
+}
+
+/**
+ * @brief decodeEntity
+ * @param entity 去掉'&'和';'的转义字符
+ * @param text 转换结果追加到文本中
+ * @return true 转换成功
+ */
+bool decodeEntity(const QStringRef &entity, QString &text)
+{
+    if (entity.startsWith('#')) {
+        bool isOK = false;
+        bool isHex = entity.size() > 1 && ('x' == entity.at(1) || 'X' == entity.at(1));
+        uint code = isHex ? entity.mid(2).toUInt(&isOK, 16) : entity.mid(1).toUInt(&isOK, 10);
+
+        if (!isOK || 0 == code || code > 0x10FFFF) {
+            return false;
+        }
+
+        //不换行空格按普通空格处理，与QTextDocument::toPlainText一致
+        if (0xA0 == code) {
+            text.append(' ');
+        } else {
+            text.append(QString::fromUcs4(&code, 1));
+        }
+
+        return true;
+    }
+
+    static const struct {
+        const char *name;
+        char ch;
+    } namedEntities[] = {{"nbsp", ' '}, {"lt", '<'}, {"gt", '>'}, {"quot", '"'}, {"apos", '\''}, {"amp", '&'}};
+
+    for (auto &it : namedEntities) {
+        if (entity == QLatin1String(it.name)) {
+            text.append(QLatin1Char(it.ch));
+            return true;
+        }
+    }
+
+    return false;
+}
+} // namespace
 
 Utils::Utils()
 {
@@ -342,3 +427,111 @@ bool Utils::isWayland()
 {
     return qApp->platformName() == "dwayland" || qApp->property("_d_isDwayland").toBool();
 }
+
+/**
+ * @brief Utils::htmlToPlainText
+ * 逐字符扫描一遍，去除标签并转换转义字符，不创建QTextDocument，可在非界面线程使用
+ * @param html 富文本内容
+ * @return 纯文本
+ */
+QString Utils::htmlToPlainText(const QString &html)
+{
+    QString text;
+    const int size = html.size();
+    int pos = 0;
+
+    text.reserve(size);
+
+    while (pos < size) {
+        QChar ch = html.at(pos);
+
+        if ('<' == ch) {
+            int tagEnd = html.indexOf('>', pos + 1);
+
+            //未闭合的'<'按文字保留
+            if (tagEnd < 0) {
+                text.append(html.midRef(pos));
+                break;
+            }
+
+            if (html.midRef(pos + 1, 3) == QLatin1String("!--")) {
+                int commentEnd = html.indexOf(QLatin1String("-->"), pos + 4);
+                pos = (commentEnd < 0) ? size : commentEnd + 3;
+                continue;
+            }
+
+            int nameStart = pos + 1;
+            bool isEndTag = (nameStart < tagEnd && '/' == html.at(nameStart));
+
+            if (isEndTag) {
+                nameStart++;
+            }
+
+            int nameEnd = nameStart;
+
+            while (nameEnd < tagEnd && html.at(nameEnd).isLetterOrNumber()) {
+                nameEnd++;
+            }
+
+            QStringRef name = html.midRef(nameStart, nameEnd - nameStart);
+
+            if (isBlockEndTag(name, isEndTag)) {
+                //块级标签结束时换行，避免相邻段落的文字连在一起
+                text.append('\n');
+            } else if (!isEndTag && isRawTextTag(name)) {
+                //脚本和样式的内容不是正文
+                int closeTag = html.indexOf(QLatin1String("</") + name.toString(), tagEnd + 1, Qt::CaseInsensitive);
+                tagEnd = (closeTag < 0) ? -1 : html.indexOf('>', closeTag);
+
+                if (tagEnd < 0) {
+                    break;
+                }
+            }
+
+            pos = tagEnd + 1;
+        } else if ('&' == ch) {
+            int entityEnd = -1;
+
+            for (int i = pos + 1; i < size && i - pos <= MAX_ENTITY_LENGTH; i++) {
+                if (';' == html.at(i)) {
+                    entityEnd = i;
+                    break;
+                }
+            }
+
+            //不支持的转义字符按原文保留
+            if (entityEnd > 0 && decodeEntity(html.midRef(pos + 1, entityEnd - pos - 1), text)) {
+                pos = entityEnd + 1;
+            } else {
+                text.append(ch);
+                pos++;
+            }
+        } else {
+            //连续的文字一次追加
+            int textEnd = pos + 1;
+
+            while (textEnd < size && '<' != html.at(textEnd) && '&' != html.at(textEnd)) {
+                textEnd++;
+            }
+
+            text.append(html.constData() + pos, textEnd - pos);
+            pos = textEnd;
+        }
+    }
+
+    return text;
+}
+
+/**
+ * @brief Utils::contentHash
+ * 取MD5的前8个字节，0保留表示未知
+ * @param content 内容
+ * @return 哈希值
+ */
+qint64 Utils::contentHash(const QString &content)
+{
+    QByteArray digest = QCryptographicHash::hash(content.toUtf8(), QCryptographicHash::Md5);
+    qint64 hash = qFromBigEndian<qint64>(reinterpret_cast<const uchar *>(digest.constData()));
+
+    return (0 == hash) ? 1 : hash;
+}
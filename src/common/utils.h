@@ -47,4 +47,8 @@ public:
     static QString filteredFileName(QString fileName, const QString &defaultName = "");
     //判断是否wayland
     static bool isWayland();
+    //提取html中的纯文本，用于搜索、导出和全文索引
+    static QString htmlToPlainText(const QString &html);
+    //计算内容哈希，用于判断笔记内容是否变化
+    static qint64 contentHash(const QString &content);
 };
@@ -10,9 +10,14 @@
 #include "task/loadiconsworker.h"
 #include "vnoteforlder.h"
 #include "vnoteitem.h"
+#include "vnotesearchindex.h"
+#include "setting.h"
+#include "globaldef.h"
 
 #include <DLog>
 
+#include <QSet>
+#include <QThread>
 #include <QThreadPool>
 
 DCORE_USE_NAMESPACE
@@ -26,6 +31,7 @@ VNoteDataManager *VNoteDataManager::_instance = nullptr;
 VNoteDataManager::VNoteDataManager(QObject *parent)
     : QObject(parent)
 {
+    m_bodyCacheStats.budgetBytes = DEFAULT_BODY_CACHE_BUDGET;
 }
 
 /**
@@ -115,6 +121,7 @@ VNoteFolder *VNoteDataManager::getFolder(qint64 folderId)
 VNoteFolder *VNoteDataManager::delFolder(qint64 folderId)
 {
     VNoteFolder *retFlder = nullptr;
+    VNOTE_ITEMS_MAP *itemsMap = nullptr;
 
     m_qspNoteFoldersMap->lock.lockForWrite();
 
@@ -122,23 +129,20 @@ VNoteFolder *VNoteDataManager::delFolder(qint64 folderId)
     VNOTE_FOLDERS_DATA_MAP::iterator itFolder = m_qspNoteFoldersMap->folders.find(folderId);
 
     if (itFolder != m_qspNoteFoldersMap->folders.end()) {
-        //Get notes lock ,release all notes in the folder
+        //锁内只摘除数据
         m_qspAllNotesMap->lock.lockForWrite();
 
         VNOTE_ALL_NOTES_DATA_MAP::iterator itNote = m_qspAllNotesMap->notes.find(folderId);
 
         if (itNote != m_qspAllNotesMap->notes.end()) {
-            VNOTE_ITEMS_MAP *itemsMap = itNote.value();
+            itemsMap = itNote.value();
             m_qspAllNotesMap->notes.erase(itNote);
-            QScopedPointer<VNOTE_ITEMS_MAP> foldersMap(itemsMap);
 
-            //Remove voice files in the folder
-            for (auto it : foldersMap->folderNotes) {
-                it->delNoteData();
+            for (auto it = itemsMap->folderNotes.begin(); it != itemsMap->folderNotes.end(); ++it) {
+                m_qspAllNotesMap->noteIndex.remove(it.key());
             }
         }
 
-        //All note released. unlock
         m_qspAllNotesMap->lock.unlock();
 
         retFlder = *itFolder;
@@ -147,6 +151,22 @@ VNoteFolder *VNoteDataManager::delFolder(qint64 folderId)
 
     m_qspNoteFoldersMap->lock.unlock();
 
+    if (nullptr != itemsMap) {
+        updateSnapshotNotes([folderId](QHash<qint64, QVector<VNoteItem *>> &folderNotes) {
+            folderNotes.remove(folderId);
+        });
+
+        //删除语音文件不占用锁，记事项由快照延迟释放
+        for (auto it : itemsMap->folderNotes) {
+            it->delNoteData();
+            VNoteSearchIndex::instance()->removeNote(it->noteId);
+            releaseNote(it);
+        }
+
+        itemsMap->folderNotes.clear();
+        delete itemsMap;
+    }
+
     return retFlder;
 }
 
@@ -171,6 +191,7 @@ qint32 VNoteDataManager::folderCount()
 VNoteItem *VNoteDataManager::addNote(VNoteItem *note)
 {
     VNoteItem *retNote = nullptr;
+    VNoteItem *oldNote = nullptr;
 
     if (nullptr != note) {
         m_qspAllNotesMap->lock.lockForWrite();
@@ -195,7 +216,7 @@ VNoteItem *VNoteDataManager::addNote(VNoteItem *note)
                 notesInFolder->folderNotes.insert(note->noteId, note);
             } else {
                 //Release old and insert new
-                QScopedPointer<VNoteItem> release(*noteIter);
+                oldNote = *noteIter;
 
                 notesInFolder->folderNotes.remove(note->noteId);
                 notesInFolder->folderNotes.insert(note->noteId, note);
@@ -214,9 +235,29 @@ VNoteItem *VNoteDataManager::addNote(VNoteItem *note)
             m_qspAllNotesMap->notes.insert(note->folderId, folderNotes);
         }
 
+        m_qspAllNotesMap->noteIndex.insert(note->noteId, note);
+
         m_qspAllNotesMap->lock.unlock();
 
+        updateSnapshotNotes([note, oldNote](QHash<qint64, QVector<VNoteItem *>> &folderNotes) {
+            QVector<VNoteItem *> &notes = folderNotes[note->folderId];
+            int index = (nullptr == oldNote) ? -1 : notes.indexOf(oldNote);
+
+            if (index >= 0) {
+                notes[index] = note;
+            } else {
+                notes.append(note);
+            }
+        });
+        adjustFolderStats(note->folderId, (nullptr == oldNote) ? 1 : 0, note->modifyTime);
+
+        if (nullptr != oldNote && oldNote != note) {
+            releaseNote(oldNote);
+        }
+
         retNote = note;
+
+        emit noteAdded(note->folderId, note->noteId);
     }
 
     return retNote;
@@ -230,35 +271,33 @@ VNoteItem *VNoteDataManager::addNote(VNoteItem *note)
  */
 VNoteItem *VNoteDataManager::getNote(qint64 folderId, qint32 noteId)
 {
-    VNoteItem *retNote = nullptr;
-
-    m_qspAllNotesMap->lock.lockForRead();
+    VNoteItem *retNote = getNote(noteId);
 
-    //Find the folder first. if can't find, may some goes to wrong
-    VNOTE_ALL_NOTES_DATA_MAP::iterator it = m_qspAllNotesMap->notes.find(folderId);
-
-    if (it != m_qspAllNotesMap->notes.end()) {
-        VNOTE_ITEMS_MAP *notesInFolder = *it;
-
-        Q_ASSERT(nullptr != notesInFolder);
-
-        //TODO:
-        //    Need lock the folder first,for muti-thread operation.
-        //But new maybe not necessary
-        notesInFolder->lock.lockForRead();
+    //记事项不在该记事本中
+    if (nullptr != retNote && retNote->folderId != folderId) {
+        qCritical() << __FUNCTION__ << "Get note failed: the note not in folder:" << folderId << noteId;
+        retNote = nullptr;
+    }
 
-        //Find the note
-        VNOTE_ITEMS_DATA_MAP::iterator noteIter = notesInFolder->folderNotes.find(noteId);
+    return retNote;
+}
 
-        if (noteIter != notesInFolder->folderNotes.end()) {
-            retNote = *noteIter;
-        }
+/**
+ * @brief VNoteDataManager::getNote
+ * 通过全局索引查找，不需要记事本id
+ * @param noteId
+ * @return 记事项数据
+ */
+VNoteItem *VNoteDataManager::getNote(qint32 noteId)
+{
+    VNoteItem *retNote = nullptr;
 
-        notesInFolder->lock.unlock();
-    } else {
-        qCritical() << __FUNCTION__ << "Get note failed: the folder don't exist:" << folderId;
+    if (m_qspAllNotesMap == nullptr) {
+        return retNote;
     }
 
+    m_qspAllNotesMap->lock.lockForRead();
+    retNote = m_qspAllNotesMap->noteIndex.value(noteId, nullptr);
     m_qspAllNotesMap->lock.unlock();
 
     return retNote;
@@ -295,9 +334,7 @@ VNoteItem *VNoteDataManager::delNote(qint64 folderId, qint32 noteId)
         if (noteIter != notesInFolder->folderNotes.end()) {
             retNote = *noteIter;
             notesInFolder->folderNotes.erase(noteIter);
-
-            //Remove voice file of voice note
-            retNote->delNoteData();
+            m_qspAllNotesMap->noteIndex.remove(noteId);
         }
 
         notesInFolder->lock.unlock();
@@ -307,6 +344,36 @@ VNoteItem *VNoteDataManager::delNote(qint64 folderId, qint32 noteId)
 
     m_qspAllNotesMap->lock.unlock();
 
+    if (nullptr != retNote) {
+        updateSnapshotNotes([folderId, retNote](QHash<qint64, QVector<VNoteItem *>> &folderNotes) {
+            QHash<qint64, QVector<VNoteItem *>>::iterator it = folderNotes.find(folderId);
+
+            if (it != folderNotes.end()) {
+                it->removeOne(retNote);
+            }
+        });
+
+        //删除的是最后修改的记事项时重新统计该记事本
+        if (m_qspNoteFoldersMap != nullptr) {
+            m_qspNoteFoldersMap->lock.lockForRead();
+            VNoteFolder *folder = m_qspNoteFoldersMap->folders.value(folderId, nullptr);
+            bool needRebuild = (nullptr != folder && retNote->modifyTime >= folder->lastNoteModifyTime);
+            m_qspNoteFoldersMap->lock.unlock();
+
+            if (needRebuild) {
+                rebuildFolderStats(folderId);
+            } else {
+                adjustFolderStats(folderId, -1, QDateTime());
+            }
+        }
+
+        //Remove voice file of voice note
+        retNote->delNoteData();
+        VNoteSearchIndex::instance()->removeNote(noteId);
+
+        emit noteDeleted(folderId, noteId);
+    }
+
     return retNote;
 }
 
@@ -426,17 +493,194 @@ void VNoteDataManager::reqNoteFolders()
  */
 void VNoteDataManager::reqNoteItems()
 {
-    if (m_pNotesLoadThread == nullptr) {
-        m_pNotesLoadThread = new LoadNoteItemsWorker();
+    m_notesRequested = true;
+
+    if (m_fDataState & DataState::FolderDataReady) {
+        startLoadNotes();
+    }
+}
+
+/**
+ * @brief VNoteDataManager::startLoadNotes
+ */
+void VNoteDataManager::startLoadNotes()
+{
+    if (m_notesRequested && m_pNotesLoadThread == nullptr) {
+        m_notesRequested = false;
+
+        m_pNotesLoadThread = new LoadNoteItemsWorker(priorityFolderId());
         m_pNotesLoadThread->setAutoDelete(true);
 
+        connect(m_pNotesLoadThread, &LoadNoteItemsWorker::onNotesBatchLoaded,
+                this, &VNoteDataManager::onNotesBatchLoaded);
         connect(m_pNotesLoadThread, &LoadNoteItemsWorker::onAllNotesLoaded,
-                this, &VNoteDataManager::onAllNotesLoaded);
+                this, &VNoteDataManager::onNotesLoadFinished);
 
         QThreadPool::globalInstance()->start(m_pNotesLoadThread);
     }
 }
 
+/**
+ * @brief VNoteDataManager::priorityFolderId
+ * 记事本列表按保存的排序显示，没有排序时按创建时间从新到旧显示
+ * @return 列表中第一个记事本的id，没有记事本时返回-1
+ */
+qint64 VNoteDataManager::priorityFolderId()
+{
+    qint64 folderId = -1;
+
+    if (nullptr == m_qspNoteFoldersMap) {
+        return folderId;
+    }
+
+    QStringList sortFolders = setting::instance()->getOption(VNOTE_FOLDER_SORT).toString().split(",");
+
+    m_qspNoteFoldersMap->lock.lockForRead();
+
+    for (auto it : sortFolders) {
+        if (m_qspNoteFoldersMap->folders.contains(it.toLongLong())) {
+            folderId = it.toLongLong();
+            break;
+        }
+    }
+
+    if (-1 == folderId) {
+        QDateTime newestTime;
+
+        for (auto it : m_qspNoteFoldersMap->folders) {
+            if (-1 == folderId || it->createTime > newestTime) {
+                folderId = it->id;
+                newestTime = it->createTime;
+            }
+        }
+    }
+
+    m_qspNoteFoldersMap->lock.unlock();
+
+    return folderId;
+}
+
+/**
+ * @brief VNoteDataManager::adjustFolderStats
+ * 加载线程和界面线程都会调用，在记事本数据的写锁内修改
+ * @param folderId 记事本id
+ * @param countDelta 记事项数的变化
+ * @param modifyTime 记事项修改时间，比当前值新时更新
+ */
+void VNoteDataManager::adjustFolderStats(qint64 folderId, qint32 countDelta, const QDateTime &modifyTime)
+{
+    if (m_qspNoteFoldersMap == nullptr) {
+        return;
+    }
+
+    m_qspNoteFoldersMap->lock.lockForWrite();
+
+    VNoteFolder *folder = m_qspNoteFoldersMap->folders.value(folderId, nullptr);
+
+    if (nullptr != folder) {
+        folder->notesCount = qMax(Q_INT64_C(0), folder->notesCount + countDelta);
+
+        if (modifyTime.isValid() && modifyTime > folder->lastNoteModifyTime) {
+            folder->lastNoteModifyTime = modifyTime;
+        }
+    }
+
+    m_qspNoteFoldersMap->lock.unlock();
+}
+
+/**
+ * @brief VNoteDataManager::updateFolderModifyTime
+ * @param note 修改后的记事项
+ */
+void VNoteDataManager::updateFolderModifyTime(const VNoteItem *note)
+{
+    if (nullptr != note) {
+        adjustFolderStats(note->folderId, 0, note->modifyTime);
+    }
+}
+
+/**
+ * @brief VNoteDataManager::notifyNoteUpdated
+ * @param note 修改后的记事项
+ * @param fields 修改的字段，NoteField组合
+ */
+void VNoteDataManager::notifyNoteUpdated(const VNoteItem *note, int fields)
+{
+    if (nullptr == note) {
+        return;
+    }
+
+    if (fields & NoteModifyTimeField) {
+        updateFolderModifyTime(note);
+    }
+
+    emit noteUpdated(note->folderId, note->noteId, fields);
+}
+
+/**
+ * @brief VNoteDataManager::notifyNotePinned
+ * @param note 修改后的记事项
+ */
+void VNoteDataManager::notifyNotePinned(const VNoteItem *note)
+{
+    if (nullptr != note) {
+        emit notePinned(note->folderId, note->noteId, note->isTop);
+    }
+}
+
+/**
+ * @brief VNoteDataManager::rebuildFolderStats
+ * 加载数据或删除记事项后遍历记事项重新统计，修改记事本数据需持有写锁
+ * @param folderId 记事本id，-1统计所有记事本
+ */
+void VNoteDataManager::rebuildFolderStats(qint64 folderId)
+{
+    if (m_qspNoteFoldersMap == nullptr) {
+        return;
+    }
+
+    m_qspNoteFoldersMap->lock.lockForWrite();
+
+    if (m_qspAllNotesMap != nullptr) {
+        m_qspAllNotesMap->lock.lockForRead();
+    }
+
+    for (auto folder : m_qspNoteFoldersMap->folders) {
+        if (folderId != -1 && folder->id != folderId) {
+            continue;
+        }
+
+        folder->notesCount = 0;
+        folder->lastNoteModifyTime = QDateTime();
+
+        VNOTE_ITEMS_MAP *folderNotes = (m_qspAllNotesMap != nullptr)
+                                           ? m_qspAllNotesMap->notes.value(folder->id, nullptr)
+                                           : nullptr;
+
+        if (nullptr == folderNotes) {
+            continue;
+        }
+
+        folderNotes->lock.lockForRead();
+
+        folder->notesCount = folderNotes->folderNotes.size();
+
+        for (auto note : folderNotes->folderNotes) {
+            if (note->modifyTime > folder->lastNoteModifyTime) {
+                folder->lastNoteModifyTime = note->modifyTime;
+            }
+        }
+
+        folderNotes->lock.unlock();
+    }
+
+    if (m_qspAllNotesMap != nullptr) {
+        m_qspAllNotesMap->lock.unlock();
+    }
+
+    m_qspNoteFoldersMap->lock.unlock();
+}
+
 /**
  * @brief VNoteDataManager::getAllNotesInFolder
  * @return 所有记事本的记事项数据
@@ -446,6 +690,349 @@ VNOTE_ALL_NOTES_MAP *VNoteDataManager::getAllNotesInFolder()
     return m_qspAllNotesMap.get();
 }
 
+/**
+ * @brief VNoteDataManager::moveNotes
+ * 只修改内存数据，数据库由调用方更新
+ * @param notes 记事项
+ * @param destFolderId 目标记事本id
+ * @return true 成功
+ */
+bool VNoteDataManager::moveNotes(const QList<VNoteItem *> &notes, qint64 destFolderId)
+{
+    if (m_qspAllNotesMap == nullptr) {
+        return false;
+    }
+
+    //记事本id->移出的记事项
+    QHash<qint64, QSet<VNoteItem *>> movedOutNotes;
+    //记事本id->移出的记事项数
+    QHash<qint64, qint32> movedCounts;
+    //移动的记事项id及原记事本id，解锁后发送通知
+    QList<QPair<qint32, qint64>> movedNotes;
+    qint32 movedInCount = 0;
+    QDateTime lastModifyTime;
+
+    m_qspAllNotesMap->lock.lockForWrite();
+
+    VNOTE_ITEMS_MAP *destNotes = m_qspAllNotesMap->notes.value(destFolderId, nullptr);
+
+    if (nullptr == destNotes) {
+        destNotes = new VNOTE_ITEMS_MAP();
+        destNotes->autoRelease = true;
+        m_qspAllNotesMap->notes.insert(destFolderId, destNotes);
+    }
+
+    for (auto note : notes) {
+        if (nullptr == note || note->folderId == destFolderId) {
+            continue;
+        }
+
+        VNOTE_ITEMS_MAP *srcNotes = m_qspAllNotesMap->notes.value(note->folderId, nullptr);
+
+        if (nullptr != srcNotes) {
+            srcNotes->lock.lockForWrite();
+            srcNotes->folderNotes.remove(note->noteId);
+            srcNotes->lock.unlock();
+        }
+
+        movedCounts[note->folderId]++;
+        movedOutNotes[note->folderId].insert(note);
+        movedNotes.append(qMakePair(note->noteId, note->folderId));
+
+        destNotes->lock.lockForWrite();
+        note->folderId = destFolderId;
+        destNotes->folderNotes.insert(note->noteId, note);
+        destNotes->lock.unlock();
+
+        movedInCount++;
+
+        if (note->modifyTime > lastModifyTime) {
+            lastModifyTime = note->modifyTime;
+        }
+    }
+
+    m_qspAllNotesMap->lock.unlock();
+
+    if (movedInCount > 0) {
+        //每个源记事本的列表只过滤一次
+        updateSnapshotNotes([&movedOutNotes, destFolderId](QHash<qint64, QVector<VNoteItem *>> &folderNotes) {
+            QVector<VNoteItem *> movedInNotes;
+
+            for (auto it = movedOutNotes.begin(); it != movedOutNotes.end(); ++it) {
+                QHash<qint64, QVector<VNoteItem *>>::iterator srcIt = folderNotes.find(it.key());
+
+                if (srcIt != folderNotes.end()) {
+                    QVector<VNoteItem *> remainNotes;
+                    remainNotes.reserve(srcIt->size());
+
+                    for (auto note : *srcIt) {
+                        if (!it->contains(note)) {
+                            remainNotes.append(note);
+                        }
+                    }
+
+                    srcIt->swap(remainNotes);
+                }
+
+                for (auto note : *it) {
+                    movedInNotes.append(note);
+                }
+            }
+
+            folderNotes[destFolderId] += movedInNotes;
+        });
+
+        //源记事本的最后修改时间可能变化，重新统计
+        for (auto it = movedCounts.begin(); it != movedCounts.end(); ++it) {
+            rebuildFolderStats(it.key());
+        }
+
+        adjustFolderStats(destFolderId, movedInCount, lastModifyTime);
+
+        for (auto it : movedNotes) {
+            emit noteMoved(it.first, it.second, destFolderId);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteDataManager::notesSnapshot
+ * 快照数据与写入方隐式共享，生成快照不复制记事项列表
+ * @return 记事项只读快照
+ */
+VNOTE_NOTES_SNAPSHOT VNoteDataManager::notesSnapshot()
+{
+    QMutexLocker locker(&m_snapshotLock);
+
+    QSharedPointer<VNOTE_NOTES_SNAPSHOT_DATA> latest = m_latestSnapshot.toStrongRef();
+
+    if (!latest.isNull() && latest->version == m_notesVersion) {
+        return latest;
+    }
+
+    QSharedPointer<VNOTE_NOTES_SNAPSHOT_DATA> snapshot(new VNOTE_NOTES_SNAPSHOT_DATA());
+    snapshot->version = m_notesVersion;
+    snapshot->folderNotes = m_snapshotNotes;
+
+    //旧快照持有新快照，保证旧快照释放前新快照中延迟释放的记事项仍然有效
+    if (!latest.isNull()) {
+        latest->newer = snapshot;
+    }
+
+    m_latestSnapshot = snapshot;
+
+    return snapshot;
+}
+
+/**
+ * @brief VNoteDataManager::updateSnapshotNotes
+ * 已发布的快照仍在使用时，修改的记事本列表在此复制，其余列表继续共享
+ * @param change 修改快照数据
+ */
+void VNoteDataManager::updateSnapshotNotes(const std::function<void(QHash<qint64, QVector<VNoteItem *>> &)> &change)
+{
+    QMutexLocker locker(&m_snapshotLock);
+
+    change(m_snapshotNotes);
+    m_notesVersion++;
+}
+
+/**
+ * @brief VNoteDataManager::releaseNote
+ * 调用前记事项需已从数据中移除
+ * @param note 记事项
+ */
+void VNoteDataManager::releaseNote(VNoteItem *note)
+{
+    if (nullptr == note) {
+        return;
+    }
+
+    forgetNoteBody(note);
+
+    QMutexLocker locker(&m_snapshotLock);
+
+    QSharedPointer<VNOTE_NOTES_SNAPSHOT_DATA> latest = m_latestSnapshot.toStrongRef();
+
+    if (!latest.isNull()) {
+        latest->retiredNotes.append(note);
+    } else {
+        delete note;
+    }
+}
+
+/**
+ * @brief VNoteDataManager::setBodyCacheBudget
+ * 预算变小时在下次访问正文时释放
+ * @param bytes 内存预算，0不限制
+ */
+void VNoteDataManager::setBodyCacheBudget(qint64 bytes)
+{
+    QMutexLocker locker(&m_bodyCacheLock);
+
+    m_bodyCacheStats.budgetBytes = qMax(Q_INT64_C(0), bytes);
+}
+
+/**
+ * @brief VNoteDataManager::pinNoteBody
+ * @param note 记事项
+ */
+void VNoteDataManager::pinNoteBody(VNoteItem *note)
+{
+    if (nullptr == note) {
+        return;
+    }
+
+    QMutexLocker locker(&m_bodyCacheLock);
+
+    m_pinnedBodies[note]++;
+}
+
+/**
+ * @brief VNoteDataManager::unpinNoteBody
+ * 可能在导出线程中调用，此处不释放正文，超出的预算在下次访问正文时处理
+ * @param note 记事项
+ */
+void VNoteDataManager::unpinNoteBody(VNoteItem *note)
+{
+    QMutexLocker locker(&m_bodyCacheLock);
+
+    auto it = m_pinnedBodies.find(note);
+
+    if (it != m_pinnedBodies.end() && --it.value() <= 0) {
+        m_pinnedBodies.erase(it);
+    }
+}
+
+/**
+ * @brief VNoteDataManager::bodyCacheStats
+ * @return 正文缓存统计
+ */
+VNOTE_BODY_CACHE_STATS VNoteDataManager::bodyCacheStats()
+{
+    QMutexLocker locker(&m_bodyCacheLock);
+
+    VNOTE_BODY_CACHE_STATS stats = m_bodyCacheStats;
+    stats.notesResident = m_bodyEntries.size();
+
+    return stats;
+}
+
+/**
+ * @brief VNoteDataManager::touchNoteBody
+ * 只缓存数据管理中的记事项，临时对象不计入。
+ * 界面线程读取正文时不加锁，释放只在界面线程进行，后台线程访问时排队释放
+ * @param note 记事项
+ * @param isHit true 正文已在内存中
+ */
+void VNoteDataManager::touchNoteBody(VNoteItem *note, bool isHit)
+{
+    if (nullptr == note || getNote(note->noteId) != note) {
+        return;
+    }
+
+    QMutexLocker locker(&m_bodyCacheLock);
+
+    if (isHit) {
+        m_bodyCacheStats.hits++;
+    } else {
+        m_bodyCacheStats.misses++;
+    }
+
+    //编辑后正文大小会变化，每次访问重新估算
+    qint64 size = note->bodySize();
+    auto it = m_bodyEntries.find(note);
+
+    if (it != m_bodyEntries.end()) {
+        m_bodyCacheStats.bytesResident -= it->size;
+        m_bodyLru.splice(m_bodyLru.begin(), m_bodyLru, it->lruIter);
+        it->size = size;
+    } else {
+        m_bodyLru.push_front(note);
+
+        BodyCacheEntry entry;
+        entry.lruIter = m_bodyLru.begin();
+        entry.size = size;
+        m_bodyEntries.insert(note, entry);
+    }
+
+    m_bodyCacheStats.bytesResident += size;
+
+    if (QThread::currentThread() == thread()) {
+        evictNoteBodies(note);
+    } else if (!m_evictionScheduled && m_bodyCacheStats.budgetBytes > 0
+               && m_bodyCacheStats.bytesResident > m_bodyCacheStats.budgetBytes) {
+        m_evictionScheduled = true;
+        QMetaObject::invokeMethod(this, "onEvictNoteBodies", Qt::QueuedConnection);
+    }
+}
+
+/**
+ * @brief VNoteDataManager::onEvictNoteBodies
+ */
+void VNoteDataManager::onEvictNoteBodies()
+{
+    QMutexLocker locker(&m_bodyCacheLock);
+
+    m_evictionScheduled = false;
+    evictNoteBodies(nullptr);
+}
+
+/**
+ * @brief VNoteDataManager::forgetNoteBody
+ * @param note 记事项
+ */
+void VNoteDataManager::forgetNoteBody(VNoteItem *note)
+{
+    QMutexLocker locker(&m_bodyCacheLock);
+
+    auto it = m_bodyEntries.find(note);
+
+    if (it != m_bodyEntries.end()) {
+        m_bodyCacheStats.bytesResident -= it->size;
+        m_bodyLru.erase(it->lruIter);
+        m_bodyEntries.erase(it);
+    }
+
+    m_pinnedBodies.remove(note);
+}
+
+/**
+ * @brief VNoteDataManager::evictNoteBodies
+ * 从最久未使用的记事项开始释放，跳过固定的和当前访问的记事项。
+ * 编辑中和后台使用中的记事项已固定，固定检查与释放在同一临界区内
+ * @param current 当前访问的记事项
+ */
+void VNoteDataManager::evictNoteBodies(const VNoteItem *current)
+{
+    if (m_bodyCacheStats.budgetBytes <= 0) {
+        return;
+    }
+
+    auto it = m_bodyLru.end();
+
+    while (m_bodyCacheStats.bytesResident > m_bodyCacheStats.budgetBytes && it != m_bodyLru.begin()) {
+        --it;
+
+        VNoteItem *note = *it;
+
+        if (note == current || m_pinnedBodies.contains(note)) {
+            continue;
+        }
+
+        m_bodyCacheStats.bytesResident -= m_bodyEntries.value(note).size;
+        m_bodyEntries.remove(note);
+        it = m_bodyLru.erase(it);
+
+        //老版本数据不释放，只移出缓存
+        if (note->releaseBody()) {
+            m_bodyCacheStats.evictions++;
+        }
+    }
+}
+
 /**
  * @brief VNoteDataManager::onFoldersLoaded
  * @param foldesMap 记事本数据
@@ -469,6 +1056,7 @@ void VNoteDataManager::onFoldersLoaded(VNOTE_FOLDERS_MAP *foldesMap)
     }
 
     m_qspNoteFoldersMap.reset(foldesMap);
+    rebuildFolderStats();
 
     qInfo() << "Loaded new foldersMap:" << m_qspNoteFoldersMap.get()
             << " size:" << m_qspNoteFoldersMap->folders.size();
@@ -485,50 +1073,126 @@ void VNoteDataManager::onFoldersLoaded(VNOTE_FOLDERS_MAP *foldesMap)
     if (isAllDatasReady()) {
         emit onAllDatasReady();
     }
+
+    startLoadNotes();
 }
 
 /**
- * @brief VNoteDataManager::onAllNotesLoaded
- * @param notesMap 笔记数据
+ * @brief VNoteDataManager::onNotesBatchLoaded
+ * 内存中已有的笔记(如加载期间新建的)保持不变，丢弃批次中的重复数据
+ * @param notesMap 一批笔记数据
  */
-void VNoteDataManager::onAllNotesLoaded(VNOTE_ALL_NOTES_MAP *notesMap)
+void VNoteDataManager::onNotesBatchLoaded(VNOTE_ALL_NOTES_MAP *notesMap)
 {
-    //Release old data
-    if (m_qspAllNotesMap != nullptr) {
-        qInfo() << "Release old notesMap:" << m_qspAllNotesMap.get()
-                << "All notes in folders:" << m_qspAllNotesMap->notes.size();
+    if (nullptr == notesMap) {
+        return;
+    }
 
-        m_qspAllNotesMap->lock.lockForWrite();
+    if (m_qspAllNotesMap == nullptr) {
+        m_qspAllNotesMap.reset(new VNOTE_ALL_NOTES_MAP());
+        m_qspAllNotesMap->autoRelease = true;
+    }
 
-        for (auto folderNotes : m_qspAllNotesMap->notes) {
-            for (auto note : folderNotes->folderNotes) {
-                delete note;
+    QList<VNoteItem *> newNotes;
+
+    m_qspAllNotesMap->lock.lockForWrite();
+
+    VNOTE_ITEMS_DATA_MAP &noteIndex = m_qspAllNotesMap->noteIndex;
+
+    for (auto it = notesMap->notes.begin(); it != notesMap->notes.end(); ++it) {
+        VNOTE_ITEMS_MAP *batchNotes = it.value();
+        VNOTE_ALL_NOTES_DATA_MAP::iterator folderIt = m_qspAllNotesMap->notes.find(it.key());
+
+        //内存中已有的笔记可能已被移动到其他记事本，按全局索引判断重复
+        if (folderIt == m_qspAllNotesMap->notes.end()) {
+            for (auto noteIt = batchNotes->folderNotes.begin(); noteIt != batchNotes->folderNotes.end();) {
+                if (noteIndex.contains(noteIt.key())) {
+                    delete noteIt.value();
+                    noteIt = batchNotes->folderNotes.erase(noteIt);
+                } else {
+                    noteIndex.insert(noteIt.key(), noteIt.value());
+                    newNotes.append(noteIt.value());
+                    ++noteIt;
+                }
             }
 
-            folderNotes->folderNotes.clear();
-            delete reinterpret_cast<VNOTE_ITEMS_MAP *>(folderNotes);
+            m_qspAllNotesMap->notes.insert(it.key(), batchNotes);
+            continue;
         }
 
-        m_qspAllNotesMap->notes.clear();
+        VNOTE_ITEMS_MAP *folderNotes = *folderIt;
 
-        m_qspAllNotesMap->lock.unlock();
+        folderNotes->lock.lockForWrite();
+
+        for (auto note : batchNotes->folderNotes) {
+            if (noteIndex.contains(note->noteId)) {
+                delete note;
+            } else {
+                folderNotes->folderNotes.insert(note->noteId, note);
+                noteIndex.insert(note->noteId, note);
+                newNotes.append(note);
+            }
+        }
+
+        folderNotes->lock.unlock();
+
+        batchNotes->folderNotes.clear();
+        delete batchNotes;
+    }
+
+    //数据已转移，只释放容器
+    notesMap->notes.clear();
+    delete notesMap;
+
+    m_qspAllNotesMap->lock.unlock();
+
+    if (!newNotes.isEmpty()) {
+        updateSnapshotNotes([&newNotes](QHash<qint64, QVector<VNoteItem *>> &folderNotes) {
+            for (auto note : newNotes) {
+                folderNotes[note->folderId].append(note);
+            }
+        });
+    }
+
+    for (auto note : newNotes) {
+        adjustFolderStats(note->folderId, 1, note->modifyTime);
     }
 
-    m_qspAllNotesMap.reset(notesMap);
+    //第一批数据(默认记事本)到达即可显示界面
+    if (!(m_fDataState & DataState::NotesDataReady)) {
+        m_fDataState |= DataState::NotesDataReady;
+
+        if (isAllDatasReady()) {
+            emit onAllDatasReady();
+        }
+    } else if (!newNotes.isEmpty()) {
+        emit onNoteItemsBatchLoaded(newNotes);
+    }
+}
+
+/**
+ * @brief VNoteDataManager::onNotesLoadFinished
+ */
+void VNoteDataManager::onNotesLoadFinished()
+{
+    if (m_qspAllNotesMap == nullptr) {
+        m_qspAllNotesMap.reset(new VNOTE_ALL_NOTES_MAP());
+        m_qspAllNotesMap->autoRelease = true;
+    }
 
-    qInfo() << "Release old notesMap:" << m_qspAllNotesMap.get()
-            << "All notes in folders:" << m_qspAllNotesMap->notes.size();
+    qInfo() << "All notes loaded, folders:" << m_qspAllNotesMap->notes.size();
 
     //Object is already deleted
     m_pNotesLoadThread = nullptr;
 
-    //Set folder data ready flag
-    m_fDataState |= DataState::NotesDataReady;
-
-    emit onNoteItemsLoaded();
+    //没有笔记时不会收到任何批次
+    if (!(m_fDataState & DataState::NotesDataReady)) {
+        m_fDataState |= DataState::NotesDataReady;
 
-    //Send data ready signal if data ready
-    if (isAllDatasReady()) {
-        emit onAllDatasReady();
+        if (isAllDatasReady()) {
+            emit onAllDatasReady();
+        }
     }
+
+    emit onNoteItemsLoaded();
 }
@@ -9,6 +9,11 @@
 #include "datatypedef.h"
 
 #include <QObject>
+#include <QMutex>
+#include <QWeakPointer>
+
+#include <functional>
+#include <list>
 
 class LoadFolderWorker;
 class LoadNoteItemsWorker;
@@ -23,6 +28,13 @@ class VNoteDataManager : public QObject
 public:
     explicit VNoteDataManager(QObject *parent = nullptr);
 
+    //记事项变化的字段，按位组合
+    enum NoteField {
+        NoteTitleField = 0x1,
+        NoteBodyField = 0x2,
+        NoteModifyTimeField = 0x4,
+    };
+
     static VNoteDataManager *instance();
 
     //获取所有记事本数据
@@ -33,21 +45,59 @@ public:
     void reqNoteDefIcons();
     //加载记事本数据
     void reqNoteFolders();
-    //加载记事项数据
+    //加载记事项数据，记事本数据加载完成后开始，优先加载默认显示的记事本
     void reqNoteItems();
+    //获取记事项只读快照，遍历时不需要加锁，数据未变化时复用上一个快照
+    VNOTE_NOTES_SNAPSHOT notesSnapshot();
+    //移动记事项到其他记事本，同时更新记事本聚合数据
+    bool moveNotes(const QList<VNoteItem *> &notes, qint64 destFolderId);
+    //记事项内容修改后调用，更新记事本最后修改时间并发送noteUpdated
+    void notifyNoteUpdated(const VNoteItem *note, int fields);
+    //记事项置顶状态修改后调用
+    void notifyNotePinned(const VNoteItem *note);
+    //销毁已移除的记事项，仍有快照引用时延迟到快照释放后
+    void releaseNote(VNoteItem *note);
+    //设置正文缓存的内存预算，0不限制
+    void setBodyCacheBudget(qint64 bytes);
+    //固定记事项正文，编辑或导出期间不被释放，可嵌套调用
+    void pinNoteBody(VNoteItem *note);
+    //取消固定记事项正文
+    void unpinNoteBody(VNoteItem *note);
+    //正文缓存统计
+    VNOTE_BODY_CACHE_STATS bodyCacheStats();
+
+    //默认正文缓存预算
+    static constexpr qint64 DEFAULT_BODY_CACHE_BUDGET = 64 * 1024 * 1024;
 signals:
     //记事本数据加载完成
     void onNoteFoldersLoaded();
+    //一批记事项数据加入内存，首屏之后到达的数据通过该信号增量刷新界面
+    void onNoteItemsBatchLoaded(const QList<VNoteItem *> &notes);
     //记事项数据加载完成
     void onNoteItemsLoaded();
     //所有数据加载完成
     void onAllDatasReady();
+    //以下为记事项变化通知，界面根据id增量更新，不需要重新加载列表
+    //添加记事项
+    void noteAdded(qint64 folderId, qint32 noteId);
+    //记事项修改，fields为NoteField组合
+    void noteUpdated(qint64 folderId, qint32 noteId, int fields);
+    //记事项移动到其他记事本
+    void noteMoved(qint32 noteId, qint64 fromFolderId, qint64 toFolderId);
+    //删除记事项
+    void noteDeleted(qint64 folderId, qint32 noteId);
+    //记事项置顶或取消置顶
+    void notePinned(qint64 folderId, qint32 noteId, bool isTop);
 
 public slots:
     //加载记事本数据线程执行完成
     void onFoldersLoaded(VNOTE_FOLDERS_MAP *foldesMap);
-    //加载笔记数据线程执行完成
-    void onAllNotesLoaded(VNOTE_ALL_NOTES_MAP *notesMap);
+    //合并一批笔记数据
+    void onNotesBatchLoaded(VNOTE_ALL_NOTES_MAP *notesMap);
+    //分批加载笔记数据完成
+    void onNotesLoadFinished();
+    //释放超出预算的正文，后台线程访问正文后排队到界面线程执行
+    void onEvictNoteBodies();
 
 protected:
     //添加一个记事本
@@ -62,6 +112,8 @@ protected:
     VNoteItem *addNote(VNoteItem *note);
     //获取一个记事项
     VNoteItem *getNote(qint64 folderId, qint32 noteId);
+    //通过note_id获取记事项，不需要记事本id
+    VNoteItem *getNote(qint32 noteId);
     //删除记事项
     VNoteItem *delNote(qint64 folderId, qint32 noteId);
     //获取一个记事本的记事项个数
@@ -70,6 +122,22 @@ protected:
     VNOTE_ITEMS_MAP *getFolderNotes(qint64 folderId);
     //获取记事本图标
     QPixmap getDefaultIcon(qint32 index, IconsType type);
+    //启动笔记加载线程
+    void startLoadNotes();
+    //默认显示的记事本，与记事本列表的排序一致
+    qint64 priorityFolderId();
+    //记录一次正文访问，超出内存预算时释放最久未使用的正文
+    void touchNoteBody(VNoteItem *note, bool isHit);
+    //记事项销毁前移出正文缓存
+    void forgetNoteBody(VNoteItem *note);
+    //增量更新记事本的记事项数和最后修改时间
+    void adjustFolderStats(qint64 folderId, qint32 countDelta, const QDateTime &modifyTime);
+    //记事项保存后更新所属记事本的最后修改时间
+    void updateFolderModifyTime(const VNoteItem *note);
+    //重新统计记事本聚合数据，-1统计所有记事本
+    void rebuildFolderStats(qint64 folderId = -1);
+    //释放正文直到不超过预算，需持有m_bodyCacheLock，只在界面线程调用
+    void evictNoteBodies(const VNoteItem *current);
 
 private:
     QScopedPointer<VNOTE_FOLDERS_MAP> m_qspNoteFoldersMap;
@@ -87,6 +155,32 @@ private:
     };
 
     int m_fDataState = {DataNotLoaded};
+    //记事本数据加载完成后再开始加载笔记
+    bool m_notesRequested {false};
+    //记事项增删或移动时修改快照数据，只复制被修改的记事本列表
+    void updateSnapshotNotes(const std::function<void(QHash<qint64, QVector<VNoteItem *>> &)> &change);
+    //保护快照数据、版本和最新快照
+    QMutex m_snapshotLock;
+    quint64 m_notesVersion {0};
+    //下一个快照的数据，与已发布的快照隐式共享，修改时只复制对应记事本的列表
+    QHash<qint64, QVector<VNoteItem *>> m_snapshotNotes;
+    //不持有快照，没有使用者时快照及其延迟释放的记事项立即销毁
+    QWeakPointer<VNOTE_NOTES_SNAPSHOT_DATA> m_latestSnapshot;
+    //正文缓存项
+    struct BodyCacheEntry {
+        std::list<VNoteItem *>::iterator lruIter;
+        qint64 size {0};
+    };
+    //保护正文缓存的所有数据
+    QMutex m_bodyCacheLock;
+    //正文已加载的记事项，表头为最近使用
+    std::list<VNoteItem *> m_bodyLru;
+    QHash<VNoteItem *, BodyCacheEntry> m_bodyEntries;
+    //固定的记事项及固定次数
+    QHash<VNoteItem *, int> m_pinnedBodies;
+    VNOTE_BODY_CACHE_STATS m_bodyCacheStats;
+    //已排队释放正文，避免后台连续访问时重复排队
+    bool m_evictionScheduled {false};
 
     bool isAllDatasReady() const;
 
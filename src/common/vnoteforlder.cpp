@@ -46,17 +46,7 @@ qint32 &VNoteFolder::maxNoteIdRef()
  */
 qint32 VNoteFolder::getNotesCount()
 {
-    int nCount = 0;
-
-    VNOTE_ITEMS_MAP *folderNotes = getNotes();
-
-    if (Q_LIKELY(nullptr != folderNotes)) {
-        folderNotes->lock.lockForRead();
-        nCount = folderNotes->folderNotes.count();
-        folderNotes->lock.unlock();
-    }
-
-    return nCount;
+    return static_cast<qint32>(notesCount);
 }
 
 /**
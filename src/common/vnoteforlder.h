@@ -30,7 +30,7 @@ public:
     qint64 id {INVALID_ID};
     //类别，保留字段，暂时未用
     qint32 category {0};
-    //记事项个数
+    //记事项个数，由数据管理类在记事项增删和移动时维护
     qint64 notesCount {0};
     //图标索引
     qint32 defaultIcon {0};
@@ -48,6 +48,8 @@ public:
     QDateTime modifyTime;
     //删除时间
     QDateTime deleteTime;
+    //记事项的最后修改时间，由数据管理类维护
+    QDateTime lastNoteModifyTime;
     //排序编号
     qint32 sortNumber {-1};
 
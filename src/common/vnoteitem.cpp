@@ -5,6 +5,7 @@
 
 #include "vnoteitem.h"
 #include "common/utils.h"
+#include "common/vnoteitempool.h"
 
 #include <DLog>
 #include <DGuiApplicationHelper>
@@ -60,6 +61,26 @@ VNoteItem::VNoteItem()
 {
 }
 
+/**
+ * @brief VNoteItem::operator new
+ * @param size 对象大小
+ * @return 内存地址
+ */
+void *VNoteItem::operator new(std::size_t size)
+{
+    return VNoteItemPool::allocate(size);
+}
+
+/**
+ * @brief VNoteItem::operator delete
+ * @param ptr 内存地址
+ * @param size 对象大小
+ */
+void VNoteItem::operator delete(void *ptr, std::size_t size)
+{
+    VNoteItemPool::release(ptr, size);
+}
+
 /**
  * @brief VNoteItem::isValid
  * @return true 可用
@@ -97,10 +118,9 @@ bool VNoteItem::search(const QString &keyword)
     if (noteTitle.contains(keyword, Qt::CaseInsensitive)) {
         fContainKeyword = true;
     } else {
-        if (!htmlCode.isEmpty()) { //富文本内容查找
-            QTextDocument doc;
-            doc.setHtml(htmlCode);
-            fContainKeyword = doc.toPlainText().contains(keyword, Qt::CaseInsensitive);
+        if (!htmlCode.isEmpty()) { //富文本内容查找，多次搜索时不重复解析
+            updatePlainText();
+            fContainKeyword = m_plainText.contains(keyword, Qt::CaseInsensitive);
         } else {
             //Need search data blocks in note
             for (auto it : datas.datas) {
@@ -115,6 +135,94 @@ bool VNoteItem::search(const QString &keyword)
     return fContainKeyword;
 }
 
+/**
+ * @brief VNoteItem::searchText
+ * @return 正文纯文本
+ */
+QString VNoteItem::searchText() const
+{
+    if (!htmlCode.isEmpty()) {
+        return (htmlCode == m_plainTextSource) ? m_plainText : Utils::htmlToPlainText(htmlCode);
+    }
+
+    //老版本数据，文本块内容及语音转写内容
+    QStringList blockTexts;
+
+    for (auto it : datas.datas) {
+        if (!it->blockText.isEmpty()) {
+            blockTexts.append(it->blockText);
+        }
+    }
+
+    return blockTexts.join("\n");
+}
+
+/**
+ * @brief VNoteItem::updatePlainText
+ * 富文本内容未变化时不重新解析；老版本数据块格式直接拼接，不缓存
+ */
+void VNoteItem::updatePlainText()
+{
+    if (htmlCode.isEmpty()) {
+        m_plainText.clear();
+        m_plainTextSource.clear();
+    } else if (htmlCode != m_plainTextSource) {
+        m_plainText = Utils::htmlToPlainText(htmlCode);
+        m_plainTextSource = htmlCode;
+    }
+}
+
+/**
+ * @brief VNoteItem::copyPlainText
+ * @param other 记事项
+ */
+void VNoteItem::copyPlainText(const VNoteItem &other)
+{
+    m_plainText = other.m_plainText;
+    m_plainTextSource = other.m_plainTextSource;
+}
+
+/**
+ * @brief VNoteItem::bodySize
+ * @return 正文估算占用的字节数
+ */
+qint64 VNoteItem::bodySize() const
+{
+    qint64 size = htmlCode.size() + m_plainText.size();
+
+    if (metaData.type() == QVariant::ByteArray) {
+        size += metaData.toByteArray().size() / static_cast<int>(sizeof(QChar));
+    } else {
+        size += metaData.toString().size();
+    }
+
+    for (auto it : datas.datas) {
+        size += it->blockText.size();
+    }
+
+    return size * static_cast<qint64>(sizeof(QChar));
+}
+
+/**
+ * @brief VNoteItem::releaseBody
+ * 数据块可能被语音播放等界面引用，只释放富文本格式的正文
+ * @return true 已释放
+ */
+bool VNoteItem::releaseBody()
+{
+    if (!bodyLoaded || !datas.datas.isEmpty()) {
+        return false;
+    }
+
+    htmlCode.clear();
+    metaData.clear();
+    m_plainText.clear();
+    m_plainTextSource.clear();
+    bodyLoaded = false;
+
+    return true;
+}
+
 //bool VNoteItem::makeMetaData()
 //{
 //    bool isMetaDataOk = false;
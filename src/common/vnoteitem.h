@@ -23,12 +23,25 @@ struct VNoteFolder;
 struct VNoteItem {
 public:
     VNoteItem();
+    //对象从VNoteItemPool中分配
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr, std::size_t size);
     //是否可用
     bool isValid();
     //删除数据
     void delNoteData();
     //查找数据
     bool search(const QString &keyword);
+    //获取正文纯文本，包括语音转写文本，用于全文索引和导出；富文本内容未变化时使用缓存
+    QString searchText() const;
+    //刷新正文纯文本缓存，保存和搜索时调用
+    void updatePlainText();
+    //复制其他记事项的纯文本缓存，保存快照时使用
+    void copyPlainText(const VNoteItem &other);
+    //正文估算占用的内存字节数
+    qint64 bodySize() const;
+    //释放正文，使用时重新从数据库加载，老版本数据块格式不释放
+    bool releaseBody();
     //源数据设置
     void setMetadata(const QVariant &meta);
     //绑定记事本项
@@ -72,6 +85,10 @@ public:
     QDateTime modifyTime;
     //删除时间
     QDateTime deleteTime;
+    //正文(元数据)是否已加载，启动时只加载摘要，正文在使用时加载
+    bool bodyLoaded {true};
+    //已保存正文的内容哈希，0表示未知
+    qint64 contentHash {0};
     //获取元数据
     QVariant &metaDataRef();
     const QVariant &metaDataConstRef() const;
@@ -102,6 +119,10 @@ public:
 protected:
     QVariant metaData;
 
+    //正文纯文本缓存，m_plainTextSource与生成缓存时的htmlCode共享数据，两者相同时缓存有效
+    QString m_plainText;
+    QString m_plainTextSource;
+
     //Use to make default voice name
     //auto increment.
     qint32 maxVoiceId {0};
@@ -0,0 +1,216 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "vnoteitempool.h"
+#include "common/vnoteitem.h"
+
+#include <new>
+
+//每个位置记录所属的块，释放时直接归还到该块
+struct VNoteItemPool::Slot {
+    Chunk *chunk;
+    union {
+        //空闲时保存链表指针
+        Slot *next;
+        alignas(VNoteItem) char data[sizeof(VNoteItem)];
+    };
+};
+
+struct VNoteItemPool::Chunk {
+    Slot slots[ITEMS_PER_CHUNK];
+    Slot *freeList {nullptr};
+    int usedCount {0};
+    //有空闲位置的块链表
+    Chunk *prev {nullptr};
+    Chunk *next {nullptr};
+};
+
+QMutex VNoteItemPool::s_lock;
+VNoteItemPool::Chunk *VNoteItemPool::s_availableHead = nullptr;
+VNoteItemPool::Chunk *VNoteItemPool::s_availableTail = nullptr;
+int VNoteItemPool::s_chunkCount = 0;
+int VNoteItemPool::s_emptyChunkCount = 0;
+int VNoteItemPool::s_usedCount = 0;
+
+constexpr int VNoteItemPool::ITEMS_PER_CHUNK;
+
+/**
+ * @brief VNoteItemPool::slotOf
+ * @param ptr allocate返回的地址
+ * @return 所在的位置
+ */
+VNoteItemPool::Slot *VNoteItemPool::slotOf(void *ptr)
+{
+    return reinterpret_cast<Slot *>(static_cast<char *>(ptr) - offsetof(Slot, data));
+}
+
+/**
+ * @brief VNoteItemPool::allocate
+ * @param size 对象大小
+ * @return 内存地址
+ */
+void *VNoteItemPool::allocate(std::size_t size)
+{
+    if (Q_UNLIKELY(size != sizeof(VNoteItem))) {
+        return ::operator new(size);
+    }
+
+    QMutexLocker locker(&s_lock);
+
+    Chunk *chunk = s_availableHead;
+
+    if (nullptr == chunk) {
+        chunk = allocateChunk();
+        linkChunk(chunk);
+    }
+
+    if (0 == chunk->usedCount) {
+        s_emptyChunkCount--;
+    }
+
+    Slot *slot = chunk->freeList;
+    chunk->freeList = slot->next;
+    chunk->usedCount++;
+    s_usedCount++;
+
+    //块已满，不再参与分配
+    if (nullptr == chunk->freeList) {
+        unlinkChunk(chunk);
+    }
+
+    return slot->data;
+}
+
+/**
+ * @brief VNoteItemPool::release
+ * 保留一个空块备用，已有空块时才归还，避免在块边界反复创建、释放笔记时频繁申请块内存
+ * @param ptr 内存地址
+ * @param size 对象大小
+ */
+void VNoteItemPool::release(void *ptr, std::size_t size)
+{
+    if (nullptr == ptr) {
+        return;
+    }
+
+    if (Q_UNLIKELY(size != sizeof(VNoteItem))) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    Slot *slot = slotOf(ptr);
+    Chunk *chunk = slot->chunk;
+
+    QMutexLocker locker(&s_lock);
+
+    bool wasFull = (nullptr == chunk->freeList);
+
+    slot->next = chunk->freeList;
+    chunk->freeList = slot;
+    chunk->usedCount--;
+    s_usedCount--;
+
+    if (0 != chunk->usedCount) {
+        if (wasFull) {
+            linkChunk(chunk);
+        }
+        return;
+    }
+
+    if (!wasFull) {
+        unlinkChunk(chunk);
+    }
+
+    if (s_emptyChunkCount > 0) {
+        delete chunk;
+        s_chunkCount--;
+    } else {
+        //备用块放在链表尾，先填满其他块
+        s_emptyChunkCount++;
+        linkChunk(chunk);
+    }
+}
+
+/**
+ * @brief VNoteItemPool::chunkCount
+ * @return 块数
+ */
+int VNoteItemPool::chunkCount()
+{
+    QMutexLocker locker(&s_lock);
+    return s_chunkCount;
+}
+
+/**
+ * @brief VNoteItemPool::usedCount
+ * @return 对象数
+ */
+int VNoteItemPool::usedCount()
+{
+    QMutexLocker locker(&s_lock);
+    return s_usedCount;
+}
+
+/**
+ * @brief VNoteItemPool::allocateChunk
+ * 调用方持有s_lock，按地址顺序链接，连续创建的对象相邻存放
+ * @return 新块
+ */
+VNoteItemPool::Chunk *VNoteItemPool::allocateChunk()
+{
+    Chunk *chunk = new Chunk();
+
+    for (int i = ITEMS_PER_CHUNK - 1; i >= 0; i--) {
+        Slot *slot = &chunk->slots[i];
+        slot->chunk = chunk;
+        slot->next = chunk->freeList;
+        chunk->freeList = slot;
+    }
+
+    s_chunkCount++;
+    s_emptyChunkCount++;
+
+    return chunk;
+}
+
+/**
+ * @brief VNoteItemPool::linkChunk
+ * 加入链表尾，先填满较早有空闲位置的块
+ * @param chunk 块
+ */
+void VNoteItemPool::linkChunk(Chunk *chunk)
+{
+    chunk->prev = s_availableTail;
+    chunk->next = nullptr;
+
+    if (nullptr != s_availableTail) {
+        s_availableTail->next = chunk;
+    } else {
+        s_availableHead = chunk;
+    }
+
+    s_availableTail = chunk;
+}
+
+/**
+ * @brief VNoteItemPool::unlinkChunk
+ * @param chunk 块
+ */
+void VNoteItemPool::unlinkChunk(Chunk *chunk)
+{
+    if (nullptr != chunk->prev) {
+        chunk->prev->next = chunk->next;
+    } else {
+        s_availableHead = chunk->next;
+    }
+
+    if (nullptr != chunk->next) {
+        chunk->next->prev = chunk->prev;
+    } else {
+        s_availableTail = chunk->prev;
+    }
+
+    chunk->prev = nullptr;
+    chunk->next = nullptr;
+}
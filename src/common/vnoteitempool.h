@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef VNOTEITEMPOOL_H
+#define VNOTEITEMPOOL_H
+
+#include <QMutex>
+
+#include <cstddef>
+
+//记事项对象的分块内存池，对象按块连续分配，减少每个对象的堆分配开销，遍历时缓存命中率更高
+class VNoteItemPool
+{
+public:
+    //分配一个记事项大小的内存，大小不符时使用全局分配
+    static void *allocate(std::size_t size);
+    //释放内存，块内对象全部释放后归还整块，保留一个空块备用
+    static void release(void *ptr, std::size_t size);
+    //已分配的块数
+    static int chunkCount();
+    //正在使用的对象数
+    static int usedCount();
+
+    //每块包含的对象数
+    static constexpr int ITEMS_PER_CHUNK = 256;
+
+protected:
+    struct Chunk;
+    struct Slot;
+
+    //allocate返回的地址所在的位置
+    static Slot *slotOf(void *ptr);
+
+    //分配新块，所有位置按地址顺序加入块的空闲链表
+    static Chunk *allocateChunk();
+    //加入或移出有空闲位置的块链表
+    static void linkChunk(Chunk *chunk);
+    static void unlinkChunk(Chunk *chunk);
+
+    //加载时只有加载线程分配，锁基本无竞争
+    static QMutex s_lock;
+    //有空闲位置的块，优先从链表头分配
+    static Chunk *s_availableHead;
+    static Chunk *s_availableTail;
+    static int s_chunkCount;
+    //没有对象的块数，最多保留一个
+    static int s_emptyChunkCount;
+    static int s_usedCount;
+};
+
+#endif // VNOTEITEMPOOL_H
@@ -0,0 +1,424 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "vnotesearchindex.h"
+#include "vnoteitem.h"
+#include "db/vnotedbmanager.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+//中日韩文字没有空格分隔，按字切分
+bool isCjkChar(const QChar &ch)
+{
+    switch (ch.script()) {
+    case QChar::Script_Han:
+    case QChar::Script_Hiragana:
+    case QChar::Script_Katakana:
+    case QChar::Script_Hangul:
+        return true;
+    default:
+        return false;
+    }
+}
+} // namespace
+
+VNoteSearchIndex *VNoteSearchIndex::_instance = nullptr;
+
+/**
+ * @brief VNoteSearchIndex::VNoteSearchIndex
+ */
+VNoteSearchIndex::VNoteSearchIndex()
+{
+}
+
+/**
+ * @brief VNoteSearchIndex::instance
+ * @return 单例对象
+ */
+VNoteSearchIndex *VNoteSearchIndex::instance()
+{
+    if (nullptr == _instance) {
+        _instance = new VNoteSearchIndex();
+    }
+
+    return _instance;
+}
+
+/**
+ * @brief VNoteSearchIndex::isIndexedNote
+ * 数据库全文索引不包含加密笔记，不可用时所有笔记都需要内存索引
+ * @param note 记事项
+ * @return true 由内存索引负责
+ */
+bool VNoteSearchIndex::isIndexedNote(const VNoteItem *note)
+{
+    return nullptr != note && (note->encryption || !VNoteDbManager::instance()->hasFullTextIndex());
+}
+
+/**
+ * @brief VNoteSearchIndex::tokenize
+ * @param text 文本
+ * @return 索引词
+ */
+QStringList VNoteSearchIndex::tokenize(const QString &text)
+{
+    QStringList terms;
+    QSet<QString> termSet;
+
+    for (auto &it : splitText(text, false)) {
+        if (!termSet.contains(it.text)) {
+            termSet.insert(it.text);
+            terms.append(it.text);
+        }
+    }
+
+    return terms;
+}
+
+/**
+ * @brief VNoteSearchIndex::splitText
+ * 文档中的中日韩文字同时生成单字和相邻两字，单字查询也能命中；
+ * 查询时多字只使用相邻两字，减少倒排表求交集的次数。
+ * 文本包含关键字时必然包含关键字切分出的每个查询词，反之不一定成立
+ * @param text 文本
+ * @param isQuery true 切分查询关键字
+ * @return 切分结果
+ */
+QVector<VNoteSearchIndex::QueryTerm> VNoteSearchIndex::splitText(const QString &text, bool isQuery)
+{
+    QVector<QueryTerm> terms;
+    QString word;
+    QString cjkText;
+
+    auto appendTerm = [&terms](const QString &termText, bool isSubstring) {
+        QueryTerm term;
+        term.text = termText;
+        term.isSubstring = isSubstring;
+        terms.append(term);
+    };
+
+    auto flushWord = [&]() {
+        if (!word.isEmpty()) {
+            appendTerm(isQuery ? word : word.left(MAX_TERM_LENGTH), isQuery);
+            word.clear();
+        }
+    };
+
+    auto flushCjk = [&]() {
+        if (cjkText.isEmpty()) {
+            return;
+        }
+
+        if (!isQuery || 1 == cjkText.size()) {
+            for (auto ch : cjkText) {
+                appendTerm(QString(ch), false);
+            }
+        }
+
+        for (int i = 0; i + 1 < cjkText.size(); i++) {
+            appendTerm(cjkText.mid(i, 2), false);
+        }
+
+        cjkText.clear();
+    };
+
+    //与QString::contains忽略大小写的比较方式一致
+    for (auto ch : text.toCaseFolded()) {
+        if (isCjkChar(ch)) {
+            flushWord();
+            cjkText.append(ch);
+        } else if (ch.isLetterOrNumber()) {
+            flushCjk();
+            word.append(ch);
+        } else {
+            flushWord();
+            flushCjk();
+        }
+    }
+
+    flushWord();
+    flushCjk();
+
+    return terms;
+}
+
+/**
+ * @brief VNoteSearchIndex::updateNote
+ * 切分在锁外进行，只在修改倒排表时持有写锁
+ * @param noteId 记事项id
+ * @param title 标题
+ * @param text 正文纯文本
+ * @param overwrite false 已加入索引时不修改，后台建立索引时使用，避免旧数据覆盖保存时的更新
+ */
+void VNoteSearchIndex::updateNote(qint32 noteId, const QString &title, const QString &text, bool overwrite)
+{
+    NoteTerms terms;
+    terms.title = tokenize(title).toSet();
+    terms.body = tokenize(text).toSet();
+
+    QWriteLocker locker(&m_lock);
+
+    if (!overwrite && m_notes.contains(noteId)) {
+        return;
+    }
+
+    //后台传入的标题是创建任务时复制的，之后重命名过则使用新标题
+    auto pendingIter = m_pendingTitles.find(noteId);
+
+    if (pendingIter != m_pendingTitles.end()) {
+        if (!overwrite && pendingIter.value() != title) {
+            terms.title = tokenize(pendingIter.value()).toSet();
+        }
+        m_pendingTitles.erase(pendingIter);
+    }
+
+    setNoteTerms(noteId, terms);
+}
+
+/**
+ * @brief VNoteSearchIndex::updateTitle
+ * 重命名时正文可能未加载，只替换标题部分
+ * @param noteId 记事项id
+ * @param title 标题
+ */
+void VNoteSearchIndex::updateTitle(qint32 noteId, const QString &title)
+{
+    QSet<QString> titleTerms = tokenize(title).toSet();
+
+    QWriteLocker locker(&m_lock);
+
+    auto it = m_notes.find(noteId);
+
+    //索引建立时加入该笔记，暂存最新的标题
+    if (it == m_notes.end() && !m_ready) {
+        m_pendingTitles.insert(noteId, title);
+        return;
+    }
+
+    NoteTerms terms = (it != m_notes.end()) ? it.value() : NoteTerms();
+    terms.title = titleTerms;
+
+    setNoteTerms(noteId, terms);
+}
+
+/**
+ * @brief VNoteSearchIndex::removeNote
+ * @param noteId 记事项id
+ */
+void VNoteSearchIndex::removeNote(qint32 noteId)
+{
+    QWriteLocker locker(&m_lock);
+
+    m_pendingTitles.remove(noteId);
+
+    if (m_notes.contains(noteId)) {
+        setNoteTerms(noteId, NoteTerms());
+        m_notes.remove(noteId);
+    }
+}
+
+/**
+ * @brief VNoteSearchIndex::contains
+ * @param noteId 记事项id
+ * @return true 已加入索引
+ */
+bool VNoteSearchIndex::contains(qint32 noteId) const
+{
+    QReadLocker locker(&m_lock);
+    return m_notes.contains(noteId);
+}
+
+/**
+ * @brief VNoteSearchIndex::clear
+ */
+void VNoteSearchIndex::clear()
+{
+    QWriteLocker locker(&m_lock);
+
+    m_postings.clear();
+    m_notes.clear();
+    m_pendingTitles.clear();
+    m_ready = false;
+}
+
+/**
+ * @brief VNoteSearchIndex::setReady
+ * @param ready true 索引已建立
+ */
+void VNoteSearchIndex::setReady(bool ready)
+{
+    QWriteLocker locker(&m_lock);
+    m_ready = ready;
+
+    //建立完成后重命名直接更新索引
+    if (ready) {
+        m_pendingTitles.clear();
+    }
+}
+
+/**
+ * @brief VNoteSearchIndex::isReady
+ * @return true 索引已建立
+ */
+bool VNoteSearchIndex::isReady() const
+{
+    QReadLocker locker(&m_lock);
+    return m_ready;
+}
+
+/**
+ * @brief VNoteSearchIndex::search
+ * 从第一个查询词的倒排表开始依次求交集，结果为空时提前结束。
+ * 不检查查询词是否相邻，结果需调用VNoteItem::search确认
+ * @param keyword 关键字
+ * @param noteIds 候选笔记id，追加到集合中
+ * @return true 搜索成功
+ */
+bool VNoteSearchIndex::search(const QString &keyword, QSet<qint32> &noteIds) const
+{
+    QVector<QueryTerm> terms = splitText(keyword, true);
+
+    QReadLocker locker(&m_lock);
+
+    if (!m_ready) {
+        return false;
+    }
+
+    //没有需要内存索引的笔记
+    if (m_notes.isEmpty()) {
+        return true;
+    }
+
+    //只有标点等无法切分的关键字由调用方逐条匹配
+    if (terms.isEmpty()) {
+        return false;
+    }
+
+    QVector<qint32> matchedIds = lookup(terms.first());
+
+    for (int i = 1; i < terms.size() && !matchedIds.isEmpty(); i++) {
+        QVector<qint32> termIds = lookup(terms.at(i));
+        QVector<qint32> intersection;
+
+        std::set_intersection(matchedIds.begin(), matchedIds.end(),
+                              termIds.begin(), termIds.end(),
+                              std::back_inserter(intersection));
+        matchedIds.swap(intersection);
+    }
+
+    for (auto noteId : matchedIds) {
+        noteIds.insert(noteId);
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteSearchIndex::noteCount
+ * @return 已索引的笔记数
+ */
+int VNoteSearchIndex::noteCount() const
+{
+    QReadLocker locker(&m_lock);
+    return m_notes.size();
+}
+
+/**
+ * @brief VNoteSearchIndex::termCount
+ * @return 索引词数
+ */
+int VNoteSearchIndex::termCount() const
+{
+    QReadLocker locker(&m_lock);
+    return m_postings.size();
+}
+
+/**
+ * @brief VNoteSearchIndex::setNoteTerms
+ * 只修改新旧索引词的差集对应的倒排表
+ * @param noteId 记事项id
+ * @param terms 新的索引词
+ */
+void VNoteSearchIndex::setNoteTerms(qint32 noteId, const NoteTerms &terms)
+{
+    QSet<QString> oldTerms;
+    auto it = m_notes.find(noteId);
+
+    if (it != m_notes.end()) {
+        oldTerms = it->title;
+        oldTerms.unite(it->body);
+    }
+
+    QSet<QString> newTerms = terms.title;
+    newTerms.unite(terms.body);
+
+    for (auto &term : oldTerms) {
+        if (newTerms.contains(term)) {
+            continue;
+        }
+
+        auto postingIter = m_postings.find(term);
+
+        if (postingIter != m_postings.end()) {
+            QVector<qint32> &ids = postingIter.value();
+            auto pos = std::lower_bound(ids.begin(), ids.end(), noteId);
+
+            if (pos != ids.end() && *pos == noteId) {
+                ids.erase(pos);
+            }
+
+            if (ids.isEmpty()) {
+                m_postings.erase(postingIter);
+            }
+        }
+    }
+
+    for (auto &term : newTerms) {
+        if (oldTerms.contains(term)) {
+            continue;
+        }
+
+        QVector<qint32> &ids = m_postings[term];
+        auto pos = std::lower_bound(ids.begin(), ids.end(), noteId);
+
+        if (pos == ids.end() || *pos != noteId) {
+            ids.insert(pos, noteId);
+        }
+    }
+
+    m_notes.insert(noteId, terms);
+}
+
+/**
+ * @brief VNoteSearchIndex::lookup
+ * 子串查询合并所有包含该查询词的索引词的倒排表，
+ * 被截断的索引词无法判断是否包含，一并作为候选
+ * @param term 查询词
+ * @return 按id排序的笔记id
+ */
+QVector<qint32> VNoteSearchIndex::lookup(const QueryTerm &term) const
+{
+    if (!term.isSubstring) {
+        return m_postings.value(term.text);
+    }
+
+    QVector<qint32> ids;
+    int matchedTerms = 0;
+
+    for (auto it = m_postings.begin(); it != m_postings.end(); ++it) {
+        if (it.key().size() >= MAX_TERM_LENGTH || it.key().contains(term.text)) {
+            ids += it.value();
+            matchedTerms++;
+        }
+    }
+
+    if (matchedTerms > 1) {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+
+    return ids;
+}
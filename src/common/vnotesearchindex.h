@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef VNOTESEARCHINDEX_H
+#define VNOTESEARCHINDEX_H
+
+#include <QHash>
+#include <QMap>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+struct VNoteItem;
+
+//记事项内存倒排索引，覆盖数据库全文索引之外的笔记(加密笔记，或全文索引不可用时的所有笔记)
+//英文和数字按词切分，查询时匹配包含查询词的索引词；中日韩文字按单字和相邻两字切分
+//查询结果是包含关键字的笔记的超集，调用方需逐条确认
+class VNoteSearchIndex
+{
+public:
+    VNoteSearchIndex();
+
+    static VNoteSearchIndex *instance();
+    //该笔记是否由内存索引负责
+    static bool isIndexedNote(const VNoteItem *note);
+    //切分文本，返回去重后的索引词
+    static QStringList tokenize(const QString &text);
+
+    //添加或更新笔记，overwrite为false时不覆盖已有数据
+    void updateNote(qint32 noteId, const QString &title, const QString &text, bool overwrite = true);
+    //只更新标题，未加入索引的笔记在索引建立前暂存标题
+    void updateTitle(qint32 noteId, const QString &title);
+    //移除笔记
+    void removeNote(qint32 noteId);
+    //笔记是否已加入索引
+    bool contains(qint32 noteId) const;
+    //清空索引，切换数据库时调用
+    void clear();
+    //后台建立索引完成后设置
+    void setReady(bool ready);
+    bool isReady() const;
+    //查找可能包含关键字的候选笔记，索引未就绪或关键字无法切分时返回false
+    bool search(const QString &keyword, QSet<qint32> &noteIds) const;
+    //已索引的笔记数
+    int noteCount() const;
+    //索引词数
+    int termCount() const;
+
+    //超长的词截断，避免链接等内容占用过多内存
+    static constexpr int MAX_TERM_LENGTH = 32;
+
+protected:
+    //查询词，英文和数字可能是文档中某个词的一部分
+    struct QueryTerm {
+        QString text;
+        bool isSubstring {false};
+    };
+    //笔记的标题和正文索引词，倒排表中的笔记id为两者的并集
+    struct NoteTerms {
+        QSet<QString> title;
+        QSet<QString> body;
+    };
+
+    //切分文本，isQuery为true时英文和数字为子串查询词，多字的中日韩文字不生成单字
+    static QVector<QueryTerm> splitText(const QString &text, bool isQuery);
+    //替换笔记的索引词，需持有写锁
+    void setNoteTerms(qint32 noteId, const NoteTerms &terms);
+    //查询一个词的倒排表，需持有读锁
+    QVector<qint32> lookup(const QueryTerm &term) const;
+
+    mutable QReadWriteLock m_lock;
+    //索引词->按id排序的笔记id
+    QMap<QString, QVector<qint32>> m_postings;
+    QHash<qint32, NoteTerms> m_notes;
+    //索引建立期间重命名的未索引笔记的标题，后台加入该笔记时使用
+    QHash<qint32, QString> m_pendingTitles;
+    bool m_ready {false};
+
+    static VNoteSearchIndex *_instance;
+};
+
+#endif // VNOTESEARCHINDEX_H
@@ -0,0 +1,198 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dbquerystats.h"
+#include "db/dbvisitor.h"
+
+#include <DLog>
+
+#include <QtAlgorithms>
+
+#include <typeinfo>
+#include <cxxabi.h>
+#include <cstdlib>
+
+/**
+ * @brief DbQueryStats::DbQueryStats
+ */
+DbQueryStats::DbQueryStats()
+{
+}
+
+/**
+ * @brief DbQueryStats::instance
+ * @return 单例对象
+ */
+DbQueryStats *DbQueryStats::instance()
+{
+    static DbQueryStats _instance;
+    return &_instance;
+}
+
+/**
+ * @brief DbQueryStats::record
+ * @param visitor
+ * @param phase 执行阶段
+ * @param nsecs 耗时(纳秒)
+ */
+void DbQueryStats::record(const DbVisitor *visitor, Phase phase, qint64 nsecs)
+{
+    const char *typeName = typeid(*visitor).name();
+
+    QMutexLocker locker(&m_lock);
+
+    PhaseStats &stats = m_stats[typeName].phases[phase];
+    stats.count++;
+    stats.totalNsecs += nsecs;
+    stats.maxNsecs = qMax(stats.maxNsecs, nsecs);
+    stats.buckets[bucketIndex(nsecs)]++;
+}
+
+/**
+ * @brief DbQueryStats::checkSlowQuery
+ * @param visitor
+ * @param sql 执行的语句
+ * @param nsecs 耗时(纳秒)
+ */
+void DbQueryStats::checkSlowQuery(const DbVisitor *visitor, const QString &sql, qint64 nsecs)
+{
+    int thresholdMsecs = m_slowQueryMsecs.loadAcquire();
+
+    if (thresholdMsecs <= 0 || nsecs < thresholdMsecs * 1000000LL) {
+        return;
+    }
+
+    const char *typeName = typeid(*visitor).name();
+
+    m_lock.lock();
+    m_stats[typeName].slowCount++;
+    m_lock.unlock();
+
+    qWarning() << "Slow query:" << visitorName(typeName)
+               << "ms:" << nsecs / 1000000.0 << "sql:" << sql.simplified();
+}
+
+/**
+ * @brief DbQueryStats::setSlowQueryThreshold
+ * @param msecs 阈值(毫秒)
+ */
+void DbQueryStats::setSlowQueryThreshold(int msecs)
+{
+    m_slowQueryMsecs.storeRelease(msecs);
+}
+
+/**
+ * @brief DbQueryStats::slowQueryThreshold
+ * @return 阈值(毫秒)
+ */
+int DbQueryStats::slowQueryThreshold() const
+{
+    return m_slowQueryMsecs.loadAcquire();
+}
+
+/**
+ * @brief DbQueryStats::dump
+ * @return 统计结果文本
+ */
+QString DbQueryStats::dump()
+{
+    static const char *phaseNames[PhaseCount] = {"prepare", "exec", "visitorData"};
+
+    QMutexLocker locker(&m_lock);
+
+    QStringList lines;
+    lines.append(QString("Database query stats, slow threshold %1ms").arg(slowQueryThreshold()));
+
+    for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it) {
+        const VisitorStats &visitorStats = it.value();
+        QString name = visitorName(it.key());
+
+        lines.append(QString("%1 slow:%2").arg(name).arg(visitorStats.slowCount));
+
+        for (int phase = 0; phase < PhaseCount; phase++) {
+            const PhaseStats &stats = visitorStats.phases[phase];
+
+            if (0 == stats.count) {
+                continue;
+            }
+
+            lines.append(QString("    %1 count:%2 avg:%3us max:%4us p50:<%5us p95:<%6us p99:<%7us")
+                             .arg(phaseNames[phase])
+                             .arg(stats.count)
+                             .arg(stats.totalNsecs / stats.count / 1000)
+                             .arg(stats.maxNsecs / 1000)
+                             .arg(percentileUsecs(stats, 50))
+                             .arg(percentileUsecs(stats, 95))
+                             .arg(percentileUsecs(stats, 99)));
+        }
+    }
+
+    return lines.join("\n");
+}
+
+/**
+ * @brief DbQueryStats::reset
+ */
+void DbQueryStats::reset()
+{
+    QMutexLocker locker(&m_lock);
+    m_stats.clear();
+}
+
+/**
+ * @brief DbQueryStats::bucketIndex
+ * @param nsecs 耗时(纳秒)
+ * @return 桶序号
+ */
+int DbQueryStats::bucketIndex(qint64 nsecs)
+{
+    quint64 usecs = static_cast<quint64>(qMax(nsecs, 0LL)) / 1000;
+
+    if (0 == usecs) {
+        return 0;
+    }
+
+    int index = 64 - qCountLeadingZeroBits(usecs);
+
+    return qMin(index, BUCKET_COUNT - 1);
+}
+
+/**
+ * @brief DbQueryStats::percentileUsecs
+ * @param stats 阶段统计
+ * @param percent 百分位
+ * @return 耗时上界(微秒)
+ */
+qint64 DbQueryStats::percentileUsecs(const PhaseStats &stats, int percent)
+{
+    qint64 target = (stats.count * percent + 99) / 100;
+    qint64 accumulated = 0;
+
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        accumulated += stats.buckets[i];
+
+        if (accumulated >= target) {
+            return 1LL << i;
+        }
+    }
+
+    return 1LL << (BUCKET_COUNT - 1);
+}
+
+/**
+ * @brief DbQueryStats::visitorName
+ * @param typeName typeid名称
+ * @return 类名
+ */
+QString DbQueryStats::visitorName(const char *typeName)
+{
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(typeName, nullptr, nullptr, &status);
+
+    QString name = (0 == status && nullptr != demangled) ? QString(demangled) : QString(typeName);
+
+    free(demangled);
+
+    return name;
+}
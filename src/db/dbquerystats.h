@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DBQUERYSTATS_H
+#define DBQUERYSTATS_H
+
+#include <QHash>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QString>
+
+class DbVisitor;
+
+//数据库操作耗时统计，按visitor类型和执行阶段记录直方图，并记录慢查询
+class DbQueryStats
+{
+public:
+    //执行阶段
+    enum Phase {
+        Prepare = 0, //生成sql语句
+        Exec, //执行sql语句
+        VisitorData, //处理结果集
+        PhaseCount
+    };
+
+    static DbQueryStats *instance();
+    //记录一次耗时
+    void record(const DbVisitor *visitor, Phase phase, qint64 nsecs);
+    //单条语句耗时超过阈值时输出慢查询日志
+    void checkSlowQuery(const DbVisitor *visitor, const QString &sql, qint64 nsecs);
+    //设置慢查询阈值(毫秒)，小于等于0时不记录
+    void setSlowQueryThreshold(int msecs);
+    int slowQueryThreshold() const;
+    //统计结果文本，每个visitor每个阶段一行
+    QString dump();
+    //清空统计数据
+    void reset();
+
+    //直方图桶数，第0个桶记录1微秒以下，第i个桶记录[2^(i-1), 2^i)微秒
+    static constexpr int BUCKET_COUNT = 24;
+
+protected:
+    DbQueryStats();
+
+    struct PhaseStats {
+        qint64 count {0};
+        qint64 totalNsecs {0};
+        qint64 maxNsecs {0};
+        qint64 buckets[BUCKET_COUNT] {};
+    };
+
+    struct VisitorStats {
+        PhaseStats phases[PhaseCount];
+        qint64 slowCount {0};
+    };
+
+    //耗时所在的桶
+    static int bucketIndex(qint64 nsecs);
+    //直方图估算的百分位耗时(微秒)，取所在桶的上界
+    static qint64 percentileUsecs(const PhaseStats &stats, int percent);
+    //visitor的类名
+    static QString visitorName(const char *typeName);
+
+protected:
+    //以typeid名称为键，同一类型的名称指针唯一
+    QHash<const char *, VisitorStats> m_stats;
+    QMutex m_lock;
+    QAtomicInt m_slowQueryMsecs {100};
+};
+
+#endif // DBQUERYSTATS_H
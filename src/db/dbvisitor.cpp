@@ -46,6 +46,7 @@ const QStringList DbVisitor::DBNote::noteColumnsName = {
     "delete_time",
     "expand_filed1", //使用扩展字段记录笔记是否置顶
     "expand_filed2", //使用扩展字段记录笔记数据是否已经加密
+    "content_hash", //正文内容哈希，由第2版表结构升级添加
 };
 
 const QStringList DbVisitor::DBSafer::saferColumnsName = {
@@ -106,6 +107,15 @@ const QStringList &DbVisitor::dbvSqls()
     return m_dbvSqls;
 }
 
+/**
+ * @brief DbVisitor::dbvBindValues
+ * @return sql语句绑定参数
+ */
+const QVector<QVariantList> &DbVisitor::dbvBindValues()
+{
+    return m_dbvBindValues;
+}
+
 /**
  * @brief DbVisitor::extraData
  * @return 扩展数据
@@ -124,6 +134,139 @@ void DbVisitor::checkSqlStr(QString &sql)
     sql.replace("'", "''");
 }
 
+/**
+ * @brief DbVisitor::appendSql
+ * @param sql sql语句，参数使用?占位
+ * @param bindValues 按顺序绑定的参数
+ */
+void DbVisitor::appendSql(const QString &sql, const QVariantList &bindValues)
+{
+    //语句文本不随参数变化，数据库管理类以此为键缓存预编译语句
+    m_dbvSqls.append(sql);
+    m_dbvBindValues.append(bindValues);
+}
+
+constexpr int DbVisitor::MAX_IN_IDS;
+constexpr int DbVisitor::METADATA_COMPRESS_SIZE;
+constexpr char DbVisitor::METADATA_COMPRESSED_MARKER;
+
+/**
+ * @brief DbVisitor::packMetaData
+ * 压缩后非加密数据以BLOB保存，加密数据仍为base64文本
+ * @param metaData 元数据
+ * @param encrypt 是否加密
+ * @return 写入数据库的值
+ */
+QVariant DbVisitor::packMetaData(const QString &metaData, bool encrypt)
+{
+    if (metaData.size() >= METADATA_COMPRESS_SIZE) {
+        QByteArray rawData = metaData.toUtf8();
+        QByteArray packedData = qCompress(rawData);
+
+        //压缩无收益时保持原格式
+        if (packedData.size() + 1 < rawData.size()) {
+            packedData.prepend(METADATA_COMPRESSED_MARKER);
+
+            if (encrypt) {
+                return QString(packedData.toBase64());
+            }
+
+            return packedData;
+        }
+    }
+
+    if (encrypt) {
+        return QString(metaData.toLocal8Bit().toBase64());
+    }
+
+    return metaData;
+}
+
+/**
+ * @brief DbVisitor::unpackMetaData
+ * 兼容未压缩的旧数据
+ * @param stored 数据库中的值
+ * @param encrypt 是否加密
+ * @return 元数据
+ */
+QString DbVisitor::unpackMetaData(const QVariant &stored, bool encrypt)
+{
+    QByteArray data;
+
+    //查询时，如果是加密数据，则需要解密
+    if (encrypt) {
+        data = QByteArray::fromBase64(stored.toByteArray());
+    } else if (QVariant::ByteArray == stored.type()) {
+        data = stored.toByteArray();
+    } else {
+        return stored.toString();
+    }
+
+    if (!data.isEmpty() && METADATA_COMPRESSED_MARKER == data.at(0)) {
+        return QString::fromUtf8(qUncompress(reinterpret_cast<const uchar *>(data.constData()) + 1, data.size() - 1));
+    }
+
+    return QString::fromUtf8(data);
+}
+
+/**
+ * @brief DbVisitor::toDbTime
+ * @param time 时间
+ * @return 存储格式，毫秒级时间戳，无效时间为0
+ */
+qint64 DbVisitor::toDbTime(const QDateTime &time)
+{
+    return time.isValid() ? time.toMSecsSinceEpoch() : 0;
+}
+
+/**
+ * @brief DbVisitor::fromDbTime
+ * 兼容第4版表结构之前的文本格式
+ * @param stored 数据库中的值
+ * @return 时间
+ */
+QDateTime DbVisitor::fromDbTime(const QVariant &stored)
+{
+    if (stored.isNull()) {
+        return QDateTime();
+    }
+
+    if (QVariant::String == stored.type()) {
+        return stored.toDateTime();
+    }
+
+    return QDateTime::fromMSecsSinceEpoch(stored.toLongLong());
+}
+
+/**
+ * @brief DbVisitor::appendInSql
+ * id数量向上取整到2的幂并用最后一个id补齐，
+ * 使语句文本只有少数几种，便于预编译语句复用
+ * @param sqlFmt 含%1的sql语句
+ * @param leadValues 绑定在id之前的参数
+ * @param ids id列表
+ */
+void DbVisitor::appendInSql(const QString &sqlFmt, const QVariantList &leadValues, const QVariantList &ids)
+{
+    for (int offset = 0; offset < ids.size(); offset += MAX_IN_IDS) {
+        QVariantList chunk = ids.mid(offset, MAX_IN_IDS);
+
+        int bucket = 1;
+        while (bucket < chunk.size()) {
+            bucket <<= 1;
+        }
+
+        while (chunk.size() < bucket) {
+            chunk.append(chunk.last());
+        }
+
+        QString placeholders = QString("?,").repeated(bucket);
+        placeholders.chop(1);
+
+        appendSql(sqlFmt.arg(placeholders), leadValues + chunk);
+    }
+}
+
 /**
  * @brief FolderQryDbVisitor::FolderQryDbVisitor
  * @param db
@@ -158,9 +301,9 @@ bool FolderQryDbVisitor::visitorData()
 
             folder->maxNoteIdRef() = m_sqlQuery->value(DBFolder::max_noteid).toInt();
 
-            folder->createTime = m_sqlQuery->value(DBFolder::create_time).toDateTime();
-            folder->modifyTime = m_sqlQuery->value(DBFolder::modify_time).toDateTime();
-            folder->deleteTime = m_sqlQuery->value(DBFolder::delete_time).toDateTime();
+            folder->createTime = fromDbTime(m_sqlQuery->value(DBFolder::create_time));
+            folder->modifyTime = fromDbTime(m_sqlQuery->value(DBFolder::modify_time));
+            folder->deleteTime = fromDbTime(m_sqlQuery->value(DBFolder::delete_time));
             folder->encryption = m_sqlQuery->value(DBFolder::encrypt).toInt();
             //查询时，如果是加密数据，则需要解密
             folder->name = folder->encryption ? QByteArray::fromBase64(folderName.toByteArray()) : folderName.toString();
@@ -192,7 +335,7 @@ bool FolderQryDbVisitor::prepareSqls()
     QString querySql;
     querySql.sprintf(QUERY_FOLDERS_FMT, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::create_time].toUtf8().data());
 
-    m_dbvSqls.append(querySql);
+    appendSql(querySql);
 
     return true;
 }
@@ -219,8 +362,6 @@ bool NoteQryDbVisitor::visitorData()
     if (nullptr != results.notes) {
         isOK = true;
 
-        MetaDataParser metaParser;
-
         while (m_sqlQuery->next()) {
             VNoteItem *note = new VNoteItem();
 
@@ -229,25 +370,23 @@ bool NoteQryDbVisitor::visitorData()
             note->folderId = m_sqlQuery->value(DBNote::folder_id).toInt();
             note->noteType = m_sqlQuery->value(DBNote::note_type).toInt();
             QVariant noteTitle = m_sqlQuery->value(DBNote::note_title);
-            //Parse meta data
-            QVariant metaData = m_sqlQuery->value(DBNote::meta_data);
 
             //查询时，如果是加密数据，则需要解密
             if (note->encryption) {
                 note->noteTitle = QByteArray::fromBase64(noteTitle.toByteArray());
-                metaData = QByteArray::fromBase64(metaData.toByteArray());
             } else {
                 note->noteTitle = noteTitle.toString();
             }
 
-            note->setMetadata(metaData);
-            metaParser.parse(metaData, note);
+            //只查询了摘要，正文在使用时由NoteBodyQryDbVisitor加载
+            note->bodyLoaded = false;
+            note->contentHash = m_sqlQuery->value(DBNote::content_hash).toLongLong();
 
             note->noteState = m_sqlQuery->value(DBNote::note_state).toInt();
 
-            note->createTime = m_sqlQuery->value(DBNote::create_time).toDateTime();
-            note->modifyTime = m_sqlQuery->value(DBNote::modify_time).toDateTime();
-            note->deleteTime = m_sqlQuery->value(DBNote::modify_time).toDateTime();
+            note->createTime = fromDbTime(m_sqlQuery->value(DBNote::create_time));
+            note->modifyTime = fromDbTime(m_sqlQuery->value(DBNote::modify_time));
+            note->deleteTime = fromDbTime(m_sqlQuery->value(DBNote::modify_time));
 
             //************Expand fileds begin**********
             //TODO:
@@ -286,16 +425,113 @@ bool NoteQryDbVisitor::visitorData()
  */
 bool NoteQryDbVisitor::prepareSqls()
 {
-    static constexpr char const *QUERY_NOTES_FMT = "SELECT * FROM %s ORDER BY %s;";
+    static constexpr char const *QUERY_NOTES_FMT = "SELECT %s FROM %s ORDER BY %s;";
+
+    //启动时不读取正文，正文列用NULL占位，保持列序号与DBNote一致
+    QStringList columns = DBNote::noteColumnsName;
+    columns[DBNote::meta_data] = "NULL";
 
     QString querySql;
-    querySql.sprintf(QUERY_NOTES_FMT, VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data());
 
-    m_dbvSqls.append(querySql);
+    if (nullptr == param.range) {
+        querySql.sprintf(QUERY_NOTES_FMT, columns.join(",").toUtf8().data(), VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data());
+
+        appendSql(querySql);
+
+        return true;
+    }
+
+    //按主键分页，每批的查询代价与已加载的数量无关
+    static constexpr char const *QUERY_RANGE_FMT = "SELECT %s FROM %s WHERE %s>?";
+
+    querySql.sprintf(QUERY_RANGE_FMT, columns.join(",").toUtf8().data(), VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+
+    QVariantList bindValues = {param.range->afterNoteId};
+
+    if (param.range->folderId >= 0) {
+        querySql += " AND " + DBNote::noteColumnsName[DBNote::folder_id] + "=?";
+        bindValues.append(param.range->folderId);
+    }
+
+    if (param.range->excludeFolderId >= 0) {
+        querySql += " AND " + DBNote::noteColumnsName[DBNote::folder_id] + "<>?";
+        bindValues.append(param.range->excludeFolderId);
+    }
+
+    querySql += " ORDER BY " + DBNote::noteColumnsName[DBNote::note_id] + " LIMIT ?;";
+    bindValues.append(param.range->limit);
+
+    appendSql(querySql, bindValues);
 
     return true;
 }
 
+/**
+ * @brief NoteBodyQryDbVisitor::NoteBodyQryDbVisitor
+ * @param db
+ * @param inParam 需要加载正文的记事项
+ * @param result 保存正文的记事项，可与inParam相同
+ */
+NoteBodyQryDbVisitor::NoteBodyQryDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief NoteBodyQryDbVisitor::visitorData
+ * @return true 成功
+ */
+bool NoteBodyQryDbVisitor::visitorData()
+{
+    bool isOK = false;
+
+    if (nullptr != results.newNote) {
+        MetaDataParser metaParser;
+
+        while (m_sqlQuery->next()) {
+            VNoteItem *note = results.newNote;
+
+            QVariant metaData = unpackMetaData(m_sqlQuery->value(0), m_sqlQuery->value(1).toInt());
+
+            note->setMetadata(metaData);
+            metaParser.parse(metaData, note);
+            note->bodyLoaded = true;
+
+            isOK = true;
+            break;
+        }
+    }
+
+    return isOK;
+}
+
+/**
+ * @brief NoteBodyQryDbVisitor::prepareSqls
+ * @return true 成功
+ */
+bool NoteBodyQryDbVisitor::prepareSqls()
+{
+    bool fPrepareOK = true;
+    const VNoteItem *note = param.newNote;
+
+    if (nullptr != note) {
+        static constexpr char const *QUERY_BODY_FMT = "SELECT %s,%s FROM %s WHERE %s=?;";
+
+        QString querySql;
+        querySql.sprintf(QUERY_BODY_FMT,
+                         DBNote::noteColumnsName[DBNote::meta_data].toUtf8().data(),
+                         DBNote::noteColumnsName[DBNote::encrypt].toUtf8().data(),
+                         VNoteDbManager::NOTES_TABLE_NAME,
+                         DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+
+        appendSql(querySql, {note->noteId});
+    } else {
+        fPrepareOK = false;
+    }
+
+    return fPrepareOK;
+}
+
 /**
  * @brief MaxIdFolderDbVisitor::MaxIdFolderDbVisitor
  * @param db
@@ -342,17 +578,13 @@ bool MaxIdFolderDbVisitor::prepareSqls()
     //SQLITE related:
     //    primary key table name : SQLITE_SEQUENCE
     //    max primary key feild  : SEQ
-    static constexpr char const *QUERY_DEFNAME_FMT = "SELECT SEQ FROM SQLITE_SEQUENCE where NAME='%s';";
-    QString querySql;
-    querySql.sprintf(QUERY_DEFNAME_FMT, VNoteDbManager::FOLDER_TABLE_NAME);
+    static constexpr char const *QUERY_DEFNAME_FMT = "SELECT SEQ FROM SQLITE_SEQUENCE where NAME=?;";
 
-    m_dbvSqls.append(querySql);
+    appendSql(QUERY_DEFNAME_FMT, {VNoteDbManager::FOLDER_TABLE_NAME});
 
     if (m_extraData.data.flag) {
-        QString resetFolderIdSql;
-        static constexpr char const *RESET_FOLDER_ID = "UPDATE SQLITE_SEQUENCE SET SEQ=%s where NAME='%s';";
-        resetFolderIdSql.sprintf(RESET_FOLDER_ID, QString("%1").arg(0).toUtf8().data(), VNoteDbManager::FOLDER_TABLE_NAME);
-        m_dbvSqls.append(resetFolderIdSql);
+        static constexpr char const *RESET_FOLDER_ID = "UPDATE SQLITE_SEQUENCE SET SEQ=? where NAME=?;";
+        appendSql(RESET_FOLDER_ID, {0, VNoteDbManager::FOLDER_TABLE_NAME});
     }
 
     return true;
@@ -387,9 +619,9 @@ bool AddFolderDbVisitor::visitorData()
             results.newFolder->defaultIcon = m_sqlQuery->value(DBFolder::default_icon).toInt();
             results.newFolder->iconPath = m_sqlQuery->value(DBFolder::icon_path).toString();
             results.newFolder->folder_state = m_sqlQuery->value(DBFolder::folder_state).toInt();
-            results.newFolder->createTime = m_sqlQuery->value(DBFolder::create_time).toDateTime();
-            results.newFolder->modifyTime = m_sqlQuery->value(DBFolder::modify_time).toDateTime();
-            results.newFolder->deleteTime = m_sqlQuery->value(DBFolder::delete_time).toDateTime();
+            results.newFolder->createTime = fromDbTime(m_sqlQuery->value(DBFolder::create_time));
+            results.newFolder->modifyTime = fromDbTime(m_sqlQuery->value(DBFolder::modify_time));
+            results.newFolder->deleteTime = fromDbTime(m_sqlQuery->value(DBFolder::delete_time));
             results.newFolder->encryption = m_sqlQuery->value(DBFolder::encrypt).toInt();
             //************Expand fileds begin**********
             //TODO:
@@ -412,7 +644,7 @@ bool AddFolderDbVisitor::prepareSqls()
 {
     bool fPrepareOK = true;
     if (nullptr != param.newFolder) {
-        static constexpr char const *INSERT_FMT = "INSERT INTO %s (%s,%s,%s,%s,%s,%s) VALUES ('%s', %d, '%s', '%s', '%s', %d);";
+        static constexpr char const *INSERT_FMT = "INSERT INTO %s (%s,%s,%s,%s,%s,%s) VALUES (?, ?, ?, ?, ?, ?);";
         static constexpr char const *NEWREC_FMT = "SELECT * FROM %s ORDER BY %s DESC LIMIT 1;";
 
         //Check&Init the create time parameter
@@ -430,19 +662,15 @@ bool AddFolderDbVisitor::prepareSqls()
                           DBFolder::folderColumnsName[DBFolder::create_time].toUtf8().data(),
                           DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(),
                           DBFolder::folderColumnsName[DBFolder::delete_time].toUtf8().data(),
-                          DBFolder::folderColumnsName[DBFolder::encrypt].toUtf8().data(),
-                          param.newFolder->name.toUtf8().data(),
-                          param.newFolder->defaultIcon,
-                          createTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
-                          createTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
-                          createTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
-                          0);
+                          DBFolder::folderColumnsName[DBFolder::encrypt].toUtf8().data());
+
+        qint64 createTimeMs = toDbTime(createTime);
 
         QString queryNewRec;
         queryNewRec.sprintf(NEWREC_FMT, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data());
 
-        m_dbvSqls.append(insertSql);
-        m_dbvSqls.append(queryNewRec);
+        appendSql(insertSql, {param.newFolder->name, param.newFolder->defaultIcon, createTimeMs, createTimeMs, createTimeMs, 0});
+        appendSql(queryNewRec);
     } else {
         fPrepareOK = false;
     }
@@ -470,22 +698,130 @@ bool RenameFolderDbVisitor::prepareSqls()
     bool fPrepareOK = true;
     const VNoteFolder *folder = param.newFolder;
     if (nullptr != folder) {
-        static constexpr char const *RENAME_FOLDERS_FMT = "UPDATE %s SET %s='%s', %s='%s' WHERE %s=%s;";
-        QString sqlFolderName = folder->name;
-        checkSqlStr(sqlFolderName);
+        static constexpr char const *RENAME_FOLDERS_FMT = "UPDATE %s SET %s=?, %s=? WHERE %s=?;";
 
         QString renameSql;
 
         renameSql.sprintf(RENAME_FOLDERS_FMT,
                           VNoteDbManager::FOLDER_TABLE_NAME,
                           DBFolder::folderColumnsName[DBFolder::folder_name].toUtf8().data(),
-                          folder->encryption ? sqlFolderName.toLocal8Bit().toBase64().data() : sqlFolderName.toUtf8().data(),
                           DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(),
-                          folder->modifyTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
-                          DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data(),
-                          QString("%1").arg(folder->id).toUtf8().data());
+                          DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data());
 
-        m_dbvSqls.append(renameSql);
+        //如果记事本是加密的，则更新也需要加密数据
+        QString folderName = folder->encryption ? QString(folder->name.toLocal8Bit().toBase64()) : folder->name;
+
+        appendSql(renameSql, {folderName, toDbTime(folder->modifyTime), folder->id});
+    } else {
+        fPrepareOK = false;
+    }
+
+    return fPrepareOK;
+}
+
+/**
+ * @brief likeCaseVariants
+ * SQLite的LIKE只忽略ASCII字母的大小写，其他字符生成大小写组合，与Qt::CaseInsensitive匹配的结果一致
+ * @param keyword 关键字，不超过两个字符
+ * @return 所有大小写组合
+ */
+static QStringList likeCaseVariants(const QString &keyword)
+{
+    QStringList variants({QString()});
+
+    for (uint codePoint : keyword.toUcs4()) {
+        QVector<uint> cases({codePoint});
+
+        if (codePoint >= 0x80) {
+            for (uint caseCodePoint : {QChar::toLower(codePoint), QChar::toUpper(codePoint), QChar::toTitleCase(codePoint)}) {
+                if (!cases.contains(caseCodePoint)) {
+                    cases.append(caseCodePoint);
+                }
+            }
+        }
+
+        QStringList nextVariants;
+
+        for (auto &variant : variants) {
+            for (uint caseCodePoint : cases) {
+                nextVariants.append(variant + QString::fromUcs4(&caseCodePoint, 1));
+            }
+        }
+
+        variants.swap(nextVariants);
+    }
+
+    return variants;
+}
+
+/**
+ * @brief SearchNoteDbVisitor::SearchNoteDbVisitor
+ * @param db
+ * @param inParam 搜索关键字
+ * @param result 匹配的笔记id集合
+ */
+SearchNoteDbVisitor::SearchNoteDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief SearchNoteDbVisitor::visitorData
+ * @return true 成功
+ */
+bool SearchNoteDbVisitor::visitorData()
+{
+    bool isOK = false;
+
+    if (nullptr != results.noteIds) {
+        isOK = true;
+
+        while (m_sqlQuery->next()) {
+            results.noteIds->insert(m_sqlQuery->value(0).toInt());
+        }
+    }
+
+    return isOK;
+}
+
+/**
+ * @brief SearchNoteDbVisitor::prepareSqls
+ * @return true 成功
+ */
+bool SearchNoteDbVisitor::prepareSqls()
+{
+    bool fPrepareOK = true;
+    const QString *keyword = param.keyword;
+
+    if (nullptr != keyword && !keyword->isEmpty()) {
+        QString querySql;
+
+        //trigram分词至少需要3个字符才能使用索引，更短的关键字用LIKE匹配，按字符而不是UTF-16编码单元计数
+        if (keyword->toUcs4().size() >= 3) {
+            static constexpr char const *MATCH_FMT = "SELECT rowid FROM %s WHERE %s MATCH ?;";
+            querySql.sprintf(MATCH_FMT, VNoteDbManager::NOTES_FTS_TABLE_NAME, VNoteDbManager::NOTES_FTS_TABLE_NAME);
+
+            //关键字作为一个短语匹配，短语中的双引号需要转义
+            QString phrase = *keyword;
+            phrase.replace("\"", "\"\"");
+            appendSql(querySql, {QString("\"%1\"").arg(phrase)});
+        } else {
+            static constexpr char const *LIKE_FMT = "SELECT rowid FROM %s WHERE %%1;";
+            static constexpr char const *LIKE_COND = "title LIKE ? ESCAPE '\\' OR content LIKE ? ESCAPE '\\'";
+            querySql.sprintf(LIKE_FMT, VNoteDbManager::NOTES_FTS_TABLE_NAME);
+
+            QStringList conditions;
+            QVariantList binds;
+
+            for (QString pattern : likeCaseVariants(*keyword)) {
+                pattern.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+                pattern = QString("%%1%").arg(pattern);
+                conditions.append(LIKE_COND);
+                binds << pattern << pattern;
+            }
+
+            appendSql(querySql.arg(conditions.join(" OR ")), binds);
+        }
     } else {
         fPrepareOK = false;
     }
@@ -513,19 +849,28 @@ bool DelFolderDbVisitor::prepareSqls()
     bool fPrepareOK = true;
 
     if (nullptr != param.id) {
-        static constexpr char const *DEL_FOLDER_FMT = "DELETE FROM %s WHERE %s=%s;";
-        static constexpr char const *DEL_FNOTE_FMT = "DELETE FROM %s WHERE %s=%s;";
+        static constexpr char const *DEL_FOLDER_FMT = "DELETE FROM %s WHERE %s=?;";
+        static constexpr char const *DEL_FNOTE_FMT = "DELETE FROM %s WHERE %s=?;";
         qint64 folderId = *param.id;
         QString deleteFolderSql;
 
-        deleteFolderSql.sprintf(DEL_FOLDER_FMT, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data(), QString("%1").arg(folderId).toUtf8().data());
+        deleteFolderSql.sprintf(DEL_FOLDER_FMT, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data());
 
         QString deleteNotesSql;
 
-        deleteNotesSql.sprintf(DEL_FNOTE_FMT, VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(), QString("%1").arg(folderId).toUtf8().data());
+        deleteNotesSql.sprintf(DEL_FNOTE_FMT, VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data());
 
-        m_dbvSqls.append(deleteFolderSql);
-        m_dbvSqls.append(deleteNotesSql);
+        appendSql(deleteFolderSql, {folderId});
+
+        //先删除全文索引，再删除笔记
+        if (VNoteDbManager::instance()->hasFullTextTable()) {
+            static constexpr char const *DEL_FTS_FMT = "DELETE FROM %s WHERE rowid IN (SELECT %s FROM %s WHERE %s=?);";
+            QString deleteFtsSql;
+            deleteFtsSql.sprintf(DEL_FTS_FMT, VNoteDbManager::NOTES_FTS_TABLE_NAME, DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(), VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data());
+            appendSql(deleteFtsSql, {folderId});
+        }
+
+        appendSql(deleteNotesSql, {folderId});
     } else {
         fPrepareOK = false;
     }
@@ -566,16 +911,17 @@ bool AddNoteDbVisitor::visitorData()
             note->encryption = m_sqlQuery->value(DBNote::encrypt).toInt();
             note->noteTitle = m_sqlQuery->value(DBNote::note_title).toString();
             //Parse meta data
-            QVariant metaData = m_sqlQuery->value(DBNote::meta_data);
+            QVariant metaData = unpackMetaData(m_sqlQuery->value(DBNote::meta_data), note->encryption);
 
             note->setMetadata(metaData);
             metaParser.parse(metaData, note);
+            note->contentHash = m_sqlQuery->value(DBNote::content_hash).toLongLong();
 
             note->noteState = m_sqlQuery->value(DBNote::note_state).toInt();
 
-            note->createTime = m_sqlQuery->value(DBNote::create_time).toDateTime();
-            note->modifyTime = m_sqlQuery->value(DBNote::modify_time).toDateTime();
-            note->deleteTime = m_sqlQuery->value(DBNote::modify_time).toDateTime();
+            note->createTime = fromDbTime(m_sqlQuery->value(DBNote::create_time));
+            note->modifyTime = fromDbTime(m_sqlQuery->value(DBNote::modify_time));
+            note->deleteTime = fromDbTime(m_sqlQuery->value(DBNote::modify_time));
 
             //************Expand fileds begin**********
             //TODO:
@@ -601,9 +947,9 @@ bool AddNoteDbVisitor::prepareSqls()
     const VNoteItem *note = param.newNote;
 
     if ((nullptr != note) && (nullptr != folder)) {
-        static constexpr char const *INSERT_FMT = "INSERT INTO %s (%s,%s,%s,%s,%s,%s,%s,%s) VALUES (%lld,%d,'%s','%s','%s','%s','%s',%d);";
-        static constexpr char const *UPDATE_FOLDER_TIME = "UPDATE %s SET %s=%s,%s='%s' WHERE %s=%s;";
-        static constexpr char const *NEWREC_FMT = "SELECT * FROM %s WHERE %s=%s ORDER BY %s DESC LIMIT 1;";
+        static constexpr char const *INSERT_FMT = "INSERT INTO %s (%s,%s,%s,%s,%s,%s,%s,%s,%s) VALUES (?,?,?,?,?,?,?,?,?);";
+        static constexpr char const *UPDATE_FOLDER_TIME = "UPDATE %s SET %s=?,%s=? WHERE %s=?;";
+        static constexpr char const *NEWREC_FMT = "SELECT %s FROM %s WHERE %s=? ORDER BY %s DESC LIMIT 1;";
 
         //Check&Init the create time parameter
         //create/modify/delete time are same for new note
@@ -612,10 +958,7 @@ bool AddNoteDbVisitor::prepareSqls()
             createTime = QDateTime::currentDateTime();
         }
 
-        QString metaDataStr = note->metaDataConstRef().toString();
-        checkSqlStr(metaDataStr);
-        QString noteTitle = note->noteTitle;
-        checkSqlStr(noteTitle);
+        qint64 createTimeMs = toDbTime(createTime);
 
         QString insertSql;
 
@@ -629,25 +972,28 @@ bool AddNoteDbVisitor::prepareSqls()
                           DBNote::noteColumnsName[DBNote::modify_time].toUtf8().data(),
                           DBNote::noteColumnsName[DBNote::delete_time].toUtf8().data(),
                           DBNote::noteColumnsName[DBNote::encrypt].toUtf8().data(),
-                          note->folderId,
-                          note->noteType,
-                          noteTitle.toUtf8().data(),
-                          metaDataStr.toUtf8().data(),
-                          createTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
-                          createTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
-                          createTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
-                          0);
+                          DBNote::noteColumnsName[DBNote::content_hash].toUtf8().data());
 
         QString updateSql;
 
-        updateSql.sprintf(UPDATE_FOLDER_TIME, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::max_noteid].toUtf8().data(), QString("%1").arg(param.newNote->folder()->maxNoteIdRef()).toUtf8().data(), DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(), createTime.toString(VNOTE_TIME_FMT).toUtf8().data(), DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data(), QString("%1").arg(note->folderId).toUtf8().data());
+        updateSql.sprintf(UPDATE_FOLDER_TIME, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::max_noteid].toUtf8().data(), DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(), DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data());
 
         QString queryNewRec;
-        queryNewRec.sprintf(NEWREC_FMT, VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(), QString("%1").arg(note->folderId).toUtf8().data(), DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+        //新增列位于表末尾，按列名查询保持列序号与DBNote一致
+        queryNewRec.sprintf(NEWREC_FMT, DBNote::noteColumnsName.join(",").toUtf8().data(), VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(), DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+
+        appendSql(insertSql, {note->folderId, note->noteType, note->noteTitle, packMetaData(note->metaDataConstRef().toString(), false), createTimeMs, createTimeMs, createTimeMs, 0, note->contentHash});
 
-        m_dbvSqls.append(insertSql);
-        m_dbvSqls.append(updateSql);
-        m_dbvSqls.append(queryNewRec);
+        //同步全文索引，rowid使用刚插入的note_id
+        if (VNoteDbManager::instance()->hasFullTextTable()) {
+            static constexpr char const *INSERT_FTS_FMT = "INSERT INTO %s(rowid,title,content) VALUES (last_insert_rowid(),?,?);";
+            QString insertFtsSql;
+            insertFtsSql.sprintf(INSERT_FTS_FMT, VNoteDbManager::NOTES_FTS_TABLE_NAME);
+            appendSql(insertFtsSql, {note->noteTitle, note->searchText()});
+        }
+
+        appendSql(updateSql, {note->folder()->maxNoteIdRef(), createTimeMs, note->folderId});
+        appendSql(queryNewRec, {note->folderId});
     } else {
         fPrepareOK = false;
     }
@@ -676,32 +1022,35 @@ bool RenameNoteDbVisitor::prepareSqls()
     const VNoteItem *note = param.newNote;
 
     if (nullptr != note) {
-        static constexpr char const *MODIFY_NOTETEXT_FMT = "UPDATE %s SET %s='%s', %s='%s' WHERE %s=%lld AND %s=%d;";
-        static constexpr char const *UPDATE_FOLDER_TIME = "UPDATE %s SET %s='%s' WHERE %s=%s;";
-
-        QString sqlTitle = note->noteTitle;
-        checkSqlStr(sqlTitle);
+        static constexpr char const *MODIFY_NOTETEXT_FMT = "UPDATE %s SET %s=?, %s=? WHERE %s=? AND %s=?;";
+        static constexpr char const *UPDATE_FOLDER_TIME = "UPDATE %s SET %s=? WHERE %s=?;";
 
         QString modifyNoteTextSql;
         modifyNoteTextSql.sprintf(MODIFY_NOTETEXT_FMT,
                                   VNoteDbManager::NOTES_TABLE_NAME,
                                   DBNote::noteColumnsName[DBNote::note_title].toUtf8().data(),
-                                  //如果笔记是加密的，则更新也需要加密数据
-                                  note->encryption ? sqlTitle.toLocal8Bit().toBase64().data() : sqlTitle.toUtf8().data(),
                                   DBNote::noteColumnsName[DBNote::modify_time].toUtf8().data(),
-                                  note->modifyTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
                                   DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(),
-                                  note->folderId,
-                                  DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(),
-                                  note->noteId);
+                                  DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+
+        //如果笔记是加密的，则更新也需要加密数据
+        QString noteTitle = note->encryption ? QString(note->noteTitle.toLocal8Bit().toBase64()) : note->noteTitle;
 
         QString updateSql;
         QDateTime modifyTime = QDateTime::currentDateTime();
 
-        updateSql.sprintf(UPDATE_FOLDER_TIME, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(), modifyTime.toString(VNOTE_TIME_FMT).toUtf8().data(), DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data(), QString("%1").arg(note->folderId).toUtf8().data());
+        updateSql.sprintf(UPDATE_FOLDER_TIME, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(), DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data());
+
+        appendSql(modifyNoteTextSql, {noteTitle, toDbTime(note->modifyTime), note->folderId, note->noteId});
+        appendSql(updateSql, {toDbTime(modifyTime), note->folderId});
 
-        m_dbvSqls.append(modifyNoteTextSql);
-        m_dbvSqls.append(updateSql);
+        //加密笔记没有全文索引，更新不会命中
+        if (VNoteDbManager::instance()->hasFullTextTable()) {
+            static constexpr char const *RENAME_FTS_FMT = "UPDATE %s SET title=? WHERE rowid=?;";
+            QString renameFtsSql;
+            renameFtsSql.sprintf(RENAME_FTS_FMT, VNoteDbManager::NOTES_FTS_TABLE_NAME);
+            appendSql(renameFtsSql, {note->noteTitle, note->noteId});
+        }
     } else {
         fPrepareOK = false;
     }
@@ -730,32 +1079,54 @@ bool UpdateNoteDbVisitor::prepareSqls()
     const VNoteItem *note = param.newNote;
 
     if (nullptr != note) {
-        static constexpr char const *MODIFY_NOTETEXT_FMT = "UPDATE %s SET %s='%s', %s='%s' WHERE %s=%lld AND %s=%d;";
-        static constexpr char const *UPDATE_FOLDER_TIME = "UPDATE %s SET %s='%s' WHERE %s=%s;";
-
-        QString metaDataStr = note->metaDataConstRef().toString();
-        checkSqlStr(metaDataStr);
+        //异步保存的快照可能晚于移动、重命名提交，只按note_id定位，所属记事本和标题以数据库为准
+        static constexpr char const *MODIFY_NOTETEXT_FMT = "UPDATE %s SET %s=?, %s=?, %s=? WHERE %s=?;";
+        static constexpr char const *UPDATE_FOLDER_TIME = "UPDATE %s SET %s=? WHERE %s=(SELECT %s FROM %s WHERE %s=?);";
 
         QString modifyNoteTextSql;
         modifyNoteTextSql.sprintf(MODIFY_NOTETEXT_FMT,
                                   VNoteDbManager::NOTES_TABLE_NAME,
                                   DBNote::noteColumnsName[DBNote::meta_data].toUtf8().data(),
-                                  //如果笔记是加密的，则更新也需要加密数据
-                                  note->encryption ? metaDataStr.toLocal8Bit().toBase64().data() : metaDataStr.toUtf8().data(),
                                   DBNote::noteColumnsName[DBNote::modify_time].toUtf8().data(),
-                                  note->modifyTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
-                                  DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(),
-                                  note->folderId,
-                                  DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(),
-                                  note->noteId);
+                                  DBNote::noteColumnsName[DBNote::content_hash].toUtf8().data(),
+                                  DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+
+        //如果笔记是加密的，则更新也需要加密数据
+        QVariant metaData = packMetaData(note->metaDataConstRef().toString(), note->encryption);
 
         QString updateSql;
         QDateTime modifyTime = QDateTime::currentDateTime();
 
-        updateSql.sprintf(UPDATE_FOLDER_TIME, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(), modifyTime.toString(VNOTE_TIME_FMT).toUtf8().data(), DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data(), QString("%1").arg(note->folderId).toUtf8().data());
-
-        m_dbvSqls.append(modifyNoteTextSql);
-        m_dbvSqls.append(updateSql);
+        updateSql.sprintf(UPDATE_FOLDER_TIME,
+                          VNoteDbManager::FOLDER_TABLE_NAME,
+                          DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(),
+                          DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data(),
+                          DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(),
+                          VNoteDbManager::NOTES_TABLE_NAME,
+                          DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+
+        appendSql(modifyNoteTextSql, {metaData, toDbTime(note->modifyTime), note->contentHash, note->noteId});
+        appendSql(updateSql, {toDbTime(modifyTime), note->noteId});
+
+        //重建该笔记的全文索引，加密笔记只删除不建立；笔记已删除时不插入
+        if (VNoteDbManager::instance()->hasFullTextTable()) {
+            static constexpr char const *DEL_FTS_FMT = "DELETE FROM %s WHERE rowid=?;";
+            static constexpr char const *INSERT_FTS_FMT = "INSERT INTO %s(rowid,title,content) SELECT %s,%s,? FROM %s WHERE %s=?;";
+            QString deleteFtsSql;
+            deleteFtsSql.sprintf(DEL_FTS_FMT, VNoteDbManager::NOTES_FTS_TABLE_NAME);
+            appendSql(deleteFtsSql, {note->noteId});
+
+            if (!note->encryption) {
+                QString insertFtsSql;
+                insertFtsSql.sprintf(INSERT_FTS_FMT,
+                                     VNoteDbManager::NOTES_FTS_TABLE_NAME,
+                                     DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(),
+                                     DBNote::noteColumnsName[DBNote::note_title].toUtf8().data(),
+                                     VNoteDbManager::NOTES_TABLE_NAME,
+                                     DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+                appendSql(insertFtsSql, {note->searchText(), note->noteId});
+            }
+        }
     } else {
         fPrepareOK = false;
     }
@@ -782,15 +1153,13 @@ bool UpdateNoteTopDbVisitor::prepareSqls()
     bool fPrepareOK = true;
     const VNoteItem *note = param.newNote;
     if (note != nullptr) {
-        static constexpr char const *UPDATE_NOTE_TOP = "UPDATE %s SET %s=%d WHERE %s=%d;";
+        static constexpr char const *UPDATE_NOTE_TOP = "UPDATE %s SET %s=? WHERE %s=?;";
         QString updateSql;
         updateSql.sprintf(UPDATE_NOTE_TOP,
                           VNoteDbManager::NOTES_TABLE_NAME,
                           DBNote::noteColumnsName[DBNote::is_top].toUtf8().data(),
-                          note->isTop,
-                          DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(),
-                          note->noteId);
-        m_dbvSqls.append(updateSql);
+                          DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+        appendSql(updateSql, {note->isTop, note->noteId});
     } else {
         fPrepareOK = false;
     }
@@ -817,15 +1186,13 @@ bool UpdateNoteFolderIdDbVisitor::prepareSqls()
     bool fPrepareOK = true;
     const VNoteItem *note = param.newNote;
     if (note != nullptr) {
-        static constexpr char const *UPDATE_NOTE_FOLDERID = "UPDATE %s SET %s=%lld WHERE %s=%d;";
+        static constexpr char const *UPDATE_NOTE_FOLDERID = "UPDATE %s SET %s=? WHERE %s=?;";
         QString updateSql;
         updateSql.sprintf(UPDATE_NOTE_FOLDERID,
                           VNoteDbManager::NOTES_TABLE_NAME,
                           DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(),
-                          note->folderId,
-                          DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(),
-                          note->noteId);
-        m_dbvSqls.append(updateSql);
+                          DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+        appendSql(updateSql, {note->folderId, note->noteId});
     } else {
         fPrepareOK = false;
     }
@@ -852,20 +1219,185 @@ bool DelNoteDbVisitor::prepareSqls()
     bool fPrepareOK = true;
     const VNoteItem *note = param.newNote;
     if (nullptr != note && nullptr != note->folder()) {
-        static constexpr char const *DEL_NOTE_FMT = "DELETE FROM %s WHERE %s=%s AND %s=%s;";
-        static constexpr char const *UPDATE_FOLDER_TIME = "UPDATE %s SET %s=%s, %s='%s' WHERE %s=%s;";
+        static constexpr char const *DEL_NOTE_FMT = "DELETE FROM %s WHERE %s=? AND %s=?;";
+        static constexpr char const *UPDATE_FOLDER_TIME = "UPDATE %s SET %s=?, %s=? WHERE %s=?;";
 
         QString deleteSql;
 
-        deleteSql.sprintf(DEL_NOTE_FMT, VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(), QString("%1").arg(note->folderId).toUtf8().data(), DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(), QString("%1").arg(note->noteId).toUtf8().data());
+        deleteSql.sprintf(DEL_NOTE_FMT, VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(), DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
 
         QString updateSql;
         QDateTime modifyTime = QDateTime::currentDateTime();
 
-        updateSql.sprintf(UPDATE_FOLDER_TIME, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::max_noteid].toUtf8().data(), QString("%1").arg(note->folder()->maxNoteIdRef()).toUtf8().data(), DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(), modifyTime.toString(VNOTE_TIME_FMT).toUtf8().data(), DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data(), QString("%1").arg(note->folderId).toUtf8().data());
+        updateSql.sprintf(UPDATE_FOLDER_TIME, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::max_noteid].toUtf8().data(), DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(), DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data());
 
-        m_dbvSqls.append(deleteSql);
-        m_dbvSqls.append(updateSql);
+        appendSql(deleteSql, {note->folderId, note->noteId});
+        appendSql(updateSql, {note->folder()->maxNoteIdRef(), toDbTime(modifyTime), note->folderId});
+
+        if (VNoteDbManager::instance()->hasFullTextTable()) {
+            static constexpr char const *DEL_FTS_FMT = "DELETE FROM %s WHERE rowid=?;";
+            QString deleteFtsSql;
+            deleteFtsSql.sprintf(DEL_FTS_FMT, VNoteDbManager::NOTES_FTS_TABLE_NAME);
+            appendSql(deleteFtsSql, {note->noteId});
+        }
+    } else {
+        fPrepareOK = false;
+    }
+
+    return fPrepareOK;
+}
+
+/**
+ * @brief UpdateNotesTopDbVisitor::UpdateNotesTopDbVisitor
+ * @param db
+ * @param inParam 记事项列表，置顶值取自各记事项
+ * @param result
+ */
+UpdateNotesTopDbVisitor::UpdateNotesTopDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief UpdateNotesTopDbVisitor::prepareSqls
+ * @return true 成功
+ */
+bool UpdateNotesTopDbVisitor::prepareSqls()
+{
+    bool fPrepareOK = true;
+    const QList<VNoteItem *> *notes = param.notes;
+
+    if (nullptr != notes && !notes->isEmpty()) {
+        static constexpr char const *UPDATE_NOTES_TOP = "UPDATE %s SET %s=? WHERE %s IN (%%1);";
+        QString updateSql;
+        updateSql.sprintf(UPDATE_NOTES_TOP,
+                          VNoteDbManager::NOTES_TABLE_NAME,
+                          DBNote::noteColumnsName[DBNote::is_top].toUtf8().data(),
+                          DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+
+        //按置顶值分组，每组一条语句
+        QMap<int, QVariantList> topNoteIds;
+        for (auto note : *notes) {
+            topNoteIds[note->isTop].append(note->noteId);
+        }
+
+        for (auto it = topNoteIds.begin(); it != topNoteIds.end(); ++it) {
+            appendInSql(updateSql, {it.key()}, it.value());
+        }
+    } else {
+        fPrepareOK = false;
+    }
+
+    return fPrepareOK;
+}
+
+/**
+ * @brief UpdateNotesFolderIdDbVisitor::UpdateNotesFolderIdDbVisitor
+ * @param db
+ * @param inParam 记事项列表，目标记事本id取自各记事项
+ * @param result
+ */
+UpdateNotesFolderIdDbVisitor::UpdateNotesFolderIdDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief UpdateNotesFolderIdDbVisitor::prepareSqls
+ * @return true 成功
+ */
+bool UpdateNotesFolderIdDbVisitor::prepareSqls()
+{
+    bool fPrepareOK = true;
+    const QList<VNoteItem *> *notes = param.notes;
+
+    if (nullptr != notes && !notes->isEmpty()) {
+        static constexpr char const *UPDATE_NOTES_FOLDERID = "UPDATE %s SET %s=? WHERE %s IN (%%1);";
+        static constexpr char const *UPDATE_FOLDER_TIME = "UPDATE %s SET %s=? WHERE %s=?;";
+        QString updateSql;
+        updateSql.sprintf(UPDATE_NOTES_FOLDERID,
+                          VNoteDbManager::NOTES_TABLE_NAME,
+                          DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(),
+                          DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+
+        QString updateFolderSql;
+        updateFolderSql.sprintf(UPDATE_FOLDER_TIME, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(), DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data());
+
+        //按目标记事本分组，移动操作通常只有一组
+        QMap<qint64, QVariantList> folderNoteIds;
+        for (auto note : *notes) {
+            folderNoteIds[note->folderId].append(note->noteId);
+        }
+
+        //每个目标记事本只更新一次修改时间
+        qint64 modifyTimeMs = toDbTime(QDateTime::currentDateTime());
+        for (auto it = folderNoteIds.begin(); it != folderNoteIds.end(); ++it) {
+            appendInSql(updateSql, {it.key()}, it.value());
+            appendSql(updateFolderSql, {modifyTimeMs, it.key()});
+        }
+    } else {
+        fPrepareOK = false;
+    }
+
+    return fPrepareOK;
+}
+
+/**
+ * @brief DelNotesDbVisitor::DelNotesDbVisitor
+ * @param db
+ * @param inParam 记事项列表，所属记事本的maxid需已更新
+ * @param result
+ */
+DelNotesDbVisitor::DelNotesDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief DelNotesDbVisitor::prepareSqls
+ * @return true 成功
+ */
+bool DelNotesDbVisitor::prepareSqls()
+{
+    bool fPrepareOK = true;
+    const QList<VNoteItem *> *notes = param.notes;
+
+    if (nullptr != notes && !notes->isEmpty()) {
+        static constexpr char const *DEL_NOTES_FMT = "DELETE FROM %s WHERE %s IN (%%1);";
+        static constexpr char const *UPDATE_FOLDER_TIME = "UPDATE %s SET %s=?, %s=? WHERE %s=?;";
+
+        QString deleteSql;
+        deleteSql.sprintf(DEL_NOTES_FMT, VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::note_id].toUtf8().data());
+
+        QString updateSql;
+        updateSql.sprintf(UPDATE_FOLDER_TIME, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::max_noteid].toUtf8().data(), DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(), DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data());
+
+        QVariantList noteIds;
+        QMap<qint64, VNoteFolder *> folders;
+
+        for (auto note : *notes) {
+            if (Q_UNLIKELY(nullptr == note->folder())) {
+                return false;
+            }
+
+            noteIds.append(note->noteId);
+            folders.insert(note->folderId, note->folder());
+        }
+
+        appendInSql(deleteSql, QVariantList(), noteIds);
+
+        if (VNoteDbManager::instance()->hasFullTextTable()) {
+            static constexpr char const *DEL_FTS_FMT = "DELETE FROM %s WHERE rowid IN (%%1);";
+            QString deleteFtsSql;
+            deleteFtsSql.sprintf(DEL_FTS_FMT, VNoteDbManager::NOTES_FTS_TABLE_NAME);
+            appendInSql(deleteFtsSql, QVariantList(), noteIds);
+        }
+
+        //每个记事本只更新一次maxid和时间
+        qint64 modifyTimeMs = toDbTime(QDateTime::currentDateTime());
+        for (auto it = folders.begin(); it != folders.end(); ++it) {
+            appendSql(updateSql, {it.value()->maxNoteIdRef(), modifyTimeMs, it.key()});
+        }
     } else {
         fPrepareOK = false;
     }
@@ -10,6 +10,8 @@
 
 #include <QSqlQuery>
 #include <QScopedPointer>
+#include <QVector>
+#include <QSet>
 
 class DbVisitor
 {
@@ -24,6 +26,8 @@ public:
     QSqlQuery *sqlQuery();
     //获取所有执行的sql语句
     const QStringList &dbvSqls();
+    //获取sql语句对应的绑定参数，与dbvSqls一一对应
+    const QVector<QVariantList> &dbvBindValues();
 
     struct ExtraData {
         union {
@@ -34,6 +38,18 @@ public:
     };
     //扩展，用于执行一些特殊功能
     ExtraData &extraData();
+    //元数据转换为存储格式，超过阈值时压缩
+    static QVariant packMetaData(const QString &metaData, bool encrypt);
+    //存储格式还原为元数据
+    static QString unpackMetaData(const QVariant &stored, bool encrypt);
+    //元数据压缩阈值(字符数)
+    static constexpr int METADATA_COMPRESS_SIZE = 4096;
+    //压缩数据的首字节标记，json/xml元数据不会以此字节开头
+    static constexpr char METADATA_COMPRESSED_MARKER = '\x01';
+    //时间转换为存储格式(毫秒级时间戳)
+    static qint64 toDbTime(const QDateTime &time);
+    //存储格式还原为时间
+    static QDateTime fromDbTime(const QVariant &stored);
 
 public:
     //记事本表字段
@@ -68,6 +84,7 @@ public:
             delete_time,
             is_top,
             encrypt,
+            content_hash,
         };
 
         static const QStringList noteColumnsName;
@@ -90,6 +107,12 @@ public:
 protected:
     //Check & replace the "'" in the string.
     void checkSqlStr(QString &sql);
+    //添加sql语句，参数使用?占位并按顺序绑定
+    void appendSql(const QString &sql, const QVariantList &bindValues = QVariantList());
+    //按批添加IN(...)语句，sqlFmt中的%1替换为占位符，leadValues绑定在ids之前
+    void appendInSql(const QString &sqlFmt, const QVariantList &leadValues, const QVariantList &ids);
+    //单条IN(...)语句绑定的最大id数，低于旧版sqlite的999个参数限制
+    static constexpr int MAX_IN_IDS = 512;
     //sql处理的结果
     union {
         VNOTE_FOLDERS_MAP *folders;
@@ -97,6 +120,7 @@ protected:
         VNoteFolder *newFolder;
         VNoteItem *newNote;
         SafetyDatas *safetyDatas;
+        QSet<qint32> *noteIds;
         qint32 *count;
         qint64 *id;
         void *ptr;
@@ -106,6 +130,9 @@ protected:
         const VNoteFolder *newFolder;
         const VNoteItem *newNote;
         const VDataSafer *safer;
+        const QString *keyword;
+        const QList<VNoteItem *> *notes;
+        const VNOTE_NOTES_RANGE *range;
         const qint32 *count;
         const qint64 *id;
         const void *ptr;
@@ -114,6 +141,7 @@ protected:
     QScopedPointer<QSqlQuery> m_sqlQuery {nullptr};
 
     QStringList m_dbvSqls;
+    QVector<QVariantList> m_dbvBindValues;
 
     ExtraData m_extraData; //Use defined, default not used.
 };
@@ -157,6 +185,16 @@ public:
     virtual bool prepareSqls() override;
 };
 
+//记事项全文搜索
+class SearchNoteDbVisitor : public DbVisitor
+{
+public:
+    explicit SearchNoteDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool visitorData() override;
+    virtual bool prepareSqls() override;
+};
+
 //删除记事本
 class DelFolderDbVisitor : public DbVisitor
 {
@@ -166,7 +204,7 @@ public:
     virtual bool prepareSqls() override;
 };
 
-//记事项查询
+//记事项查询，inParam为VNOTE_NOTES_RANGE时只查询该范围
 class NoteQryDbVisitor : public DbVisitor
 {
 public:
@@ -176,6 +214,16 @@ public:
     virtual bool prepareSqls() override;
 };
 
+//记事项正文查询
+class NoteBodyQryDbVisitor : public DbVisitor
+{
+public:
+    explicit NoteBodyQryDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool visitorData() override;
+    virtual bool prepareSqls() override;
+};
+
 //添加记事项
 class AddNoteDbVisitor : public DbVisitor
 {
@@ -213,6 +261,15 @@ public:
     virtual bool prepareSqls() override;
 };
 
+//批量更新记事项置顶属性
+class UpdateNotesTopDbVisitor : public DbVisitor
+{
+public:
+    explicit UpdateNotesTopDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool prepareSqls() override;
+};
+
 //更新笔记所属记事本id
 class UpdateNoteFolderIdDbVisitor : public DbVisitor
 {
@@ -222,6 +279,15 @@ public:
     virtual bool prepareSqls() override;
 };
 
+//批量更新笔记所属记事本id
+class UpdateNotesFolderIdDbVisitor : public DbVisitor
+{
+public:
+    explicit UpdateNotesFolderIdDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool prepareSqls() override;
+};
+
 //记事项删除
 class DelNoteDbVisitor : public DbVisitor
 {
@@ -230,4 +296,13 @@ public:
 
     virtual bool prepareSqls() override;
 };
+
+//批量删除记事项
+class DelNotesDbVisitor : public DbVisitor
+{
+public:
+    explicit DelNotesDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool prepareSqls() override;
+};
 #endif
@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "vnotedbconnectionpool.h"
+
+#include <DLog>
+
+#include <QThread>
+#include <QSqlError>
+
+/**
+ * @brief VNoteDbConnectionPool::Connection::~Connection
+ * 由QThreadStorage在所属线程退出时调用
+ */
+VNoteDbConnectionPool::Connection::~Connection()
+{
+    qDeleteAll(stmtCache);
+    stmtCache.clear();
+
+    db.close();
+    db = QSqlDatabase();
+
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+/**
+ * @brief VNoteDbConnectionPool::VNoteDbConnectionPool
+ * @param dbPath 数据库文件路径
+ * @param connectionPrefix 连接名前缀，不同数据库需不同
+ */
+VNoteDbConnectionPool::VNoteDbConnectionPool(const QString &dbPath, const QString &connectionPrefix)
+    : m_dbPath(dbPath)
+    , m_connectionPrefix(connectionPrefix)
+{
+}
+
+/**
+ * @brief VNoteDbConnectionPool::~VNoteDbConnectionPool
+ */
+VNoteDbConnectionPool::~VNoteDbConnectionPool()
+{
+    releaseConnection();
+}
+
+/**
+ * @brief VNoteDbConnectionPool::setConnectionPragmas
+ * 只影响之后打开的连接，需在首次获取连接前设置
+ * @param pragmas PRAGMA语句
+ */
+void VNoteDbConnectionPool::setConnectionPragmas(const QStringList &pragmas)
+{
+    m_pragmas = pragmas;
+}
+
+/**
+ * @brief VNoteDbConnectionPool::connection
+ * @return 当前线程的连接
+ */
+VNoteDbConnectionPool::Connection *VNoteDbConnectionPool::connection()
+{
+    if (!m_connections.hasLocalData()) {
+        m_connections.setLocalData(openConnection());
+    }
+
+    return m_connections.localData();
+}
+
+/**
+ * @brief VNoteDbConnectionPool::hasConnection
+ * @return true 当前线程已打开连接
+ */
+bool VNoteDbConnectionPool::hasConnection()
+{
+    return m_connections.hasLocalData();
+}
+
+/**
+ * @brief VNoteDbConnectionPool::releaseConnection
+ * 连接池销毁前由所属线程调用，其他线程的连接在线程退出时释放
+ */
+void VNoteDbConnectionPool::releaseConnection()
+{
+    if (m_connections.hasLocalData()) {
+        m_connections.setLocalData(nullptr);
+    }
+}
+
+/**
+ * @brief VNoteDbConnectionPool::databasePath
+ * @return 数据库文件路径
+ */
+const QString &VNoteDbConnectionPool::databasePath() const
+{
+    return m_dbPath;
+}
+
+/**
+ * @brief VNoteDbConnectionPool::openConnection
+ * @return 新连接
+ */
+VNoteDbConnectionPool::Connection *VNoteDbConnectionPool::openConnection()
+{
+    Connection *conn = new Connection();
+    conn->connectionName = QString("%1_%2")
+                               .arg(m_connectionPrefix)
+                               .arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+
+    conn->db = QSqlDatabase::addDatabase("QSQLITE", conn->connectionName);
+    conn->db.setDatabaseName(m_dbPath);
+    //读写并发时等待而不是直接返回SQLITE_BUSY
+    conn->db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+
+    if (!conn->db.open()) {
+        qCritical() << "Open database connection failed:" << conn->db.lastError().text();
+        return conn;
+    }
+
+    QSqlQuery sqlQuery(conn->db);
+
+    for (auto it : m_pragmas) {
+        if (!sqlQuery.exec(it)) {
+            qCritical() << it << "set pragma failed error: " << sqlQuery.lastError().text();
+        }
+    }
+
+    qInfo() << "Database connection opened:" << conn->connectionName;
+
+    return conn;
+}
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef VNOTEDBCONNECTIONPOOL_H
+#define VNOTEDBCONNECTIONPOOL_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QHash>
+#include <QStringList>
+#include <QThreadStorage>
+
+//数据库连接池，每个线程使用自己的连接，首次使用时打开，线程退出时释放
+class VNoteDbConnectionPool
+{
+public:
+    //线程连接
+    struct Connection {
+        ~Connection();
+        QString connectionName;
+        QSqlDatabase db;
+        //预编译语句缓存，以语句文本为键
+        QHash<QString, QSqlQuery *> stmtCache;
+    };
+
+    explicit VNoteDbConnectionPool(const QString &dbPath, const QString &connectionPrefix);
+    ~VNoteDbConnectionPool();
+    //设置每个新连接打开后执行的语句
+    void setConnectionPragmas(const QStringList &pragmas);
+    //获取当前线程的连接，打开失败时连接不可用
+    Connection *connection();
+    //当前线程是否已打开连接
+    bool hasConnection();
+    //释放当前线程的连接
+    void releaseConnection();
+    //数据库文件路径
+    const QString &databasePath() const;
+
+protected:
+    //打开新连接
+    Connection *openConnection();
+
+protected:
+    QString m_dbPath;
+    QString m_connectionPrefix;
+    QStringList m_pragmas;
+    QThreadStorage<Connection *> m_connections;
+};
+
+#endif // VNOTEDBCONNECTIONPOOL_H
@@ -5,7 +5,10 @@
 
 #include "db/vnotedbmanager.h"
 #include "db/dbvisitor.h"
+#include "db/dbquerystats.h"
 #include "globaldef.h"
+#include "common/metadataparser.h"
+#include "common/vnoteitem.h"
 
 #include <DLog>
 
@@ -14,17 +17,23 @@
 #include <QFile>
 #include <QFileDevice>
 #include <QSqlError>
+#include <QSqlDriver>
+#include <QElapsedTimer>
 
 #define CRITICAL_SECTION_BEGIN() \
     do { \
-        m_dbLock.lock(); \
-        /*m_vnoteDB.transaction();*/ \
+        if (!beginTransaction()) { \
+            return false; \
+        } \
     } while (0)
 
-#define CRITICAL_SECTION_END() \
+#define CRITICAL_SECTION_END(isOK) \
     do { \
-        /*m_vnoteDB.commit();*/ \
-        m_dbLock.unlock(); \
+        if (isOK) { \
+            isOK = commitTransaction(); \
+        } else { \
+            rollbackTransaction(); \
+        } \
     } while (0)
 
 #define CHECK_DB_INIT() \
@@ -35,6 +44,8 @@
     } while (0)
 
 VNoteDbManager *VNoteDbManager::_instance = nullptr;
+constexpr int VNoteDbManager::SCHEMA_VERSION;
+constexpr int VNoteDbManager::FULL_TEXT_BATCH_NOTES;
 
 /**
  * @brief VNoteDbManager::VNoteDbManager
@@ -52,7 +63,6 @@ VNoteDbManager::VNoteDbManager(bool fOldDb, QObject *parent)
  */
 VNoteDbManager::~VNoteDbManager()
 {
-    m_vnoteDB.close();
 }
 
 /**
@@ -70,11 +80,56 @@ VNoteDbManager *VNoteDbManager::instance()
 
 /**
  * @brief VNoteDbManager::getVNoteDb
- * @return 数据库对象
+ * visitor需在执行它的线程中创建，使用该线程的连接
+ * @return 当前线程的数据库连接
  */
 QSqlDatabase &VNoteDbManager::getVNoteDb()
 {
-    return m_vnoteDB;
+    return m_connectionPool->connection()->db;
+}
+
+/**
+ * @brief VNoteDbManager::schemaVersion
+ * @return 表结构版本，查询失败返回-1
+ */
+int VNoteDbManager::schemaVersion()
+{
+    QSqlQuery sqlQuery(getVNoteDb());
+
+    if (sqlQuery.exec("PRAGMA user_version;") && sqlQuery.next()) {
+        return sqlQuery.value(0).toInt();
+    }
+
+    qCritical() << "Query schema version failed:" << sqlQuery.lastError().text();
+
+    return -1;
+}
+
+/**
+ * @brief VNoteDbManager::hasFullTextIndex
+ * @return true 全文索引可用于搜索
+ */
+bool VNoteDbManager::hasFullTextIndex() const
+{
+    return 0 != m_hasFullTextIndex.loadAcquire();
+}
+
+/**
+ * @brief VNoteDbManager::hasFullTextTable
+ * @return true 全文索引表存在
+ */
+bool VNoteDbManager::hasFullTextTable() const
+{
+    return 0 != m_hasFullTextTable.loadAcquire();
+}
+
+/**
+ * @brief VNoteDbManager::databasePath
+ * @return 数据库文件路径，未初始化时为空
+ */
+QString VNoteDbManager::databasePath() const
+{
+    return m_connectionPool.isNull() ? QString() : m_connectionPool->databasePath();
 }
 
 /**
@@ -93,16 +148,17 @@ bool VNoteDbManager::insertData(DbVisitor *visitor /*in/out*/)
         return false;
     }
 
-    if (Q_UNLIKELY(!visitor->prepareSqls())) {
+    if (Q_UNLIKELY(!prepareSqls(visitor))) {
         qCritical() << "prepare sqls failed!";
         return false;
     }
 
     CRITICAL_SECTION_BEGIN();
 
-    for (auto it : visitor->dbvSqls()) {
+    for (int i = 0; i < visitor->dbvSqls().size(); i++) {
+        const QString &it = visitor->dbvSqls().at(i);
         if (!it.trimmed().isEmpty()) {
-            if (!visitor->sqlQuery()->exec(it)) {
+            if (!execSql(visitor, i)) {
                 qCritical() << "insert data failed:" << it
                             << " reason:" << visitor->sqlQuery()->lastError().text();
                 insertOK = false;
@@ -110,13 +166,16 @@ bool VNoteDbManager::insertData(DbVisitor *visitor /*in/out*/)
         }
     }
 
-    CRITICAL_SECTION_END();
-
-    if (!visitor->visitorData()) {
+    //结果集与缓存语句共享，需在锁内读取完毕
+    if (!visitorData(visitor)) {
         insertOK = false;
         qCritical() << "Query new data failed: visitorData failed.";
     }
 
+    visitor->sqlQuery()->finish();
+
+    CRITICAL_SECTION_END(insertOK);
+
     return insertOK;
 }
 
@@ -136,16 +195,17 @@ bool VNoteDbManager::updateData(DbVisitor *visitor /*in/out*/)
         return false;
     }
 
-    if (Q_UNLIKELY(!visitor->prepareSqls())) {
+    if (Q_UNLIKELY(!prepareSqls(visitor))) {
         qCritical() << "prepare sqls failed!";
         return false;
     }
 
     CRITICAL_SECTION_BEGIN();
 
-    for (auto it : visitor->dbvSqls()) {
+    for (int i = 0; i < visitor->dbvSqls().size(); i++) {
+        const QString &it = visitor->dbvSqls().at(i);
         if (!it.trimmed().isEmpty()) {
-            if (!visitor->sqlQuery()->exec(it)) {
+            if (!execSql(visitor, i)) {
                 qCritical() << "Update data failed:" << it
                             << " reason:" << visitor->sqlQuery()->lastError().text();
                 updateOK = false;
@@ -153,7 +213,9 @@ bool VNoteDbManager::updateData(DbVisitor *visitor /*in/out*/)
         }
     }
 
-    CRITICAL_SECTION_END();
+    visitor->sqlQuery()->finish();
+
+    CRITICAL_SECTION_END(updateOK);
 
     return updateOK;
 }
@@ -174,16 +236,22 @@ bool VNoteDbManager::queryData(DbVisitor *visitor /*in/out*/)
         return false;
     }
 
-    if (Q_UNLIKELY(!visitor->prepareSqls())) {
+    if (Q_UNLIKELY(!prepareSqls(visitor))) {
         qCritical() << "prepare sqls failed!";
         return false;
     }
 
-    CRITICAL_SECTION_BEGIN();
+    //只读查询在当前线程的连接上执行，WAL模式下不与写操作竞争锁
+    bool needLock = !isReadOnly(visitor);
 
-    for (auto it : visitor->dbvSqls()) {
+    if (needLock) {
+        m_dbLock.lock();
+    }
+
+    for (int i = 0; i < visitor->dbvSqls().size(); i++) {
+        const QString &it = visitor->dbvSqls().at(i);
         if (!it.trimmed().isEmpty()) {
-            if (!visitor->sqlQuery()->exec(it)) {
+            if (!execSql(visitor, i)) {
                 qCritical() << "Query data failed:" << it
                             << " reason:" << visitor->sqlQuery()->lastError().text();
                 queryOK = false;
@@ -191,13 +259,18 @@ bool VNoteDbManager::queryData(DbVisitor *visitor /*in/out*/)
         }
     }
 
-    CRITICAL_SECTION_END();
-
-    if (!visitor->visitorData()) {
+    //结果集与缓存语句共享，需在锁内读取完毕
+    if (!visitorData(visitor)) {
         qCritical() << "Query data failed: visitorData failed.";
         queryOK = false;
     }
 
+    visitor->sqlQuery()->finish();
+
+    if (needLock) {
+        m_dbLock.unlock();
+    }
+
     return queryOK;
 }
 
@@ -217,16 +290,17 @@ bool VNoteDbManager::deleteData(DbVisitor *visitor /*in/out*/)
         return false;
     }
 
-    if (Q_UNLIKELY(!visitor->prepareSqls())) {
+    if (Q_UNLIKELY(!prepareSqls(visitor))) {
         qCritical() << "prepare sqls failed!";
         return false;
     }
 
     CRITICAL_SECTION_BEGIN();
 
-    for (auto it : visitor->dbvSqls()) {
+    for (int i = 0; i < visitor->dbvSqls().size(); i++) {
+        const QString &it = visitor->dbvSqls().at(i);
         if (!it.trimmed().isEmpty()) {
-            if (!visitor->sqlQuery()->exec(it)) {
+            if (!execSql(visitor, i)) {
                 qCritical() << "Delete data failed:" << it
                             << " reason:" << visitor->sqlQuery()->lastError().text();
                 deleteOK = false;
@@ -234,11 +308,103 @@ bool VNoteDbManager::deleteData(DbVisitor *visitor /*in/out*/)
         }
     }
 
-    CRITICAL_SECTION_END();
+    visitor->sqlQuery()->finish();
+
+    CRITICAL_SECTION_END(deleteOK);
 
     return deleteOK;
 }
 
+/**
+ * @brief VNoteDbManager::beginTransaction
+ * 开始事务，可嵌套，只有最外层在提交时写入数据库；
+ * 失败时撤销本次调用，调用方不执行操作，也不再提交或回滚
+ * @return true 成功
+ */
+bool VNoteDbManager::beginTransaction()
+{
+    CHECK_DB_INIT();
+
+    m_dbLock.lock();
+
+    //事务在当前线程的连接上执行，同线程的查询可以看到未提交的数据
+    if (0 == m_transactionDepth++) {
+        m_writeSerial.ref();
+
+        QSqlDatabase &vnoteDB = getVNoteDb();
+        m_transactionFailed = !vnoteDB.transaction();
+
+        if (m_transactionFailed) {
+            qCritical() << "Begin transaction failed:" << vnoteDB.lastError().text();
+        }
+    }
+
+    //外层事务已失败时不再执行，避免操作在自动提交模式下部分写入
+    if (m_transactionFailed) {
+        if (0 == --m_transactionDepth) {
+            m_transactionFailed = false;
+        }
+
+        m_dbLock.unlock();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteDbManager::commitTransaction
+ * 提交事务，事务中有操作失败时回滚
+ * @return true 成功
+ */
+bool VNoteDbManager::commitTransaction()
+{
+    CHECK_DB_INIT();
+
+    bool commitOK = !m_transactionFailed;
+
+    if (0 == --m_transactionDepth) {
+        QSqlDatabase &vnoteDB = getVNoteDb();
+
+        if (commitOK) {
+            commitOK = vnoteDB.commit();
+
+            if (!commitOK) {
+                qCritical() << "Commit transaction failed:" << vnoteDB.lastError().text();
+                vnoteDB.rollback();
+            }
+        } else {
+            vnoteDB.rollback();
+        }
+
+        m_transactionFailed = false;
+    }
+
+    m_dbLock.unlock();
+
+    return commitOK;
+}
+
+/**
+ * @brief VNoteDbManager::rollbackTransaction
+ * 回滚事务，嵌套时由最外层统一回滚
+ */
+void VNoteDbManager::rollbackTransaction()
+{
+    if (!m_isDbInitOK) {
+        return;
+    }
+
+    m_transactionFailed = true;
+
+    if (0 == --m_transactionDepth) {
+        getVNoteDb().rollback();
+        m_transactionFailed = false;
+    }
+
+    m_dbLock.unlock();
+}
+
 /**
  * @brief VNoteDbManager::hasOldDataBase
  * @return true 存在老数据库
@@ -285,15 +451,21 @@ int VNoteDbManager::initVNoteDb(bool fOldDB)
 
     QString vnoteDbFullPath = dbDir.filePath() + vnoteDatebaseName;
 
-    if (QSqlDatabase::contains(vnoteDatebaseName)) {
-        m_vnoteDB = QSqlDatabase::database(vnoteDatebaseName);
-    } else {
-        m_vnoteDB = QSqlDatabase::addDatabase("QSQLITE", vnoteDatebaseName);
-        m_vnoteDB.setDatabaseName(vnoteDbFullPath);
+    m_isDbInitOK = false;
+    m_schemaUpgradePending = false;
+    m_hasFullTextIndex.storeRelease(0);
+    m_hasFullTextTable.storeRelease(0);
+    m_connectionPool.reset(new VNoteDbConnectionPool(vnoteDbFullPath, vnoteDatebaseName));
+
+    if (!fOldDB) {
+        //同步级别是连接级别的设置，每个连接都需要设置
+        m_connectionPool->setConnectionPragmas({"PRAGMA synchronous=NORMAL;"});
     }
 
-    if (!m_vnoteDB.open()) {
-        qCritical() << "Open database failed:" << m_vnoteDB.lastError().text();
+    QSqlDatabase &vnoteDB = getVNoteDb();
+
+    if (!vnoteDB.isOpen()) {
+        qCritical() << "Open database failed:" << vnoteDB.lastError().text();
 
         return -1;
     }
@@ -301,7 +473,17 @@ int VNoteDbManager::initVNoteDb(bool fOldDB)
     qInfo() << "Database opened:" << vnoteDbFullPath;
 
     if (!fOldDB) {
+        initDbPragmas();
         createTablesIfNeed();
+
+        //已有数据的升级可能重写整个笔记表，推迟到后台加载数据时执行，不阻塞界面显示
+        m_schemaUpgradePending = (schemaVersion() < SCHEMA_VERSION);
+
+        if (m_schemaUpgradePending && isEmptyDatabase()) {
+            m_schemaUpgradePending = !upgradeSchemaIfNeed();
+        }
+
+        createFullTextIndexIfNeed();
     }
 
     m_isDbInitOK = true;
@@ -309,6 +491,30 @@ int VNoteDbManager::initVNoteDb(bool fOldDB)
     return 0;
 }
 
+/**
+ * @brief VNoteDbManager::initDbPragmas
+ * WAL模式下读不阻塞写，写也不阻塞读
+ */
+void VNoteDbManager::initDbPragmas()
+{
+    //日志模式记录在数据库文件中，只需设置一次；
+    //同步级别由连接池在每个连接上设置为NORMAL，WAL模式下已能保证数据库一致性
+    //增量清理模式必须在建表前设置，只对新建的数据库生效；
+    //已有数据库转换需要VACUUM重建整个文件，不自动转换，维护时跳过空间回收
+    static const QStringList pragmaSqls = {
+        "PRAGMA auto_vacuum=INCREMENTAL;",
+        "PRAGMA journal_mode=WAL;",
+    };
+
+    QSqlQuery sqlQuery(getVNoteDb());
+
+    for (auto it : pragmaSqls) {
+        if (!sqlQuery.exec(it)) {
+            qCritical() << it << "set pragma failed error: " << sqlQuery.lastError().text();
+        }
+    }
+}
+
 /**
  * @brief VNoteDbManager::createTablesIfNeed
  */
@@ -316,7 +522,7 @@ void VNoteDbManager::createTablesIfNeed()
 {
     QStringList createTableSqls = QString(CREATETABLE_FMT).split(";");
 
-    QScopedPointer<QSqlQuery> sqlQuery(new QSqlQuery(m_vnoteDB));
+    QScopedPointer<QSqlQuery> sqlQuery(new QSqlQuery(getVNoteDb()));
 
     for (auto it : createTableSqls) {
         if (!it.trimmed().isEmpty()) {
@@ -326,3 +532,693 @@ void VNoteDbManager::createTablesIfNeed()
         }
     }
 }
+
+/**
+ * @brief VNoteDbManager::writeSerial
+ * @return 写操作计数
+ */
+int VNoteDbManager::writeSerial() const
+{
+    return m_writeSerial.loadAcquire();
+}
+
+/**
+ * @brief VNoteDbManager::freeSpaceBytes
+ * @return 可回收的字节数，失败返回-1
+ */
+qint64 VNoteDbManager::freeSpaceBytes()
+{
+    QVariant freePages;
+    QVariant pageSize;
+
+    if (!execMaintenanceSql("PRAGMA freelist_count;", &freePages)
+        || !execMaintenanceSql("PRAGMA page_size;", &pageSize)) {
+        return -1;
+    }
+
+    return freePages.toLongLong() * pageSize.toLongLong();
+}
+
+/**
+ * @brief VNoteDbManager::isIncrementalVacuum
+ * @return true 增量清理模式
+ */
+bool VNoteDbManager::isIncrementalVacuum()
+{
+    QVariant mode;
+
+    //0:NONE 1:FULL 2:INCREMENTAL
+    return execMaintenanceSql("PRAGMA auto_vacuum;", &mode) && 2 == mode.toInt();
+}
+
+/**
+ * @brief VNoteDbManager::incrementalVacuum
+ * @param pages 本次回收的最大页数
+ * @return true 成功
+ */
+bool VNoteDbManager::incrementalVacuum(int pages)
+{
+    return execMaintenanceSql(QString("PRAGMA incremental_vacuum(%1);").arg(pages));
+}
+
+/**
+ * @brief VNoteDbManager::analyze
+ * 首次执行完整统计，之后由sqlite判断哪些表需要重新统计
+ * @return true 成功
+ */
+bool VNoteDbManager::analyze()
+{
+    QVariant statCount;
+
+    if (!execMaintenanceSql("SELECT count(*) FROM sqlite_master WHERE name='sqlite_stat1';", &statCount)) {
+        return false;
+    }
+
+    if (0 == statCount.toInt()) {
+        //限制每个索引的采样行数，大数据库上也能很快完成
+        return execMaintenanceSql("PRAGMA analysis_limit=1000;")
+               && execMaintenanceSql("ANALYZE;");
+    }
+
+    return execMaintenanceSql("PRAGMA optimize;");
+}
+
+/**
+ * @brief VNoteDbManager::quickCheck
+ * @return true 数据库完整
+ */
+bool VNoteDbManager::quickCheck()
+{
+    QVariant checkResult;
+
+    if (!execMaintenanceSql("PRAGMA quick_check;", &checkResult)) {
+        return false;
+    }
+
+    if (checkResult.toString() != "ok") {
+        qCritical() << "Database quick check failed:" << checkResult.toString();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteDbManager::execMaintenanceSql
+ * @param sql 维护语句
+ * @param result 第一行第一列的值，可为空
+ * @return true 成功
+ */
+bool VNoteDbManager::execMaintenanceSql(const QString &sql, QVariant *result)
+{
+    CHECK_DB_INIT();
+
+    QMutexLocker locker(&m_dbLock);
+
+    QSqlQuery sqlQuery(getVNoteDb());
+
+    if (!sqlQuery.exec(sql)) {
+        qCritical() << "Maintenance sql failed:" << sql
+                    << " reason:" << sqlQuery.lastError().text();
+        return false;
+    }
+
+    //读完结果集，保证语句执行完毕并释放读锁
+    bool hasRow = sqlQuery.next();
+
+    if (nullptr != result && hasRow) {
+        *result = sqlQuery.value(0);
+    }
+
+    while (sqlQuery.next()) {
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteDbManager::isOwnConnection
+ * @param visitor
+ * @return true visitor绑定在当前线程的连接上
+ */
+bool VNoteDbManager::isOwnConnection(DbVisitor *visitor)
+{
+    return m_connectionPool->hasConnection()
+           && visitor->sqlQuery()->driver() == getVNoteDb().driver();
+}
+
+/**
+ * @brief VNoteDbManager::isReadOnly
+ * @param visitor
+ * @return true 只包含本数据库上的查询语句
+ */
+bool VNoteDbManager::isReadOnly(DbVisitor *visitor)
+{
+    //其他数据库(如老数据库)的语句仍在锁内执行
+    if (!isOwnConnection(visitor)) {
+        return false;
+    }
+
+    for (auto it : visitor->dbvSqls()) {
+        if (!it.trimmed().startsWith("SELECT", Qt::CaseInsensitive)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteDbManager::cachedQuery
+ * @param sql 带?占位符的sql语句
+ * @return 预编译语句，失败返回nullptr
+ */
+QSqlQuery *VNoteDbManager::cachedQuery(const QString &sql)
+{
+    VNoteDbConnectionPool::Connection *conn = m_connectionPool->connection();
+    QHash<QString, QSqlQuery *> &stmtCache = conn->stmtCache;
+
+    QSqlQuery *stmt = stmtCache.value(sql, nullptr);
+
+    if (nullptr == stmt) {
+        stmt = new QSqlQuery(conn->db);
+        stmt->setForwardOnly(true);
+
+        if (!stmt->prepare(sql)) {
+            qCritical() << "Prepare sql failed:" << sql
+                        << " reason:" << stmt->lastError().text();
+            delete stmt;
+            return nullptr;
+        }
+
+        stmtCache.insert(sql, stmt);
+    }
+
+    return stmt;
+}
+
+/**
+ * @brief VNoteDbManager::execSql
+ * @param visitor
+ * @param index 语句序号
+ * @return true 成功
+ */
+bool VNoteDbManager::execSql(DbVisitor *visitor, int index)
+{
+    const QString &sql = visitor->dbvSqls().at(index);
+    const QVariantList bindValues = visitor->dbvBindValues().value(index);
+
+    //结束上一条语句的结果集，避免未完成的查询阻塞事务提交
+    visitor->sqlQuery()->finish();
+
+    QElapsedTimer execTimer;
+    execTimer.start();
+
+    bool execOK = false;
+
+    //不属于本数据库连接的语句(如老数据库)直接执行
+    if (!isOwnConnection(visitor)) {
+        execOK = visitor->sqlQuery()->exec(sql);
+    } else {
+        QSqlQuery *stmt = cachedQuery(sql);
+
+        if (nullptr == stmt) {
+            return false;
+        }
+
+        for (int i = 0; i < bindValues.size(); i++) {
+            stmt->bindValue(i, bindValues.at(i));
+        }
+
+        execOK = stmt->exec();
+
+        //结果集共享给visitor，在visitorData中读取
+        *visitor->sqlQuery() = *stmt;
+    }
+
+    qint64 nsecs = execTimer.nsecsElapsed();
+    DbQueryStats::instance()->record(visitor, DbQueryStats::Exec, nsecs);
+    DbQueryStats::instance()->checkSlowQuery(visitor, sql, nsecs);
+
+    return execOK;
+}
+
+/**
+ * @brief VNoteDbManager::prepareSqls
+ * @param visitor
+ * @return true 成功
+ */
+bool VNoteDbManager::prepareSqls(DbVisitor *visitor)
+{
+    QElapsedTimer prepareTimer;
+    prepareTimer.start();
+
+    bool prepareOK = visitor->prepareSqls();
+
+    DbQueryStats::instance()->record(visitor, DbQueryStats::Prepare, prepareTimer.nsecsElapsed());
+
+    return prepareOK;
+}
+
+/**
+ * @brief VNoteDbManager::visitorData
+ * @param visitor
+ * @return true 成功
+ */
+bool VNoteDbManager::visitorData(DbVisitor *visitor)
+{
+    QElapsedTimer visitTimer;
+    visitTimer.start();
+
+    bool visitOK = visitor->visitorData();
+
+    DbQueryStats::instance()->record(visitor, DbQueryStats::VisitorData, visitTimer.nsecsElapsed());
+
+    return visitOK;
+}
+
+/**
+ * @brief VNoteDbManager::upgradeSchemaIfPending
+ * 在加载数据的后台线程中调用，升级期间界面的写操作等待写锁
+ * @return true 成功或不需要升级
+ */
+bool VNoteDbManager::upgradeSchemaIfPending()
+{
+    QMutexLocker locker(&m_dbLock);
+
+    if (!m_isDbInitOK || !m_schemaUpgradePending) {
+        return true;
+    }
+
+    m_schemaUpgradePending = !upgradeSchemaIfNeed();
+
+    return !m_schemaUpgradePending;
+}
+
+/**
+ * @brief VNoteDbManager::isEmptyDatabase
+ * @return true 没有笔记
+ */
+bool VNoteDbManager::isEmptyDatabase()
+{
+    QSqlQuery sqlQuery(getVNoteDb());
+
+    if (sqlQuery.exec(QString("SELECT EXISTS(SELECT 1 FROM %1);").arg(NOTES_TABLE_NAME)) && sqlQuery.next()) {
+        return 0 == sqlQuery.value(0).toInt();
+    }
+
+    qCritical() << "Query note count failed:" << sqlQuery.lastError().text();
+
+    return false;
+}
+
+/**
+ * @brief VNoteDbManager::upgradeSchemaIfNeed
+ * 每个升级步骤与版本号在同一事务中提交，失败时保持原版本，下次启动重试
+ * @return true 成功
+ */
+bool VNoteDbManager::upgradeSchemaIfNeed()
+{
+    QMutexLocker locker(&m_dbLock);
+
+    //下标i的步骤将版本从i升级到i+1，新增步骤时追加到末尾
+    static const SchemaMigration migrations[] = {
+        &VNoteDbManager::migrateToV1,
+        &VNoteDbManager::migrateToV2,
+        &VNoteDbManager::migrateToV3,
+        &VNoteDbManager::migrateToV4,
+    };
+
+    static_assert(sizeof(migrations) / sizeof(migrations[0]) == SCHEMA_VERSION,
+                  "SCHEMA_VERSION must match the migration count");
+
+    int version = schemaVersion();
+
+    if (version < 0) {
+        return false;
+    }
+
+    for (int i = version; i < SCHEMA_VERSION; i++) {
+        //不能在自动提交模式下升级，部分失败时版本号与表结构会不一致
+        if (!getVNoteDb().transaction()) {
+            qCritical() << "Database schema upgrade failed to begin transaction, version:" << i
+                        << " reason:" << getVNoteDb().lastError().text();
+            return false;
+        }
+
+        bool upgradeOK = (this->*migrations[i])()
+                         && execSchemaSqls({QString("PRAGMA user_version=%1;").arg(i + 1)});
+
+        if (upgradeOK && getVNoteDb().commit()) {
+            qInfo() << "Database schema upgraded to version:" << (i + 1);
+        } else {
+            qCritical() << "Database schema upgrade failed, version:" << i
+                        << " reason:" << getVNoteDb().lastError().text();
+            getVNoteDb().rollback();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteDbManager::execSchemaSqls
+ * @param sqls 表结构语句
+ * @return true 全部成功
+ */
+bool VNoteDbManager::execSchemaSqls(const QStringList &sqls)
+{
+    QSqlQuery sqlQuery(getVNoteDb());
+
+    for (auto it : sqls) {
+        if (!sqlQuery.exec(it)) {
+            qCritical() << it << "exec schema sql failed error: " << sqlQuery.lastError().text();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteDbManager::migrateToV1
+ * 按记事本加载、按修改时间排序以及置顶排序不再全表扫描
+ * @return true 成功
+ */
+bool VNoteDbManager::migrateToV1()
+{
+    return execSchemaSqls({
+        "CREATE INDEX IF NOT EXISTS vnote_items_folder_idx ON vnote_items_tbl(folder_id, modify_time);",
+        "CREATE INDEX IF NOT EXISTS vnote_items_top_idx ON vnote_items_tbl(expand_filed1, modify_time);",
+    });
+}
+
+/**
+ * @brief VNoteDbManager::migrateToV2
+ * 已有笔记的哈希为空，首次保存时写入
+ * @return true 成功
+ */
+bool VNoteDbManager::migrateToV2()
+{
+    return execSchemaSqls({
+        "ALTER TABLE vnote_items_tbl ADD COLUMN content_hash INTEGER;",
+    });
+}
+
+/**
+ * @brief VNoteDbManager::migrateToV3
+ * 先取出需要压缩的id，再逐条读写，避免一次加载所有正文
+ * @return true 成功
+ */
+bool VNoteDbManager::migrateToV3()
+{
+    QSqlQuery sqlQuery(getVNoteDb());
+    sqlQuery.setForwardOnly(true);
+
+    QVector<qint32> noteIds;
+
+    if (!sqlQuery.exec(QString("SELECT note_id FROM %1 WHERE typeof(meta_data)='text' AND length(meta_data)>=%2;")
+                           .arg(NOTES_TABLE_NAME)
+                           .arg(DbVisitor::METADATA_COMPRESS_SIZE))) {
+        qCritical() << "Query notes to compress failed:" << sqlQuery.lastError().text();
+        return false;
+    }
+
+    while (sqlQuery.next()) {
+        noteIds.append(sqlQuery.value(0).toInt());
+    }
+
+    sqlQuery.finish();
+
+    QSqlQuery readQuery(getVNoteDb());
+    readQuery.setForwardOnly(true);
+    readQuery.prepare(QString("SELECT meta_data, IFNULL(expand_filed2, 0) FROM %1 WHERE note_id=?;").arg(NOTES_TABLE_NAME));
+
+    QSqlQuery writeQuery(getVNoteDb());
+    writeQuery.prepare(QString("UPDATE %1 SET meta_data=? WHERE note_id=?;").arg(NOTES_TABLE_NAME));
+
+    for (auto noteId : noteIds) {
+        readQuery.bindValue(0, noteId);
+
+        if (!readQuery.exec() || !readQuery.next()) {
+            qCritical() << "Read note to compress failed:" << readQuery.lastError().text();
+            return false;
+        }
+
+        bool encrypt = readQuery.value(1).toInt();
+        QString metaData = DbVisitor::unpackMetaData(readQuery.value(0), encrypt);
+
+        readQuery.finish();
+
+        writeQuery.bindValue(0, DbVisitor::packMetaData(metaData, encrypt));
+        writeQuery.bindValue(1, noteId);
+
+        if (!writeQuery.exec()) {
+            qCritical() << "Compress note failed:" << writeQuery.lastError().text();
+            return false;
+        }
+    }
+
+    qInfo() << "Compressed notes:" << noteIds.size();
+
+    return true;
+}
+
+/**
+ * @brief VNoteDbManager::migrateToV4
+ * DATETEXT列为文本亲和性，整数也会按文本存储，需要重建表修改列类型；
+ * 列顺序保持不变，自增序号复制到新表，避免删除的id被重用
+ * @return true 成功
+ */
+bool VNoteDbManager::migrateToV4()
+{
+    //旧数据按本地时间存储
+    static const QString TO_EPOCH_MS = "CASE typeof(%1) WHEN 'text' THEN "
+                                       "IFNULL(CAST(ROUND((julianday(%1, 'utc') - 2440587.5) * 86400000) AS INTEGER), 0) "
+                                       "ELSE %1 END";
+    static const QString NOW_EPOCH_MS = "(CAST(ROUND((julianday('now') - 2440587.5) * 86400000) AS INTEGER))";
+    static const QString TIME_COLUMNS = "create_time INTEGER NOT NULL DEFAULT %1, "
+                                        "modify_time INTEGER NOT NULL DEFAULT %1, "
+                                        "delete_time INTEGER DEFAULT %1, ";
+    static const QString EXPAND_COLUMNS = "expand_filed1 INT, expand_filed2 INT, expand_filed3 INT, "
+                                          "expand_filed4 TEXT, expand_filed5 TEXT, expand_filed6 TEXT";
+
+    struct TableDef {
+        QString name;
+        QString columns;
+        QString copyColumns;
+    };
+
+    const TableDef tables[] = {
+        {FOLDER_TABLE_NAME,
+         "folder_id INTEGER PRIMARY KEY AUTOINCREMENT, category_id INT DEFAULT 0, folder_name TEXT NOT NULL, "
+         "default_icon INT DEFAULT 0, icon_path TEXT, folder_state INT DEFAULT 0, max_noteid INT DEFAULT 0, "
+             + TIME_COLUMNS.arg(NOW_EPOCH_MS) + EXPAND_COLUMNS,
+         "folder_id, category_id, folder_name, default_icon, icon_path, folder_state, max_noteid"},
+        {NOTES_TABLE_NAME,
+         "note_id INTEGER PRIMARY KEY AUTOINCREMENT, folder_id INTEGER, note_type INT NOT NULL DEFAULT 0, "
+         "note_title TEXT NOT NULL, meta_data TEXT, note_state INT DEFAULT 0, "
+             + TIME_COLUMNS.arg(NOW_EPOCH_MS) + EXPAND_COLUMNS + ", content_hash INTEGER",
+         "note_id, folder_id, note_type, note_title, meta_data, note_state"},
+    };
+
+    QStringList sqls;
+
+    for (auto &table : tables) {
+        QString newName = table.name + "_v4";
+        QString tailColumns = "expand_filed1, expand_filed2, expand_filed3, expand_filed4, expand_filed5, expand_filed6";
+
+        if (table.name == NOTES_TABLE_NAME) {
+            tailColumns += ", content_hash";
+        }
+
+        sqls << QString("CREATE TABLE %1(%2);").arg(newName, table.columns)
+             << QString("INSERT INTO %1 SELECT %2, %3, %4, %5, %6 FROM %7;")
+                    .arg(newName, table.copyColumns,
+                         TO_EPOCH_MS.arg("create_time"), TO_EPOCH_MS.arg("modify_time"), TO_EPOCH_MS.arg("delete_time"),
+                         tailColumns, table.name)
+             << QString("DELETE FROM sqlite_sequence WHERE name='%1';").arg(newName)
+             << QString("INSERT INTO sqlite_sequence(name, seq) SELECT '%1', seq FROM sqlite_sequence WHERE name='%2';")
+                    .arg(newName, table.name)
+             << QString("DROP TABLE %1;").arg(table.name)
+             << QString("ALTER TABLE %1 RENAME TO %2;").arg(newName, table.name);
+    }
+
+    //删除旧表时索引一并删除，重新创建
+    return execSchemaSqls(sqls) && migrateToV1();
+}
+
+/**
+ * @brief VNoteDbManager::createFullTextIndexIfNeed
+ * 只创建空表，不在启动时读取正文；没有笔记时直接可用，否则等待后台导入
+ */
+void VNoteDbManager::createFullTextIndexIfNeed()
+{
+    QSqlQuery sqlQuery(getVNoteDb());
+    QStringList tableNames;
+
+    sqlQuery.prepare("SELECT name FROM sqlite_master WHERE type='table' AND name IN (?, ?);");
+    sqlQuery.addBindValue(NOTES_FTS_TABLE_NAME);
+    sqlQuery.addBindValue(NOTES_FTS_STATE_TABLE_NAME);
+
+    if (sqlQuery.exec()) {
+        while (sqlQuery.next()) {
+            tableNames.append(sqlQuery.value(0).toString());
+        }
+    }
+
+    sqlQuery.finish();
+
+    if (tableNames.contains(NOTES_FTS_TABLE_NAME)) {
+        m_hasFullTextTable.storeRelease(1);
+
+        //旧版本创建时同步导入，没有标记表，重新导入一次
+        if (tableNames.contains(NOTES_FTS_STATE_TABLE_NAME)
+            && sqlQuery.exec(QString("SELECT COUNT(*) FROM %1;").arg(NOTES_FTS_STATE_TABLE_NAME))
+            && sqlQuery.next() && sqlQuery.value(0).toInt() > 0) {
+            m_hasFullTextIndex.storeRelease(1);
+        }
+
+        return;
+    }
+
+    getVNoteDb().transaction();
+
+    //trigram分词按字符切分，中文等无空格分隔的文本也能做子串匹配
+    if (!sqlQuery.exec(QString("CREATE VIRTUAL TABLE %1 USING fts5(title, content, tokenize='trigram');")
+                           .arg(NOTES_FTS_TABLE_NAME))) {
+        qWarning() << "Full text index unavailable, search falls back to scanning:"
+                   << sqlQuery.lastError().text();
+        getVNoteDb().rollback();
+        return;
+    }
+
+    //索引表被删除后重建时，旧的完成标记无效
+    bool createOK = execSchemaSqls({QString("DROP TABLE IF EXISTS %1;").arg(NOTES_FTS_STATE_TABLE_NAME)});
+    bool isReady = createOK && isEmptyDatabase();
+
+    if (isReady) {
+        createOK = markFullTextIndexReady();
+    }
+
+    if (createOK && getVNoteDb().commit()) {
+        m_hasFullTextTable.storeRelease(1);
+        m_hasFullTextIndex.storeRelease(isReady ? 1 : 0);
+        qInfo() << "Full text index created, ready:" << isReady;
+    } else {
+        qCritical() << "Create full text index failed:" << getVNoteDb().lastError().text();
+        getVNoteDb().rollback();
+    }
+}
+
+/**
+ * @brief VNoteDbManager::markFullTextIndexReady
+ * @return true 成功
+ */
+bool VNoteDbManager::markFullTextIndexReady()
+{
+    return execSchemaSqls({
+        QString("CREATE TABLE IF NOT EXISTS %1(ready INTEGER);").arg(NOTES_FTS_STATE_TABLE_NAME),
+        QString("INSERT INTO %1(ready) VALUES (1);").arg(NOTES_FTS_STATE_TABLE_NAME),
+    });
+}
+
+/**
+ * @brief VNoteDbManager::buildFullTextIndex
+ * 每批在一个短事务中读取并写入，期间界面保存的笔记由写操作同步维护索引，
+ * 读取和写入都在写锁内，不会用旧正文覆盖新的索引数据；加密笔记不建立索引
+ * @return true 全文索引可用
+ */
+bool VNoteDbManager::buildFullTextIndex()
+{
+    CHECK_DB_INIT();
+
+    if (!hasFullTextTable()) {
+        return false;
+    }
+
+    if (hasFullTextIndex()) {
+        return true;
+    }
+
+    QElapsedTimer buildTimer;
+    buildTimer.start();
+
+    MetaDataParser metaParser;
+    qint32 lastNoteId = 0;
+    int noteCount = 0;
+    int batchCount = FULL_TEXT_BATCH_NOTES;
+
+    while (batchCount == FULL_TEXT_BATCH_NOTES) {
+        if (!beginTransaction()) {
+            return false;
+        }
+
+        QSqlQuery noteQuery(getVNoteDb());
+        noteQuery.setForwardOnly(true);
+        noteQuery.prepare(QString("SELECT note_id, note_title, meta_data FROM %1 "
+                                  "WHERE note_id>? AND IFNULL(expand_filed2, 0)=0 ORDER BY note_id LIMIT ?;")
+                              .arg(NOTES_TABLE_NAME));
+        noteQuery.addBindValue(lastNoteId);
+        noteQuery.addBindValue(FULL_TEXT_BATCH_NOTES);
+
+        QSqlQuery deleteQuery(getVNoteDb());
+        deleteQuery.prepare(QString("DELETE FROM %1 WHERE rowid=?;").arg(NOTES_FTS_TABLE_NAME));
+
+        QSqlQuery insertQuery(getVNoteDb());
+        insertQuery.prepare(QString("INSERT INTO %1(rowid, title, content) VALUES (?, ?, ?);").arg(NOTES_FTS_TABLE_NAME));
+
+        bool buildOK = noteQuery.exec();
+        batchCount = 0;
+
+        while (buildOK && noteQuery.next()) {
+            VNoteItem note;
+            lastNoteId = noteQuery.value(0).toInt();
+            metaParser.parse(DbVisitor::unpackMetaData(noteQuery.value(2), false), &note);
+
+            deleteQuery.bindValue(0, lastNoteId);
+
+            insertQuery.bindValue(0, lastNoteId);
+            insertQuery.bindValue(1, noteQuery.value(1));
+            insertQuery.bindValue(2, note.searchText());
+
+            buildOK = deleteQuery.exec() && insertQuery.exec();
+            batchCount++;
+        }
+
+        noteQuery.finish();
+
+        if (!buildOK) {
+            qCritical() << "Build full text index failed:" << noteQuery.lastError().text()
+                        << insertQuery.lastError().text();
+            rollbackTransaction();
+            return false;
+        }
+
+        if (!commitTransaction()) {
+            return false;
+        }
+
+        noteCount += batchCount;
+    }
+
+    if (!beginTransaction()) {
+        return false;
+    }
+
+    if (!markFullTextIndexReady()) {
+        rollbackTransaction();
+        return false;
+    }
+
+    if (!commitTransaction()) {
+        return false;
+    }
+
+    m_hasFullTextIndex.storeRelease(1);
+
+    qInfo() << "Full text index built, notes:" << noteCount << " elapsed ms:" << buildTimer.elapsed();
+
+    return true;
+}
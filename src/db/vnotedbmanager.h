@@ -6,10 +6,14 @@
 #ifndef VNOTEDBMANAGER_H
 #define VNOTEDBMANAGER_H
 
+#include "db/vnotedbconnectionpool.h"
+
 #include <QObject>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QMutex>
+#include <QScopedPointer>
+#include <QAtomicInt>
 
 class DbVisitor;
 
@@ -29,9 +33,14 @@ public:
     static constexpr char const *NOTES_TABLE_NAME = "vnote_items_tbl";
     static constexpr char const *NOTES_KEY = "note_id";
     static constexpr char const *CATEGORY_TABLE_NAME = "vnote_category_tbl";
+    //笔记全文索引表，rowid与note_id一致
+    static constexpr char const *NOTES_FTS_TABLE_NAME = "vnote_items_fts";
+    //全文索引导入完成的标记表，导入中断时下次启动重新导入
+    static constexpr char const *NOTES_FTS_STATE_TABLE_NAME = "vnote_items_fts_state";
 
     //icon_path: Not used, maybe used in future
     //expand_fields are place holder, will be used in future
+    //初始表结构，之后的修改由upgradeSchemaIfNeed按版本执行
     static constexpr char const *CREATETABLE_FMT = "\
          CREATE TABLE IF NOT EXISTS vnote_folder_tbl(\
             folder_id INTEGER PRIMARY KEY AUTOINCREMENT , \
@@ -92,7 +101,25 @@ public:
         VNOTE_MAX_TBL
     };
 
+    //表结构版本，记录在PRAGMA user_version中，每增加一个升级步骤加1
+    static constexpr int SCHEMA_VERSION = 4;
+    //后台导入全文索引时每个事务处理的笔记数
+    static constexpr int FULL_TEXT_BATCH_NOTES = 200;
+
+    //获取当前线程的数据库连接
     QSqlDatabase &getVNoteDb();
+    //获取数据库当前的表结构版本
+    int schemaVersion();
+    //全文索引是否可用于搜索，sqlite不支持FTS5 trigram分词或后台导入未完成时不可用
+    bool hasFullTextIndex() const;
+    //全文索引表是否存在，存在时写操作需同步维护索引，包括导入期间
+    bool hasFullTextTable() const;
+    //分批导入已有笔记，在后台线程调用，完成后全文索引可用于搜索
+    bool buildFullTextIndex();
+    //执行启动时推迟的表结构升级，在后台加载数据前调用
+    bool upgradeSchemaIfPending();
+    //数据库文件路径
+    QString databasePath() const;
     //执行插入操作
     bool insertData(DbVisitor *visitor /*in/out*/);
     //执行更新操作
@@ -101,8 +128,26 @@ public:
     bool queryData(DbVisitor *visitor /*in/out*/);
     //执行删除操作
     bool deleteData(DbVisitor *visitor /*in/out*/);
+    //开始事务，之后的数据操作合并为一次提交，成功时需与commitTransaction/rollbackTransaction成对调用
+    bool beginTransaction();
+    //提交事务
+    bool commitTransaction();
+    //回滚事务
+    void rollbackTransaction();
     //是否存在老记事本数据库
     static bool hasOldDataBase();
+    //写操作计数，每个最外层事务加1，后台维护用来检测用户操作
+    int writeSerial() const;
+    //空闲页占用的字节数，即可回收的空间
+    qint64 freeSpaceBytes();
+    //自动清理是否为增量模式，只有新建时即为增量模式的数据库才是
+    bool isIncrementalVacuum();
+    //回收最多pages个空闲页，只能在增量模式的数据库上执行
+    bool incrementalVacuum(int pages);
+    //更新查询优化器的统计信息
+    bool analyze();
+    //快速完整性检查
+    bool quickCheck();
 signals:
 
 public slots:
@@ -110,15 +155,62 @@ public slots:
 protected:
     //初始化数据库
     int initVNoteDb(bool fOldDB = false);
+    //设置日志模式等连接参数
+    void initDbPragmas();
     //创建数据表
     void createTablesIfNeed();
+    //按版本顺序执行表结构升级
+    bool upgradeSchemaIfNeed();
+    //执行一组表结构语句
+    bool execSchemaSqls(const QStringList &sqls);
+    //创建全文索引表，已有笔记由buildFullTextIndex在后台导入；索引为派生数据，不随表结构版本升级
+    void createFullTextIndexIfNeed();
+    //记录全文索引导入完成，需在事务中调用
+    bool markFullTextIndexReady();
+    //数据库中是否没有笔记，空数据库的升级和索引不需要放到后台
+    bool isEmptyDatabase();
+
+    typedef bool (VNoteDbManager::*SchemaMigration)();
+    //版本0->1: 笔记表增加记事本及置顶排序索引
+    bool migrateToV1();
+    //版本1->2: 笔记表增加正文内容哈希列
+    bool migrateToV2();
+    //版本2->3: 压缩已有的大正文
+    bool migrateToV3();
+    //版本3->4: 时间列由文本改为毫秒级时间戳
+    bool migrateToV4();
+    //visitor是否使用当前线程的连接
+    bool isOwnConnection(DbVisitor *visitor);
+    //visitor是否只包含查询语句，只读操作不需要加锁
+    bool isReadOnly(DbVisitor *visitor);
+    //获取当前线程连接上缓存的预编译语句，首次使用时编译
+    QSqlQuery *cachedQuery(const QString &sql);
+    //执行visitor中的第index条语句，记录耗时
+    bool execSql(DbVisitor *visitor, int index);
+    //生成visitor的sql语句，记录耗时
+    bool prepareSqls(DbVisitor *visitor);
+    //处理visitor的结果集，记录耗时
+    bool visitorData(DbVisitor *visitor);
+    //在写锁内执行一条维护语句，result返回第一行第一列
+    bool execMaintenanceSql(const QString &sql, QVariant *result = nullptr);
 
 protected:
-    QSqlDatabase m_vnoteDB;
-    //    QScopedPointer<QSqlQuery> m_sqlQuery;
+    //每个线程一个连接，QSqlDatabase不能跨线程使用
+    QScopedPointer<VNoteDbConnectionPool> m_connectionPool;
 
-    QMutex m_dbLock;
+    //写操作互斥，可重入，事务期间由同一线程持有
+    QMutex m_dbLock {QMutex::Recursive};
     bool m_isDbInitOK {false};
+    //事务嵌套深度
+    int m_transactionDepth {0};
+    //事务中是否有操作失败
+    bool m_transactionFailed {false};
+    //全文索引由后台线程导入，标记在多个线程中读取
+    QAtomicInt m_hasFullTextIndex {0};
+    QAtomicInt m_hasFullTextTable {0};
+    //已有数据库的表结构升级推迟到后台加载数据时执行
+    bool m_schemaUpgradePending {false};
+    QAtomicInt m_writeSerial {0};
 
     static VNoteDbManager *_instance;
 };
@@ -190,12 +190,12 @@ qint32 VNoteFolderOper::getFoldersCount()
  */
 qint32 VNoteFolderOper::getNotesCount(qint64 folderId)
 {
-    VNOTE_ITEMS_MAP *notesInFollder = VNoteDataManager::instance()->getFolderNotes(folderId);
+    VNoteFolder *folder = VNoteDataManager::instance()->getFolder(folderId);
 
     qint32 notesCount = 0;
 
-    if (nullptr != notesInFollder) {
-        notesCount = notesInFollder->folderNotes.size();
+    if (nullptr != folder) {
+        notesCount = folder->getNotesCount();
     }
 
     return notesCount;
@@ -209,8 +209,9 @@ qint32 VNoteFolderOper::getNotesCount()
 {
     qint32 notesCount = 0;
 
+    //聚合数据由数据管理类维护，绘制时直接读取
     if (m_folder != nullptr) {
-        notesCount = getNotesCount(m_folder->id);
+        notesCount = m_folder->getNotesCount();
     }
 
     return notesCount;
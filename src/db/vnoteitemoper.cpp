@@ -6,16 +6,21 @@
 #include "vnoteitemoper.h"
 #include "vnotefolderoper.h"
 #include "vnotedbmanager.h"
+#include "vnotesavequeue.h"
 #include "globaldef.h"
 #include "common/metadataparser.h"
+#include "common/utils.h"
 #include "common/vnoteitem.h"
 #include "common/vnoteforlder.h"
 #include "common/vnotedatamanager.h"
+#include "common/vnotesearchindex.h"
 #include "db/dbvisitor.h"
 
 #include <DLog>
 #include <DApplication>
 
+#include <QHash>
+
 /**
  * @brief VNoteItemOper::VNoteItemOper
  * @param note 操作对象
@@ -52,6 +57,27 @@ VNOTE_ALL_NOTES_MAP *VNoteItemOper::loadAllVNotes()
     return notesMap;
 }
 
+/**
+ * @brief VNoteItemOper::loadVNotes
+ * @param range 查询范围
+ * @return 加载的数据
+ */
+VNOTE_ALL_NOTES_MAP *VNoteItemOper::loadVNotes(const VNOTE_NOTES_RANGE &range)
+{
+    VNOTE_ALL_NOTES_MAP *notesMap = new VNOTE_ALL_NOTES_MAP();
+
+    //DataManager data should set autoRelease flag
+    notesMap->autoRelease = true;
+
+    NoteQryDbVisitor noteVisitor(VNoteDbManager::instance()->getVNoteDb(), &range, notesMap);
+
+    if (!VNoteDbManager::instance()->queryData(&noteVisitor)) {
+        qCritical() << "Load notes failed, after note id:" << range.afterNoteId;
+    }
+
+    return notesMap;
+}
+
 /**
  * @brief VNoteItemOper::modifyNoteTitle
  * @param title
@@ -77,6 +103,12 @@ bool VNoteItemOper::modifyNoteTitle(const QString &title)
             m_note->modifyTime = oldModifyTime;
 
             isUpdateOK = false;
+        } else {
+            VNoteDataManager::instance()->notifyNoteUpdated(m_note, VNoteDataManager::NoteTitleField | VNoteDataManager::NoteModifyTimeField);
+
+            if (VNoteSearchIndex::isIndexedNote(m_note)) {
+                VNoteSearchIndex::instance()->updateTitle(m_note->noteId, m_note->noteTitle);
+            }
         }
     }
 
@@ -92,36 +124,114 @@ bool VNoteItemOper::updateNote()
     bool isUpdateOK = true;
 
     if (nullptr != m_note) {
+        //正文未加载时保存会用空内容覆盖数据库中的正文
+        if (Q_UNLIKELY(!m_note->bodyLoaded)) {
+            qCritical() << "Update note failed: body not loaded, noteId:" << m_note->noteId;
+            return false;
+        }
+
         //backup
         QVariant oldMetaData = m_note->metaDataConstRef();
         QDateTime oldModifyTime = m_note->modifyTime;
+        qint64 oldContentHash = m_note->contentHash;
 
         //Prepare meta data
         MetaDataParser metaParser;
 
         metaParser.makeMetaData(m_note, m_note->metaDataRef());
 
+        //内容未变化时不写数据库，也不更新修改时间
+        qint64 contentHash = Utils::contentHash(m_note->metaDataConstRef().toString());
+        if (contentHash == oldContentHash) {
+            return true;
+        }
+
+        m_note->contentHash = contentHash;
         m_note->modifyTime = QDateTime::currentDateTime();
+        //全文索引和内存索引使用同一份纯文本
+        m_note->updatePlainText();
 
         //Reset the max voice id when no voice file.
         if (!m_note->haveVoice()) {
             m_note->maxVoiceIdRef() = 0;
         }
 
+        //丢弃未提交的旧快照，避免覆盖本次修改
+        bool hasSnapshot = VNoteSaveQueue::instance()->discard(m_note->noteId);
+
         UpdateNoteDbVisitor updateNoteVisitor(
             VNoteDbManager::instance()->getVNoteDb(), m_note, nullptr);
 
         if (Q_UNLIKELY(!VNoteDbManager::instance()->updateData(&updateNoteVisitor))) {
             m_note->setMetadata(oldMetaData);
             m_note->modifyTime = oldModifyTime;
+            m_note->contentHash = oldContentHash;
+
+            //被丢弃的快照就是恢复后的数据，重新加入队列
+            if (hasSnapshot) {
+                VNoteSaveQueue::instance()->enqueue(m_note);
+            }
 
             isUpdateOK = false;
+        } else {
+            VNoteDataManager::instance()->notifyNoteUpdated(m_note, VNoteDataManager::NoteBodyField | VNoteDataManager::NoteModifyTimeField);
+
+            if (VNoteSearchIndex::isIndexedNote(m_note)) {
+                VNoteSearchIndex::instance()->updateNote(m_note->noteId, m_note->noteTitle, m_note->searchText());
+            }
         }
     }
 
     return isUpdateOK;
 }
 
+/**
+ * @brief VNoteItemOper::updateNoteAsync
+ * 编辑器定时保存使用，同一笔记未提交的保存会被合并
+ * @return true 已放入保存队列
+ */
+bool VNoteItemOper::updateNoteAsync()
+{
+    if (nullptr == m_note) {
+        return false;
+    }
+
+    //正文未加载时保存会用空内容覆盖数据库中的正文
+    if (Q_UNLIKELY(!m_note->bodyLoaded)) {
+        qCritical() << "Update note failed: body not loaded, noteId:" << m_note->noteId;
+        return false;
+    }
+
+    MetaDataParser metaParser;
+
+    metaParser.makeMetaData(m_note, m_note->metaDataRef());
+
+    //光标移动等未改变内容的保存直接跳过
+    qint64 contentHash = Utils::contentHash(m_note->metaDataConstRef().toString());
+    if (contentHash == m_note->contentHash) {
+        return true;
+    }
+
+    m_note->contentHash = contentHash;
+    m_note->modifyTime = QDateTime::currentDateTime();
+    //快照复制缓存，保存线程写全文索引时不再解析
+    m_note->updatePlainText();
+
+    //Reset the max voice id when no voice file.
+    if (!m_note->haveVoice()) {
+        m_note->maxVoiceIdRef() = 0;
+    }
+
+    VNoteSaveQueue::instance()->enqueue(m_note);
+    VNoteDataManager::instance()->notifyNoteUpdated(m_note, VNoteDataManager::NoteBodyField | VNoteDataManager::NoteModifyTimeField);
+
+    if (VNoteSearchIndex::isIndexedNote(m_note)) {
+        VNoteSearchIndex::instance()->updateNote(m_note->noteId, m_note->noteTitle, m_note->searchText());
+    }
+
+    return true;
+}
+
 /**
  * @brief VNoteItemOper::addNote
  * @param note
@@ -142,11 +252,15 @@ VNoteItem *VNoteItemOper::addNote(VNoteItem &note)
     MetaDataParser metaParser;
     QVariant metaData;
     metaParser.makeMetaData(&note, note.metaDataRef());
+    note.contentHash = Utils::contentHash(note.metaDataConstRef().toString());
+    note.updatePlainText();
 
     VNoteItem *newNote = new VNoteItem();
     AddNoteDbVisitor addNoteVisitor(VNoteDbManager::instance()->getVNoteDb(), &note, newNote);
 
     if (VNoteDbManager::instance()->insertData(&addNoteVisitor)) {
+        newNote->copyPlainText(note);
+
         if (Q_UNLIKELY(nullptr == VNoteDataManager::instance()->addNote(newNote))) {
             qInfo() << "Add to datamanager failed:"
                     << "New Note:" << newNote->noteId
@@ -162,6 +276,8 @@ VNoteItem *VNoteItemOper::addNote(VNoteItem &note)
             //because data aready in the database.
             //folder->maxNoteIdRef()--
             //Should never reach here
+        } else if (VNoteSearchIndex::isIndexedNote(newNote)) {
+            VNoteSearchIndex::instance()->updateNote(newNote->noteId, newNote->noteTitle, note.searchText());
         }
     } else {
         qCritical() << "New Note:" << newNote->noteId
@@ -180,6 +296,72 @@ VNoteItem *VNoteItemOper::addNote(VNoteItem &note)
     return newNote;
 }
 
+/**
+ * @brief VNoteItemOper::loadNoteBody
+ * 启动时只加载了摘要，编辑、搜索、导出等需要正文时调用
+ * @return true 正文可用
+ */
+bool VNoteItemOper::loadNoteBody()
+{
+    if (nullptr == m_note) {
+        return false;
+    }
+
+    if (m_note->bodyLoaded) {
+        VNoteDataManager::instance()->touchNoteBody(m_note, true);
+        return true;
+    }
+
+    //正文可能已被缓存释放，未写入数据库的快照比数据库中的新
+    QVariant metaData;
+
+    if (VNoteSaveQueue::instance()->pendingMetaData(m_note->noteId, metaData)) {
+        MetaDataParser metaParser;
+        m_note->setMetadata(metaData);
+        metaParser.parse(metaData, m_note);
+        m_note->bodyLoaded = true;
+
+        VNoteDataManager::instance()->touchNoteBody(m_note, false);
+
+        return true;
+    }
+
+    NoteBodyQryDbVisitor noteBodyVisitor(VNoteDbManager::instance()->getVNoteDb(), m_note, m_note);
+
+    if (Q_UNLIKELY(!VNoteDbManager::instance()->queryData(&noteBodyVisitor))) {
+        qCritical() << "Load note body failed, noteId:" << m_note->noteId;
+        return false;
+    }
+
+    VNoteDataManager::instance()->touchNoteBody(m_note, false);
+
+    return true;
+}
+
+/**
+ * @brief VNoteItemOper::searchNotes
+ * 加密笔记不在索引中，需要调用方自行匹配
+ * @param keyword 关键字
+ * @param noteIds 匹配的笔记id
+ * @return true 搜索成功
+ */
+bool VNoteItemOper::searchNotes(const QString &keyword, QSet<qint32> &noteIds)
+{
+    if (keyword.isEmpty() || !VNoteDbManager::instance()->hasFullTextIndex()) {
+        return false;
+    }
+
+    SearchNoteDbVisitor searchVisitor(VNoteDbManager::instance()->getVNoteDb(), &keyword, &noteIds);
+
+    if (Q_UNLIKELY(!VNoteDbManager::instance()->queryData(&searchVisitor))) {
+        qCritical() << "Search notes failed, keyword length:" << keyword.length();
+        noteIds.clear();
+        return false;
+    }
+
+    return true;
+}
+
 /**
  * @brief VNoteItemOper::getNote
  * @param folderId
@@ -191,6 +373,16 @@ VNoteItem *VNoteItemOper::getNote(qint64 folderId, qint32 noteId)
     return VNoteDataManager::instance()->getNote(folderId, noteId);
 }
 
+/**
+ * @brief VNoteItemOper::getNote
+ * @param noteId
+ * @return 记事项数据
+ */
+VNoteItem *VNoteItemOper::getNote(qint32 noteId)
+{
+    return VNoteDataManager::instance()->getNote(noteId);
+}
+
 /**
  * @brief VNoteItemOper::getFolderNotes
  * @param folderId
@@ -243,6 +435,9 @@ bool VNoteItemOper::deleteNote()
     bool delOK = false;
 
     if (nullptr != m_note) {
+        //快照按note_id写入，笔记删除后不会生效，直接丢弃
+        VNoteSaveQueue::instance()->discard(m_note->noteId);
+
         VNoteFolder *folder = m_note->folder();
 
         if (nullptr == folder) {
@@ -262,8 +457,9 @@ bool VNoteItemOper::deleteNote()
         DelNoteDbVisitor delNoteVisitor(VNoteDbManager::instance()->getVNoteDb(), m_note, nullptr);
 
         if (Q_LIKELY(VNoteDbManager::instance()->deleteData(&delNoteVisitor))) {
-            //Release note Object
-            QScopedPointer<VNoteItem> autoRelease(VNoteDataManager::instance()->delNote(m_note->folderId, m_note->noteId));
+            //Release note Object, deferred while snapshots still reference it
+            VNoteDataManager *dataManager = VNoteDataManager::instance();
+            dataManager->releaseNote(dataManager->delNote(m_note->folderId, m_note->noteId));
 
             delOK = true;
         } else {
@@ -277,6 +473,70 @@ bool VNoteItemOper::deleteNote()
     return delOK;
 }
 
+/**
+ * @brief VNoteItemOper::deleteNotes
+ * @param notes 需要删除的记事项
+ * @return true 成功
+ */
+bool VNoteItemOper::deleteNotes(const QList<VNoteItem *> &notes)
+{
+    if (notes.isEmpty()) {
+        return false;
+    }
+
+    for (auto note : notes) {
+        VNoteSaveQueue::instance()->discard(note->noteId);
+    }
+
+    VNoteDbManager *dbManager = VNoteDbManager::instance();
+    //记录记事本剩余笔记数及原maxid，用于重置和回滚
+    QHash<VNoteFolder *, int> folderNoteCounts;
+    QHash<VNoteFolder *, qint32> folderMaxIds;
+
+    for (auto note : notes) {
+        VNoteFolder *folder = note->folder();
+
+        if (nullptr == folder) {
+            VNoteFolderOper folderOps;
+            folder = folderOps.getFolder(note->folderId);
+            note->setFolder(folder);
+        }
+
+        Q_ASSERT(nullptr != folder);
+
+        if (!folderNoteCounts.contains(folder)) {
+            folderNoteCounts.insert(folder, folder->getNotesCount());
+            folderMaxIds.insert(folder, folder->maxNoteIdRef());
+        }
+
+        //Reset the max note id when folder empty.
+        if (Q_UNLIKELY(--folderNoteCounts[folder] == 0)) {
+            folder->maxNoteIdRef() = 0;
+        }
+    }
+
+    //一条IN(...)语句删除，每个记事本只更新一次
+    DelNotesDbVisitor delNotesVisitor(dbManager->getVNoteDb(), &notes, nullptr);
+
+    bool delOK = dbManager->deleteData(&delNotesVisitor);
+
+    if (Q_LIKELY(delOK)) {
+        //Release note Objects after commit
+        VNoteDataManager *dataManager = VNoteDataManager::instance();
+
+        for (auto note : notes) {
+            dataManager->releaseNote(dataManager->delNote(note->folderId, note->noteId));
+        }
+    } else {
+        //Update failed rollback.
+        for (auto it = folderMaxIds.begin(); it != folderMaxIds.end(); ++it) {
+            it.key()->maxNoteIdRef() = it.value();
+        }
+    }
+
+    return delOK;
+}
+
 /**
  * @brief VNoteItemOper::updateTop
  * @param value　0取消置顶，１置顶
@@ -293,6 +553,7 @@ bool VNoteItemOper::updateTop(int value)
         UpdateNoteTopDbVisitor updateNoteVisitor(VNoteDbManager::instance()->getVNoteDb(), m_note, nullptr);
         if (!Q_UNLIKELY(!VNoteDbManager::instance()->updateData(&updateNoteVisitor))) {
             updateOK = true;
+            VNoteDataManager::instance()->notifyNotePinned(m_note);
         } else {
             m_note->isTop = !value;
         }
@@ -316,3 +577,92 @@ bool VNoteItemOper::updateFolderId(VNoteItem *data)
     }
     return updateOK;
 }
+
+/**
+ * @brief VNoteItemOper::updateFolderId
+ * @param notes 需要更新的笔记
+ * @return true成功，false失败
+ */
+bool VNoteItemOper::updateFolderId(const QList<VNoteItem *> &notes)
+{
+    if (notes.isEmpty()) {
+        return false;
+    }
+
+    UpdateNotesFolderIdDbVisitor updateNotesVisitor(VNoteDbManager::instance()->getVNoteDb(), &notes, nullptr);
+
+    return VNoteDbManager::instance()->updateData(&updateNotesVisitor);
+}
+
+/**
+ * @brief VNoteItemOper::moveNotes
+ * @param notes 需要移动的笔记
+ * @param destFolderId 目标记事本id
+ * @return true成功，false失败
+ */
+bool VNoteItemOper::moveNotes(const QList<VNoteItem *> &notes, qint64 destFolderId)
+{
+    if (notes.isEmpty()) {
+        return false;
+    }
+
+    //数据库中的记事本id取自各记事项，写入后恢复原值，内存数据由数据管理统一移动
+    QVector<qint64> oldFolderIds;
+    oldFolderIds.reserve(notes.size());
+
+    for (auto note : notes) {
+        oldFolderIds.append(note->folderId);
+        note->folderId = destFolderId;
+    }
+
+    bool updateOK = updateFolderId(notes);
+
+    for (int i = 0; i < notes.size(); i++) {
+        notes[i]->folderId = oldFolderIds[i];
+    }
+
+    if (Q_UNLIKELY(!updateOK)) {
+        qCritical() << "Move notes to folder failed:" << destFolderId;
+        return false;
+    }
+
+    return VNoteDataManager::instance()->moveNotes(notes, destFolderId);
+}
+
+/**
+ * @brief VNoteItemOper::updateTop
+ * @param notes 需要更新的笔记
+ * @param value 置顶值
+ * @return true成功，false失败
+ */
+bool VNoteItemOper::updateTop(const QList<VNoteItem *> &notes, int value)
+{
+    QList<VNoteItem *> changedNotes;
+
+    for (auto note : notes) {
+        if (note->isTop != value) {
+            note->isTop = value;
+            changedNotes.append(note);
+        }
+    }
+
+    if (changedNotes.isEmpty()) {
+        return false;
+    }
+
+    UpdateNotesTopDbVisitor updateNotesVisitor(VNoteDbManager::instance()->getVNoteDb(), &changedNotes, nullptr);
+
+    if (Q_UNLIKELY(!VNoteDbManager::instance()->updateData(&updateNotesVisitor))) {
+        //Update failed rollback.
+        for (auto note : changedNotes) {
+            note->isTop = !value;
+        }
+        return false;
+    }
+
+    for (auto note : changedNotes) {
+        VNoteDataManager::instance()->notifyNotePinned(note);
+    }
+
+    return true;
+}
@@ -8,6 +8,8 @@
 
 #include "common/datatypedef.h"
 
+#include <QSet>
+
 //记事项表操作
 class VNoteItemOper
 {
@@ -15,14 +17,24 @@ public:
     explicit VNoteItemOper(VNoteItem *note = nullptr);
     //获取所有记事项数据
     VNOTE_ALL_NOTES_MAP *loadAllVNotes();
+    //获取指定范围的记事项数据，用于分批加载
+    VNOTE_ALL_NOTES_MAP *loadVNotes(const VNOTE_NOTES_RANGE &range);
     //修改名称
     bool modifyNoteTitle(const QString &title);
     //更新数据
     bool updateNote();
+    //生成元数据后放入异步保存队列，不等待数据库写入
+    bool updateNoteAsync();
     //添加记事项
     VNoteItem *addNote(VNoteItem &note);
+    //加载记事项正文，已加载时直接返回
+    bool loadNoteBody();
+    //通过全文索引搜索记事项，索引不可用时返回false
+    bool searchNotes(const QString &keyword, QSet<qint32> &noteIds);
     //获取记事项
     VNoteItem *getNote(qint64 folderId, qint32 noteId);
+    //通过note_id获取记事项
+    VNoteItem *getNote(qint32 noteId);
     //获取一个记事本所有记事项
     VNOTE_ITEMS_MAP *getFolderNotes(qint64 folderId);
     //生成默认名称
@@ -31,10 +43,18 @@ public:
     QString getDefaultVoiceName() const;
     //删除记事项
     bool deleteNote();
+    //批量删除记事项，一次事务提交
+    bool deleteNotes(const QList<VNoteItem *> &notes);
     //更新置顶属性
     bool updateTop(int value);
+    //批量更新置顶属性，一条语句提交
+    bool updateTop(const QList<VNoteItem *> &notes, int value);
     //更新folderid
     bool updateFolderId(VNoteItem *data);
+    //批量更新folderid，一次事务提交
+    bool updateFolderId(const QList<VNoteItem *> &notes);
+    //移动记事项，数据库更新成功后才更新内存数据
+    bool moveNotes(const QList<VNoteItem *> &notes, qint64 destFolderId);
 
 protected:
     VNoteItem *m_note {nullptr};
@@ -0,0 +1,324 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "vnotesavequeue.h"
+#include "db/dbvisitor.h"
+#include "db/vnotedbmanager.h"
+#include "common/vntaskworker.h"
+#include "common/vnoteitem.h"
+#include "task/savenoteworker.h"
+
+#include <DLog>
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+
+VNoteSaveQueue *VNoteSaveQueue::_instance = nullptr;
+
+/**
+ * @brief VNoteSaveQueue::VNoteSaveQueue
+ * @param parent
+ */
+VNoteSaveQueue::VNoteSaveQueue(QObject *parent)
+    : QObject(parent)
+    , m_coalesceTimer(new QTimer(this))
+{
+    m_coalesceTimer->setSingleShot(true);
+    connect(m_coalesceTimer, &QTimer::timeout, this, &VNoteSaveQueue::commitSoon);
+
+    //定时器在界面线程运行，单例可能由后台线程首次获取
+    if (nullptr != QCoreApplication::instance() && nullptr == parent) {
+        moveToThread(QCoreApplication::instance()->thread());
+    }
+}
+
+/**
+ * @brief VNoteSaveQueue::~VNoteSaveQueue
+ */
+VNoteSaveQueue::~VNoteSaveQueue()
+{
+    quit();
+}
+
+/**
+ * @brief VNoteSaveQueue::instance
+ * @return 单例对象
+ */
+VNoteSaveQueue *VNoteSaveQueue::instance()
+{
+    if (nullptr == _instance) {
+        _instance = new VNoteSaveQueue();
+    }
+
+    return _instance;
+}
+
+/**
+ * @brief VNoteSaveQueue::enqueue
+ * 只复制保存需要的字段，调用方可以继续修改原笔记。
+ * 连续编辑时每次保存重新开始合并等待，距第一次未提交的保存超过最长间隔时立即提交
+ * @param note 笔记数据
+ */
+void VNoteSaveQueue::enqueue(const VNoteItem *note)
+{
+    if (nullptr == note) {
+        return;
+    }
+
+    VNoteItem *snapshot = new VNoteItem();
+    snapshot->noteId = note->noteId;
+    snapshot->folderId = note->folderId;
+    snapshot->noteTitle = note->noteTitle;
+    snapshot->encryption = note->encryption;
+    snapshot->htmlCode = note->htmlCode;
+    snapshot->copyPlainText(*note);
+    snapshot->modifyTime = note->modifyTime;
+    snapshot->contentHash = note->contentHash;
+    snapshot->setMetadata(note->metaDataConstRef());
+
+    m_pendingLock.lock();
+
+    //未提交的旧快照直接被新快照替换
+    VNoteItem *oldSnapshot = m_pendingNotes.value(snapshot->noteId, nullptr);
+    m_pendingNotes.insert(snapshot->noteId, snapshot);
+
+    if (!m_pendingTimer.isValid()) {
+        m_pendingTimer.start();
+    }
+
+    int delayMs = SAVE_MAX_LATENCY_MS - static_cast<int>(m_pendingTimer.elapsed());
+    if (delayMs > SAVE_COALESCE_DELAY_MS) {
+        delayMs = SAVE_COALESCE_DELAY_MS;
+    }
+
+    m_pendingLock.unlock();
+
+    delete oldSnapshot;
+
+    if (delayMs <= 0) {
+        commitSoon();
+    } else {
+        //调用方不在界面线程时排队启动定时器
+        QMetaObject::invokeMethod(m_coalesceTimer, "start", Q_ARG(int, delayMs));
+    }
+}
+
+/**
+ * @brief VNoteSaveQueue::commitSoon
+ * 合并等待结束或切换笔记时调用，已安排提交时不重复安排
+ */
+void VNoteSaveQueue::commitSoon()
+{
+    bool needSchedule = false;
+
+    m_pendingLock.lock();
+
+    if (!m_pendingNotes.isEmpty() && !m_commitScheduled) {
+        m_commitScheduled = true;
+        needSchedule = true;
+    }
+
+    m_pendingLock.unlock();
+
+    if (needSchedule) {
+        scheduleCommit();
+    }
+}
+
+/**
+ * @brief VNoteSaveQueue::scheduleCommit
+ * @param delayMs 提交前等待的毫秒数
+ */
+void VNoteSaveQueue::scheduleCommit(int delayMs)
+{
+    if (nullptr == m_saveWorker) {
+        m_saveWorker = new VNTaskWorker();
+        m_saveWorker->setWorkerName("SaveNoteWorker");
+        m_saveWorker->start();
+    }
+
+    m_saveWorker->addTask(new SaveNoteWorker(delayMs));
+}
+
+/**
+ * @brief VNoteSaveQueue::discard
+ * 调用方随后同步写入或删除该笔记，旧快照不能再覆盖数据库。
+ * 正在提交的快照只做标记，提交线程持有数据库锁后检查，调用方不用等待
+ * @param noteId 笔记id
+ * @return true 有未提交或正在提交的快照
+ */
+bool VNoteSaveQueue::discard(qint32 noteId)
+{
+    m_pendingLock.lock();
+
+    VNoteItem *oldSnapshot = m_pendingNotes.take(noteId);
+    bool hasSnapshot = (nullptr != oldSnapshot);
+
+    if (m_committingNotes.contains(noteId)) {
+        m_supersededNotes.insert(noteId);
+        hasSnapshot = true;
+    }
+
+    m_pendingLock.unlock();
+
+    delete oldSnapshot;
+
+    return hasSnapshot;
+}
+
+/**
+ * @brief VNoteSaveQueue::pendingMetaData
+ * 正文被缓存释放后重新加载时使用，快照比数据库中的数据新
+ * @param noteId 笔记id
+ * @param metaData 快照中的元数据
+ * @return true 有未写入数据库的快照
+ */
+bool VNoteSaveQueue::pendingMetaData(qint32 noteId, QVariant &metaData)
+{
+    QMutexLocker locker(&m_pendingLock);
+
+    VNoteItem *snapshot = m_pendingNotes.value(noteId, nullptr);
+
+    //正在提交的快照提交成功后才移除，找不到时数据库已是最新
+    if (nullptr == snapshot && !m_supersededNotes.contains(noteId)) {
+        snapshot = m_committingNotes.value(noteId, nullptr);
+    }
+
+    if (nullptr == snapshot) {
+        return false;
+    }
+
+    metaData = snapshot->metaDataConstRef();
+
+    return true;
+}
+
+/**
+ * @brief VNoteSaveQueue::flush
+ * 退出时调用，保证数据库与内存一致
+ * @return true 成功
+ */
+bool VNoteSaveQueue::flush()
+{
+    return commitPending();
+}
+
+/**
+ * @brief VNoteSaveQueue::quit
+ */
+void VNoteSaveQueue::quit()
+{
+    if (QThread::currentThread() == thread()) {
+        m_coalesceTimer->stop();
+    }
+
+    flush();
+
+    if (nullptr != m_saveWorker) {
+        m_saveWorker->quitWorker();
+        m_saveWorker->wait();
+
+        delete m_saveWorker;
+        m_saveWorker = nullptr;
+    }
+}
+
+/**
+ * @brief VNoteSaveQueue::pendingCount
+ * @return 待保存的笔记数
+ */
+int VNoteSaveQueue::pendingCount()
+{
+    QMutexLocker locker(&m_pendingLock);
+    return m_pendingNotes.size();
+}
+
+/**
+ * @brief VNoteSaveQueue::commitPending
+ * @return true 成功
+ */
+bool VNoteSaveQueue::commitPending()
+{
+    //取快照和提交在同一把锁内，后取到的快照一定后提交
+    QMutexLocker commitLocker(&m_commitLock);
+
+    m_pendingLock.lock();
+    m_committingNotes.swap(m_pendingNotes);
+    m_commitScheduled = false;
+    m_pendingTimer.invalidate();
+    m_pendingLock.unlock();
+
+    if (m_committingNotes.isEmpty()) {
+        return true;
+    }
+
+    VNoteDbManager *dbManager = VNoteDbManager::instance();
+
+    //开始事务失败时不逐条写入，避免部分笔记在自动提交模式下保存
+    bool isOK = dbManager->beginTransaction();
+
+    if (isOK) {
+        for (auto note : m_committingNotes) {
+            //持有数据库锁后检查，同步保存在获取数据库锁前标记，旧快照不会覆盖新数据
+            m_pendingLock.lock();
+            bool isSuperseded = m_supersededNotes.contains(note->noteId);
+            m_pendingLock.unlock();
+
+            if (isSuperseded) {
+                continue;
+            }
+
+            UpdateNoteDbVisitor updateNoteVisitor(dbManager->getVNoteDb(), note, nullptr);
+
+            if (Q_UNLIKELY(!dbManager->updateData(&updateNoteVisitor))) {
+                isOK = false;
+                break;
+            }
+        }
+
+        if (isOK) {
+            isOK = dbManager->commitTransaction();
+        } else {
+            dbManager->rollbackTransaction();
+        }
+    }
+
+    QMap<qint32, VNoteItem *> commitNotes;
+    bool needSchedule = false;
+
+    m_pendingLock.lock();
+
+    commitNotes.swap(m_committingNotes);
+
+    if (Q_UNLIKELY(!isOK)) {
+        qCritical() << "Save notes failed, count:" << commitNotes.size();
+
+        //放回队列等待重试，已有更新快照或已被取代的丢弃旧数据
+        for (auto it = commitNotes.begin(); it != commitNotes.end(); ++it) {
+            if (!m_pendingNotes.contains(it.key()) && !m_supersededNotes.contains(it.key())) {
+                m_pendingNotes.insert(it.key(), it.value());
+                it.value() = nullptr;
+            }
+        }
+
+        if (!m_pendingNotes.isEmpty() && !m_commitScheduled) {
+            m_commitScheduled = true;
+            needSchedule = true;
+        }
+    }
+
+    m_supersededNotes.clear();
+
+    m_pendingLock.unlock();
+
+    qDeleteAll(commitNotes);
+
+    //数据库暂时不可用时延迟重试，不依赖下一次编辑触发
+    if (needSchedule) {
+        scheduleCommit(SAVE_RETRY_DELAY_MS);
+    }
+
+    return isOK;
+}
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef VNOTESAVEQUEUE_H
+#define VNOTESAVEQUEUE_H
+
+#include "common/datatypedef.h"
+
+#include <QObject>
+#include <QMap>
+#include <QSet>
+#include <QMutex>
+#include <QElapsedTimer>
+
+class VNTaskWorker;
+class QTimer;
+
+//记事项异步保存队列，同一笔记的多次保存合并，停止编辑一段时间后批量提交
+class VNoteSaveQueue : public QObject
+{
+    Q_OBJECT
+public:
+    static VNoteSaveQueue *instance();
+    //添加笔记快照，元数据需已生成，合并等待结束后提交
+    void enqueue(const VNoteItem *note);
+    //不再等待合并，立即在保存线程提交，切换笔记时调用，不等待写入完成
+    void commitSoon();
+    //提交所有待保存数据，返回时数据已写入数据库，会等待正在进行的提交，只在退出时使用
+    bool flush();
+    //丢弃笔记未提交的快照，同步保存或删除笔记前调用，不等待正在进行的提交，有快照时返回true
+    bool discard(qint32 noteId);
+    //获取笔记尚未写入数据库的最新元数据
+    bool pendingMetaData(qint32 noteId, QVariant &metaData);
+    //提交剩余数据并结束保存线程
+    void quit();
+    //待保存的笔记数
+    int pendingCount();
+
+protected:
+    explicit VNoteSaveQueue(QObject *parent = nullptr);
+    ~VNoteSaveQueue() override;
+    //在一个事务中提交当前所有快照
+    bool commitPending();
+    //在保存线程中安排一次提交，delayMs毫秒后执行
+    void scheduleCommit(int delayMs = 0);
+
+protected:
+    //按note_id保存最新快照，保证同一笔记的提交顺序
+    QMap<qint32, VNoteItem *> m_pendingNotes;
+    //正在提交的快照，提交完成前读取正文使用
+    QMap<qint32, VNoteItem *> m_committingNotes;
+    //提交期间被同步保存或删除取代的笔记，不再写入
+    QSet<qint32> m_supersededNotes;
+    //保护以上数据和m_commitScheduled
+    QMutex m_pendingLock;
+    //串行化提交，防止旧快照覆盖新快照
+    QMutex m_commitLock;
+    bool m_commitScheduled {false};
+    //第一个未提交快照加入后的时间，限制合并等待的总时长
+    QElapsedTimer m_pendingTimer;
+    //每次加入快照后重新计时，超时后提交
+    QTimer *m_coalesceTimer {nullptr};
+    //停止编辑后等待合并的时间
+    static constexpr int SAVE_COALESCE_DELAY_MS = 300;
+    //持续编辑时最长的提交间隔
+    static constexpr int SAVE_MAX_LATENCY_MS = 2000;
+    //提交失败后重试的间隔
+    static constexpr int SAVE_RETRY_DELAY_MS = 1000;
+    VNTaskWorker *m_saveWorker {nullptr};
+
+    static VNoteSaveQueue *_instance;
+
+    friend class SaveNoteWorker;
+};
+
+#endif // VNOTESAVEQUEUE_H
@@ -48,8 +48,15 @@
 #define VNOTE_FOLDER_SORT "base.folder_sort.folder_sort_data"
 #define VNOTE_NOTEPAD_LIST_SHOW "base.notepadlist.show"
 #define VNOTE_NOTEPAD_ENCRYPTION_KEY "base.encryption.key"
+#define VNOTE_DB_BACKUP_KEEP_COUNT "base.backup.keep_count"
+#define VNOTE_DB_BACKUP_INTERVAL "base.backup.interval_hours"
+#define VNOTE_DB_SLOW_QUERY_MS "base.dbstats.slow_query_ms"
+#define VNOTE_BODY_CACHE_BUDGET_MB "base.bodycache.budget_mb"
 //********************************************
 
+//Command line option, dump database query stats of the running instance to log
+#define VNOTE_DUMP_DB_STATS_OPTION "--dump-db-stats"
+
 //Time format
 #define VNOTE_TIME_FMT "yyyy-MM-dd HH:mm:ss.zzz"
 
@@ -15,6 +15,8 @@
 
 #include <DLog>
 
+#include <algorithm>
+
 const QString UpgradeDbUtil::UPGRADE_STATE = "old.UpgradeDb/importOldDbState";
 
 /**
@@ -94,6 +96,10 @@ void UpgradeDbUtil::checkUpdateState(int state)
                 qInfo() << "Remove exception db error:" << dbFile.errorString();
             }
         }
+
+        //WAL模式的日志文件需要一起删除，避免被回放到新数据库
+        QFile::remove(vnoteDatabasePath + "-wal");
+        QFile::remove(vnoteDatabasePath + "-shm");
     }
 }
 
@@ -185,7 +191,13 @@ void UpgradeDbUtil::doFolderNoteUpgrade(qint64 newFolderId, qint64 oldFolderId)
         if (folderNotes != allNotes->notes.end()) {
             VNoteItemOper noteOper;
 
-            for (auto note : folderNotes.value()->folderNotes) {
+            //按note_id顺序导入，默认名称编号与插入顺序和旧版本一致
+            QList<VNoteItem *> notes = folderNotes.value()->folderNotes.values();
+            std::sort(notes.begin(), notes.end(), [](const VNoteItem *left, const VNoteItem *right) {
+                return left->noteId < right->noteId;
+            });
+
+            for (auto note : notes) {
                 //Change the old folder id to new folder id
                 note->folderId = newFolderId;
                 note->noteTitle = noteOper.getDefaultNoteName(newFolderId);
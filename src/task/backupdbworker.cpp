@@ -0,0 +1,217 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "backupdbworker.h"
+
+#include <DLog>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QThread>
+
+#include <sqlite3.h>
+
+QAtomicInt BackupDbWorker::s_stopRequested {0};
+QAtomicInt BackupDbWorker::s_running {0};
+
+/**
+ * @brief BackupDbWorker::BackupDbWorker
+ * @param dbPath 数据库文件路径
+ * @param keepCount 保留的备份数量
+ * @param parent
+ */
+BackupDbWorker::BackupDbWorker(const QString &dbPath, int keepCount, QObject *parent)
+    : VNTask(parent)
+    , m_dbPath(dbPath)
+    , m_keepCount(keepCount)
+{
+}
+
+/**
+ * @brief BackupDbWorker::backupDirPath
+ * @param dbPath 数据库文件路径
+ * @return 备份目录
+ */
+QString BackupDbWorker::backupDirPath(const QString &dbPath)
+{
+    return QFileInfo(dbPath).absolutePath() + QDir::separator() + ".backup";
+}
+
+/**
+ * @brief BackupDbWorker::backupFiles
+ * 备份文件名带时间戳，按文件名倒序即为从新到旧
+ * @param dbPath 数据库文件路径
+ * @return 备份文件路径
+ */
+QStringList BackupDbWorker::backupFiles(const QString &dbPath)
+{
+    QDir backupDir(backupDirPath(dbPath));
+    QStringList filters = {QFileInfo(dbPath).completeBaseName() + "-*.db"};
+
+    QStringList files;
+
+    for (auto fileName : backupDir.entryList(filters, QDir::Files, QDir::Name | QDir::Reversed)) {
+        files.append(backupDir.filePath(fileName));
+    }
+
+    return files;
+}
+
+/**
+ * @brief BackupDbWorker::isBackupDue
+ * @param dbPath 数据库文件路径
+ * @param intervalHours 备份间隔(小时)
+ * @return true 需要备份
+ */
+bool BackupDbWorker::isBackupDue(const QString &dbPath, int intervalHours)
+{
+    if (!QFileInfo::exists(dbPath)) {
+        return false;
+    }
+
+    QStringList files = backupFiles(dbPath);
+
+    if (files.isEmpty()) {
+        return true;
+    }
+
+    QDateTime lastBackup = QFileInfo(files.first()).lastModified();
+
+    return lastBackup.secsTo(QDateTime::currentDateTime()) >= intervalHours * 3600;
+}
+
+/**
+ * @brief BackupDbWorker::requestStop
+ */
+void BackupDbWorker::requestStop()
+{
+    s_stopRequested.storeRelease(1);
+}
+
+/**
+ * @brief BackupDbWorker::run
+ * 先备份到临时文件，完成后再改名，中断的备份不会被当作有效备份
+ */
+void BackupDbWorker::run()
+{
+    if (m_keepCount <= 0 || !s_running.testAndSetAcquire(0, 1)) {
+        return;
+    }
+
+    QDir backupDir(backupDirPath(m_dbPath));
+
+    if (!backupDir.exists() && !backupDir.mkpath(backupDir.path())) {
+        qCritical() << "Create backup directory failed:" << backupDir.path();
+        s_running.storeRelease(0);
+        emit backupFinished(false, QString());
+        return;
+    }
+
+    QString backupPath = backupDir.filePath(QFileInfo(m_dbPath).completeBaseName()
+                                            + QDateTime::currentDateTime().toString("-yyyyMMddHHmmss")
+                                            + ".db");
+    QString tmpPath = backupPath + ".tmp";
+
+    QFile::remove(tmpPath);
+
+    bool backupOK = backupTo(tmpPath);
+
+    if (backupOK) {
+        QFile::remove(backupPath);
+        backupOK = QFile::rename(tmpPath, backupPath);
+    }
+
+    if (backupOK) {
+        qInfo() << "Database backup finished:" << backupPath;
+        removeExpiredBackups();
+    } else {
+        QFile::remove(tmpPath);
+        qCritical() << "Database backup failed:" << m_dbPath;
+    }
+
+    s_running.storeRelease(0);
+
+    emit backupFinished(backupOK, backupOK ? backupPath : QString());
+}
+
+/**
+ * @brief BackupDbWorker::backupTo
+ * 备份使用独立的只读连接，并在整个过程中保持一个读事务：
+ * WAL模式下其他连接的写入不影响该快照，备份不会因写入而重新开始，也不阻塞写入
+ * @param tmpPath 备份文件路径
+ * @return true 成功
+ */
+bool BackupDbWorker::backupTo(const QString &tmpPath)
+{
+    sqlite3 *srcDb = nullptr;
+    sqlite3 *destDb = nullptr;
+    bool backupOK = false;
+
+    int rc = sqlite3_open_v2(m_dbPath.toUtf8().constData(), &srcDb, SQLITE_OPEN_READONLY, nullptr);
+
+    if (SQLITE_OK == rc) {
+        rc = sqlite3_open_v2(tmpPath.toUtf8().constData(), &destDb,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+    }
+
+    if (SQLITE_OK == rc) {
+        sqlite3_busy_timeout(srcDb, BUSY_RETRY_MS);
+        //开始读事务，固定备份使用的快照
+        rc = sqlite3_exec(srcDb, "BEGIN; SELECT count(*) FROM sqlite_master;", nullptr, nullptr, nullptr);
+    }
+
+    if (SQLITE_OK != rc) {
+        qCritical() << "Open database for backup failed:"
+                    << sqlite3_errmsg(nullptr != destDb ? destDb : srcDb);
+    } else {
+        sqlite3_backup *backup = sqlite3_backup_init(destDb, "main", srcDb, "main");
+
+        if (nullptr == backup) {
+            qCritical() << "Init backup failed:" << sqlite3_errmsg(destDb);
+        } else {
+            do {
+                rc = sqlite3_backup_step(backup, PAGES_PER_STEP);
+
+                if (SQLITE_OK == rc) {
+                    QThread::msleep(STEP_INTERVAL_MS);
+                } else if (SQLITE_BUSY == rc || SQLITE_LOCKED == rc) {
+                    QThread::msleep(BUSY_RETRY_MS);
+                }
+            } while ((SQLITE_OK == rc || SQLITE_BUSY == rc || SQLITE_LOCKED == rc)
+                     && 0 == s_stopRequested.loadAcquire());
+
+            backupOK = (SQLITE_DONE == rc);
+
+            if (!backupOK) {
+                qCritical() << "Backup step failed, rc:" << rc
+                            << " stop requested:" << s_stopRequested.loadAcquire();
+            }
+
+            sqlite3_backup_finish(backup);
+        }
+
+        sqlite3_exec(srcDb, "COMMIT;", nullptr, nullptr, nullptr);
+    }
+
+    sqlite3_close(destDb);
+    sqlite3_close(srcDb);
+
+    return backupOK;
+}
+
+/**
+ * @brief BackupDbWorker::removeExpiredBackups
+ */
+void BackupDbWorker::removeExpiredBackups()
+{
+    QStringList files = backupFiles(m_dbPath);
+
+    for (int i = m_keepCount; i < files.size(); i++) {
+        if (!QFile::remove(files.at(i))) {
+            qCritical() << "Remove expired backup failed:" << files.at(i);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BACKUPDBWORKER_H
+#define BACKUPDBWORKER_H
+
+#include "vntask.h"
+
+#include <QStringList>
+#include <QAtomicInt>
+
+/**
+ * @brief The BackupDbWorker class
+ * 使用sqlite在线备份接口备份数据库，每步只复制少量页，不占用数据库写锁
+ */
+class BackupDbWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    explicit BackupDbWorker(const QString &dbPath, int keepCount, QObject *parent = nullptr);
+    //备份目录，与数据库同目录下的.backup
+    static QString backupDirPath(const QString &dbPath);
+    //数据库的所有备份文件，按时间从新到旧排列
+    static QStringList backupFiles(const QString &dbPath);
+    //距上次备份是否已超过间隔时间
+    static bool isBackupDue(const QString &dbPath, int intervalHours);
+    //请求正在进行的备份尽快结束，退出程序时调用
+    static void requestStop();
+
+    //每步复制的页数
+    static constexpr int PAGES_PER_STEP = 256;
+    //每步之间的间隔(毫秒)，让出磁盘IO
+    static constexpr int STEP_INTERVAL_MS = 10;
+    //数据库忙时的重试间隔(毫秒)
+    static constexpr int BUSY_RETRY_MS = 100;
+
+signals:
+    //备份结束，成功时带备份文件路径
+    void backupFinished(bool success, const QString &backupPath);
+
+protected:
+    virtual void run() override;
+
+private:
+    //执行备份，生成临时文件
+    bool backupTo(const QString &tmpPath);
+    //删除超出保留数量的旧备份
+    void removeExpiredBackups();
+
+private:
+    QString m_dbPath;
+    int m_keepCount {0};
+
+    static QAtomicInt s_stopRequested;
+    //同一时间只允许一个备份任务
+    static QAtomicInt s_running;
+};
+
+#endif // BACKUPDBWORKER_H
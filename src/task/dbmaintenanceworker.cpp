@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dbmaintenanceworker.h"
+#include "db/vnotedbmanager.h"
+#include "db/vnotesavequeue.h"
+
+#include <DLog>
+
+#include <QElapsedTimer>
+#include <QThread>
+
+QAtomicInt DbMaintenanceWorker::s_stopRequested {0};
+QAtomicInt DbMaintenanceWorker::s_running {0};
+
+/**
+ * @brief DbMaintenanceWorker::DbMaintenanceWorker
+ * @param integrityCheck 是否执行完整性检查
+ * @param parent
+ */
+DbMaintenanceWorker::DbMaintenanceWorker(bool integrityCheck, QObject *parent)
+    : VNTask(parent)
+    , m_integrityCheck(integrityCheck)
+{
+}
+
+/**
+ * @brief DbMaintenanceWorker::isMaintenanceDue
+ * 非增量模式的数据库无法回收空间，不触发维护
+ * @return true 需要维护
+ */
+bool DbMaintenanceWorker::isMaintenanceDue()
+{
+    VNoteDbManager *dbManager = VNoteDbManager::instance();
+    return dbManager->freeSpaceBytes() >= FREE_SPACE_THRESHOLD && dbManager->isIncrementalVacuum();
+}
+
+/**
+ * @brief DbMaintenanceWorker::requestStop
+ */
+void DbMaintenanceWorker::requestStop()
+{
+    s_stopRequested.storeRelease(1);
+}
+
+/**
+ * @brief DbMaintenanceWorker::run
+ */
+void DbMaintenanceWorker::run()
+{
+    if (!s_running.testAndSetAcquire(0, 1)) {
+        return;
+    }
+
+    VNoteDbManager *dbManager = VNoteDbManager::instance();
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    m_writeSerial = dbManager->writeSerial();
+
+    qint64 freeBytes = dbManager->freeSpaceBytes();
+    qint64 reclaimedBytes = 0;
+    bool interrupted = isInterrupted();
+
+    //老数据库转换增量模式需要重建整个文件，期间阻塞所有写操作，不在后台执行
+    if (!interrupted && freeBytes > 0 && dbManager->isIncrementalVacuum()) {
+        qint64 remainBytes = freeBytes;
+
+        while (remainBytes > 0 && !(interrupted = isInterrupted())) {
+            if (!dbManager->incrementalVacuum(VACUUM_PAGES_PER_STEP)) {
+                break;
+            }
+
+            qint64 newRemainBytes = dbManager->freeSpaceBytes();
+
+            //没有回收任何页时结束，防止空转
+            if (newRemainBytes < 0 || newRemainBytes >= remainBytes) {
+                break;
+            }
+
+            reclaimedBytes += remainBytes - newRemainBytes;
+            remainBytes = newRemainBytes;
+
+            QThread::msleep(STEP_INTERVAL_MS);
+        }
+    }
+
+    if (!interrupted && !(interrupted = isInterrupted())) {
+        dbManager->analyze();
+    }
+
+    if (m_integrityCheck && !interrupted && !(interrupted = isInterrupted())) {
+        dbManager->quickCheck();
+    }
+
+    qint64 elapsedMs = elapsedTimer.elapsed();
+
+    qInfo() << "Database maintenance finished, reclaimed bytes:" << reclaimedBytes
+            << " elapsed ms:" << elapsedMs << " interrupted:" << interrupted;
+
+    s_running.storeRelease(0);
+
+    emit maintenanceFinished(reclaimedBytes, elapsedMs, interrupted);
+}
+
+/**
+ * @brief DbMaintenanceWorker::isInterrupted
+ * 开始维护后有新的写事务或待保存的笔记，说明用户正在编辑
+ * @return true 需要停止
+ */
+bool DbMaintenanceWorker::isInterrupted() const
+{
+    return 0 != s_stopRequested.loadAcquire()
+           || m_writeSerial != VNoteDbManager::instance()->writeSerial()
+           || VNoteSaveQueue::instance()->pendingCount() > 0;
+}
@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DBMAINTENANCEWORKER_H
+#define DBMAINTENANCEWORKER_H
+
+#include "vntask.h"
+
+#include <QAtomicInt>
+
+/**
+ * @brief The DbMaintenanceWorker class
+ * 后台数据库维护：分步回收空闲页、更新统计信息、可选的完整性检查
+ * 每步之间检查是否有用户写操作，有则立即停止
+ */
+class DbMaintenanceWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    explicit DbMaintenanceWorker(bool integrityCheck = false, QObject *parent = nullptr);
+    //可回收空间是否超过阈值
+    static bool isMaintenanceDue();
+    //请求正在进行的维护尽快结束，退出程序时调用
+    static void requestStop();
+
+    //触发维护的可回收空间阈值(字节)
+    static constexpr qint64 FREE_SPACE_THRESHOLD = 4 * 1024 * 1024;
+    //每步回收的页数
+    static constexpr int VACUUM_PAGES_PER_STEP = 128;
+    //每步之间的间隔(毫秒)
+    static constexpr int STEP_INTERVAL_MS = 20;
+
+signals:
+    //维护结束，返回回收的字节数、耗时及是否被中断
+    void maintenanceFinished(qint64 reclaimedBytes, qint64 elapsedMs, bool interrupted);
+
+protected:
+    virtual void run() override;
+
+private:
+    //用户开始编辑或程序退出时返回true
+    bool isInterrupted() const;
+
+private:
+    bool m_integrityCheck {false};
+    int m_writeSerial {0};
+
+    static QAtomicInt s_stopRequested;
+    //同一时间只允许一个维护任务
+    static QAtomicInt s_running;
+};
+
+#endif // DBMAINTENANCEWORKER_H
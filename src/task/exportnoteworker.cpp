@@ -6,6 +6,7 @@
 #include "exportnoteworker.h"
 #include "globaldef.h"
 #include "common/vnoteitem.h"
+#include "common/vnotedatamanager.h"
 #include "common/metadataparser.h"
 #include "common/setting.h"
 #include "common/utils.h"
@@ -34,6 +35,20 @@ ExportNoteWorker::ExportNoteWorker(const QString &dirPath, ExportType exportType
     //笔记列表
     , m_noteList(noteList)
 {
+    //导出期间正文不被缓存释放
+    for (auto it : m_noteList) {
+        VNoteDataManager::instance()->pinNoteBody(it);
+    }
+}
+
+/**
+ * @brief ExportNoteWorker::~ExportNoteWorker
+ */
+ExportNoteWorker::~ExportNoteWorker()
+{
+    for (auto it : m_noteList) {
+        VNoteDataManager::instance()->unpinNoteBody(it);
+    }
 }
 
 /**
@@ -114,11 +129,9 @@ ExportNoteWorker::ExportError ExportNoteWorker::exportText()
             if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) {
                 return Savefailed; //保存失败
             }
-            //富文本数据需要转换为纯文本
+            //富文本数据需要转换为纯文本，保存过的笔记直接使用缓存
             if (!noteData->htmlCode.isEmpty()) {
-                QTextDocument doc;
-                doc.setHtml(noteData->htmlCode);
-                out.write(doc.toPlainText().toUtf8());
+                out.write(noteData->searchText().toUtf8());
             } else {
                 for (auto it : noteData->datas.datas) {
                     if (VNoteBlock::Text == it->getType()) {
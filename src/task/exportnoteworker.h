@@ -37,6 +37,7 @@ public:
                               const QList<VNoteItem *> &noteList,
                               const QString &defaultName = "",
                               QObject *parent = nullptr);
+    ~ExportNoteWorker() override;
 
 signals:
     //导出完成信号
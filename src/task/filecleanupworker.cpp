@@ -5,19 +5,21 @@
 
 #include "filecleanupworker.h"
 #include "common/vnoteitem.h"
+#include "common/vnotedatamanager.h"
+#include "db/vnoteitemoper.h"
 
 #include <QDir>
 #include <QStandardPaths>
 #include <QDebug>
 
-FileCleanupWorker::FileCleanupWorker(VNOTE_ALL_NOTES_MAP *qspAllNotesMap, QObject *parent)
+FileCleanupWorker::FileCleanupWorker(const VNOTE_NOTES_SNAPSHOT &snapshot, QObject *parent)
     : VNTask(parent)
-    , m_qspAllNotesMap(qspAllNotesMap)
+    , m_snapshot(snapshot)
 {
 }
 void FileCleanupWorker::run()
 {
-    if (nullptr == m_qspAllNotesMap) {
+    if (m_snapshot.isNull()) {
         return;
     }
 
@@ -105,24 +107,53 @@ void FileCleanupWorker::fillPictureSet()
 bool FileCleanupWorker::scanAllNotes()
 {
     //遍历笔记
-    QList<VNOTE_ITEMS_MAP *> voiceItems = m_qspAllNotesMap->notes.values();
-    for (VNOTE_ITEMS_MAP *voiceItem : voiceItems) {
-        QList<VNoteItem *> notes = voiceItem->folderNotes.values();
+    for (const QVector<VNoteItem *> &notes : m_snapshot->folderNotes) {
         for (VNoteItem *note : notes) {
-            if (note->htmlCode.isEmpty()) {
-                //5.9及以前版本的数据
-                scanVoiceByBlocks(note->datas);
-            } else {
-                //遍历笔记内所有语音
-                scanVoiceByHtml(note->htmlCode);
-                //遍历笔记内所有图片
-                scanPictureByHtml(note->htmlCode);
+            //扫描期间正文不被缓存释放
+            VNoteDataManager::instance()->pinNoteBody(note);
+            bool bodyLoaded = note->bodyLoaded;
+            if (bodyLoaded) {
+                scanNote(note);
             }
+            VNoteDataManager::instance()->unpinNoteBody(note);
+            if (bodyLoaded) {
+                continue;
+            }
+
+            //正文未加载的笔记从数据库读取到临时对象，扫描后释放
+            VNoteItem tmpNote;
+            tmpNote.noteId = note->noteId;
+            tmpNote.bodyLoaded = false;
+
+            //读取失败时无法确定文件是否被引用，放弃清理
+            if (!VNoteItemOper(&tmpNote).loadNoteBody()) {
+                return false;
+            }
+
+            scanNote(&tmpNote);
         }
     }
     return true;
 }
 
+/**
+ * @brief FileCleanupWorker::scanNote
+ * 遍历单个笔记引用的语音和图片
+ * @param note 笔记数据
+ */
+void FileCleanupWorker::scanNote(const VNoteItem *note)
+{
+    if (note->htmlCode.isEmpty()) {
+        //5.9及以前版本的数据
+        scanVoiceByBlocks(note->datas);
+    } else {
+        //遍历笔记内所有语音
+        scanVoiceByHtml(note->htmlCode);
+        //遍历笔记内所有图片
+        scanPictureByHtml(note->htmlCode);
+    }
+}
+
 /**
  * @brief FileCleanupWorker::removeVoicePathBySet
  * 移除语音集合中的指定路径
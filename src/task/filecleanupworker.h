@@ -19,7 +19,7 @@ class FileCleanupWorker : public VNTask
 {
     Q_OBJECT
 public:
-    explicit FileCleanupWorker(VNOTE_ALL_NOTES_MAP *qspAllNotesMap, QObject *parent = nullptr);
+    explicit FileCleanupWorker(const VNOTE_NOTES_SNAPSHOT &snapshot, QObject *parent = nullptr);
 
 signals:
 
@@ -39,6 +39,8 @@ private:
     void fillPictureSet();
     //遍历所有的笔记
     bool scanAllNotes();
+    //遍历单个笔记
+    void scanNote(const VNoteItem *note);
     //移除语音集合中的指定路径
     void removeVoicePathBySet(const QString &path);
     //移除图片集合中的指定路径
@@ -51,7 +53,7 @@ private:
     void scanVoiceByBlocks(const VNOTE_DATAS &datas);
 
 private:
-    VNOTE_ALL_NOTES_MAP *m_qspAllNotesMap {nullptr}; //所有笔记数据
+    VNOTE_NOTES_SNAPSHOT m_snapshot; //所有笔记数据的快照，扫描期间笔记不会被释放
     QSet<QString> m_pictureSet; //图片路径集合
     QSet<QString> m_voiceSet; //语音路径集合
 };
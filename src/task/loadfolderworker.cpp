@@ -6,6 +6,7 @@
 #include "loadfolderworker.h"
 #include "common/vnoteforlder.h"
 #include "db/vnotefolderoper.h"
+#include "db/vnotedbmanager.h"
 #include "globaldef.h"
 
 #include <DLog>
@@ -31,6 +32,11 @@ void LoadFolderWorker::run()
     gettimeofday(&start, nullptr);
     backups = start;
 
+    //已有数据库的表结构升级在读取数据前完成，不在界面线程执行
+    if (!VNoteDbManager::instance()->upgradeSchemaIfPending()) {
+        qCritical() << "Upgrade database schema failed, loading with the old schema";
+    }
+
     VNoteFolderOper folderOper;
     VNOTE_FOLDERS_MAP *foldersMap = folderOper.loadVNoteFolders();
 
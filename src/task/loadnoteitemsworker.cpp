@@ -11,17 +11,21 @@
 
 #include <QThread>
 
+constexpr int LoadNoteItemsWorker::NOTES_BATCH_SIZE;
+
 /**
  * @brief LoadNoteItemsWorker::LoadNoteItemsWorker
  * @param parent
  */
-LoadNoteItemsWorker::LoadNoteItemsWorker(QObject *parent)
+LoadNoteItemsWorker::LoadNoteItemsWorker(qint64 priorityFolderId, QObject *parent)
     : VNTask(parent)
+    , m_priorityFolderId(priorityFolderId)
 {
 }
 
 /**
  * @brief LoadNoteItemsWorker::run
+ * 首屏只依赖优先记事本的第一批数据，其余数据加载时界面已可用
  */
 void LoadNoteItemsWorker::run()
 {
@@ -31,16 +35,60 @@ void LoadNoteItemsWorker::run()
     backups = start;
 
     VNoteItemOper notesOper;
-    VNOTE_ALL_NOTES_MAP *notesMap = notesOper.loadAllVNotes();
+
+    if (m_priorityFolderId >= 0) {
+        VNOTE_NOTES_RANGE priorityRange;
+        priorityRange.folderId = m_priorityFolderId;
+
+        loadInBatches(notesOper, priorityRange);
+
+        gettimeofday(&end, nullptr);
+        qDebug() << "LoadNoteItemsWorker priority folder(ms):" << TM(start, end);
+    }
+
+    VNOTE_NOTES_RANGE range;
+    range.excludeFolderId = m_priorityFolderId;
+
+    loadInBatches(notesOper, range);
 
     gettimeofday(&end, nullptr);
 
     qDebug() << "LoadNoteItemsWorker(ms):" << TM(start, end);
 
-    //TODO:
-    //    Add load folder code here
+    emit onAllNotesLoaded();
+}
+
+/**
+ * @brief LoadNoteItemsWorker::loadInBatches
+ * 按note_id递增分页，每批最多NOTES_BATCH_SIZE条
+ * @param notesOper 记事项操作
+ * @param range 查询范围，忽略其中的分页参数
+ */
+void LoadNoteItemsWorker::loadInBatches(VNoteItemOper &notesOper, VNOTE_NOTES_RANGE range)
+{
+    range.afterNoteId = 0;
+    range.limit = NOTES_BATCH_SIZE;
+
+    int batchCount = 0;
+
+    do {
+        VNOTE_ALL_NOTES_MAP *notesMap = notesOper.loadVNotes(range);
+
+        batchCount = 0;
+
+        for (auto folderNotes : notesMap->notes) {
+            batchCount += folderNotes->folderNotes.size();
 
-    qDebug() << __FUNCTION__ << " load all notes ok:" << notesMap->notes.size() /*<< " thread id:" << QThread::currentThreadId()*/;
+            //下一批从本批最大的id之后开始
+            for (auto it = folderNotes->folderNotes.constBegin(); it != folderNotes->folderNotes.constEnd(); ++it) {
+                range.afterNoteId = qMax(range.afterNoteId, static_cast<qint32>(it.key()));
+            }
+        }
 
-    emit onAllNotesLoaded(notesMap);
+        if (batchCount > 0) {
+            emit onNotesBatchLoaded(notesMap);
+        } else {
+            delete notesMap;
+        }
+    } while (batchCount >= NOTES_BATCH_SIZE);
 }
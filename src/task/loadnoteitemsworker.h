@@ -12,22 +12,32 @@
 #include <QObject>
 #include <QRunnable>
 #include <QtGlobal>
-//加载记事项线程
+class VNoteItemOper;
+
+//加载记事项线程，先分批加载优先显示的记事本，再分批加载其余记事本
 class LoadNoteItemsWorker : public VNTask
 {
     Q_OBJECT
 public:
-    explicit LoadNoteItemsWorker(QObject *parent = nullptr);
+    explicit LoadNoteItemsWorker(qint64 priorityFolderId = -1, QObject *parent = nullptr);
+
+    //每批加载的记事项数量
+    static constexpr int NOTES_BATCH_SIZE = 1000;
 
 protected:
     //加载数据
     virtual void run();
+    //分批加载range范围内的记事项，每批发送一次onNotesBatchLoaded
+    void loadInBatches(VNoteItemOper &notesOper, VNOTE_NOTES_RANGE range);
 signals:
-    //加载完成
-    void onAllNotesLoaded(VNOTE_ALL_NOTES_MAP *foldesMap);
+    //一批数据加载完成，接收方负责释放
+    void onNotesBatchLoaded(VNOTE_ALL_NOTES_MAP *notesMap);
+    //全部加载完成
+    void onAllNotesLoaded();
 public slots:
 
 protected:
+    qint64 m_priorityFolderId {-1};
 };
 
 #endif // LOADNOTEITEMSWORKER_H
@@ -0,0 +1,32 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "savenoteworker.h"
+#include "db/vnotesavequeue.h"
+
+#include <QThread>
+
+/**
+ * @brief SaveNoteWorker::SaveNoteWorker
+ * @param delayMs 提交前等待的毫秒数
+ * @param parent
+ */
+SaveNoteWorker::SaveNoteWorker(int delayMs, QObject *parent)
+    : VNTask(parent)
+    , m_delayMs(delayMs)
+{
+}
+
+/**
+ * @brief SaveNoteWorker::run
+ */
+void SaveNoteWorker::run()
+{
+    //在保存线程中等待，不影响界面线程
+    if (m_delayMs > 0) {
+        QThread::msleep(static_cast<unsigned long>(m_delayMs));
+    }
+
+    VNoteSaveQueue::instance()->commitPending();
+}
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SAVENOTEWORKER_H
+#define SAVENOTEWORKER_H
+
+#include "vntask.h"
+
+//保存线程任务，提交异步保存队列中的笔记
+class SaveNoteWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    //delayMs 提交前等待的时间，提交失败重试时使用
+    explicit SaveNoteWorker(int delayMs = 0, QObject *parent = nullptr);
+
+protected:
+    virtual void run() override;
+
+protected:
+    int m_delayMs {0};
+};
+
+#endif // SAVENOTEWORKER_H
@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "searchindexworker.h"
+#include "common/vnoteitem.h"
+#include "common/vnotesearchindex.h"
+#include "db/dbvisitor.h"
+#include "db/vnotedbmanager.h"
+
+#include <DLog>
+
+#include <QElapsedTimer>
+
+/**
+ * @brief SearchIndexWorker::SearchIndexWorker
+ * 在界面线程调用，复制建立索引需要的笔记数据
+ * @param snapshot 所有笔记数据的快照
+ * @param parent
+ */
+SearchIndexWorker::SearchIndexWorker(const VNOTE_NOTES_SNAPSHOT &snapshot, QObject *parent)
+    : VNTask(parent)
+{
+    if (snapshot.isNull()) {
+        return;
+    }
+
+    for (auto &folderNotes : snapshot->folderNotes) {
+        for (auto note : folderNotes) {
+            IndexNote indexNote;
+            indexNote.noteId = note->noteId;
+            indexNote.title = note->noteTitle;
+            indexNote.encryption = note->encryption;
+            m_notes.append(indexNote);
+        }
+    }
+}
+
+/**
+ * @brief SearchIndexWorker::run
+ * 已在索引中的笔记是保存时更新的，数据比数据库中的新，跳过
+ */
+void SearchIndexWorker::run()
+{
+    VNoteSearchIndex *searchIndex = VNoteSearchIndex::instance();
+    VNoteDbManager *dbManager = VNoteDbManager::instance();
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    //全文索引导入完成前搜索逐条匹配，完成后内存索引只负责加密笔记
+    bool hasFullTextIndex = dbManager->buildFullTextIndex();
+
+    for (auto &note : m_notes) {
+        //与VNoteSearchIndex::isIndexedNote一致
+        if (!note.encryption && dbManager->hasFullTextIndex()) {
+            //导入期间保存的笔记已由内存索引记录，移除后由全文索引负责
+            if (hasFullTextIndex && searchIndex->contains(note.noteId)) {
+                searchIndex->removeNote(note.noteId);
+            }
+            continue;
+        }
+
+        if (searchIndex->contains(note.noteId)) {
+            continue;
+        }
+
+        //读取到临时记事项，不修改界面使用的数据
+        VNoteItem body;
+        body.noteId = note.noteId;
+
+        NoteBodyQryDbVisitor noteBodyVisitor(dbManager->getVNoteDb(), &body, &body);
+
+        if (Q_UNLIKELY(!dbManager->queryData(&noteBodyVisitor))) {
+            qCritical() << "Load note body for search index failed, noteId:" << note.noteId;
+            continue;
+        }
+
+        searchIndex->updateNote(note.noteId, note.title, body.searchText(), false);
+    }
+
+    searchIndex->setReady(true);
+
+    int noteCount = searchIndex->noteCount();
+
+    qInfo() << "Search index ready, notes:" << noteCount
+            << " terms:" << searchIndex->termCount()
+            << " elapsed ms:" << elapsedTimer.elapsed();
+
+    emit indexReady(noteCount);
+}
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SEARCHINDEXWORKER_H
+#define SEARCHINDEXWORKER_H
+
+#include "vntask.h"
+#include "datatypedef.h"
+
+#include <QVector>
+
+/**
+ * @brief The SearchIndexWorker class
+ * 笔记加载完成后在后台导入数据库全文索引，再建立内存搜索索引，正文从数据库读取，不占用正文缓存
+ * 标题在界面线程创建任务时复制，之后的重命名由索引暂存
+ */
+class SearchIndexWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    explicit SearchIndexWorker(const VNOTE_NOTES_SNAPSHOT &snapshot, QObject *parent = nullptr);
+
+signals:
+    //索引建立完成，返回索引的笔记数
+    void indexReady(int noteCount);
+
+protected:
+    virtual void run() override;
+
+private:
+    //界面线程复制的笔记数据，后台不访问界面使用的记事项
+    struct IndexNote {
+        qint32 noteId {-1};
+        QString title;
+        bool encryption {false};
+    };
+
+    QVector<IndexNote> m_notes;
+};
+
+#endif // SEARCHINDEXWORKER_H
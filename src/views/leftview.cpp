@@ -423,6 +423,45 @@ void LeftView::appendFolder(VNoteFolder *folder)
     }
 }
 
+/**
+ * @brief LeftView::updateFolder
+ * 记事本数量较少，直接遍历查找
+ * @param folderId 记事本id
+ */
+void LeftView::updateFolder(qint64 folderId)
+{
+    QStandardItem *root = getNotepadRoot();
+
+    if (nullptr == root) {
+        return;
+    }
+
+    for (int i = 0; i < root->rowCount(); i++) {
+        QStandardItem *item = root->child(i);
+        VNoteFolder *folder = reinterpret_cast<VNoteFolder *>(
+            StandardItemCommon::getStandardItemData(item->index()));
+
+        if (nullptr != folder && folder->id == folderId) {
+            update(m_pSortViewFilter->mapFromSource(item->index()));
+            break;
+        }
+    }
+}
+
+/**
+ * @brief LeftView::onNoteMoved
+ * @param noteId 记事项id
+ * @param fromFolderId 原记事本id
+ * @param toFolderId 目标记事本id
+ */
+void LeftView::onNoteMoved(qint32 noteId, qint64 fromFolderId, qint64 toFolderId)
+{
+    Q_UNUSED(noteId);
+
+    updateFolder(fromFolderId);
+    updateFolder(toFolderId);
+}
+
 /**
  * @brief LeftView::editFolder
  */
@@ -557,21 +596,13 @@ bool LeftView::doNoteMove(const QModelIndexList &src, const QModelIndex &dst)
         VNoteItem *tmpData = static_cast<VNoteItem *>(StandardItemCommon::getStandardItemData(src[0]));
         if (selectFolder && tmpData->folderId != selectFolder->id) {
             VNoteItemOper noteOper;
-            VNOTE_ITEMS_MAP *srcNotes = noteOper.getFolderNotes(tmpData->folderId);
-            VNOTE_ITEMS_MAP *destNotes = noteOper.getFolderNotes(selectFolder->id);
+            QList<VNoteItem *> moveNotes;
             for (auto it : src) {
-                tmpData = static_cast<VNoteItem *>(StandardItemCommon::getStandardItemData(it));
-                //更新内存数据
-                srcNotes->lock.lockForWrite();
-                srcNotes->folderNotes.remove(tmpData->noteId);
-                srcNotes->lock.unlock();
-
-                destNotes->lock.lockForWrite();
-                tmpData->folderId = selectFolder->id;
-                destNotes->folderNotes.insert(tmpData->noteId, tmpData);
-                destNotes->lock.unlock();
-                //更新数据库
-                noteOper.updateFolderId(tmpData);
+                moveNotes.append(static_cast<VNoteItem *>(StandardItemCommon::getStandardItemData(it)));
+            }
+            //先更新数据库（一次事务提交），成功后再更新内存数据及记事本聚合数据
+            if (!noteOper.moveNotes(moveNotes, selectFolder->id)) {
+                return false;
             }
 
             //全部移除后重置当前记事本maxid
@@ -83,6 +83,11 @@ public:
     void popupMenu();
     //重命名笔记本
     void renameVNote(QString text);
+public slots:
+    //刷新记事本项显示，记事项增删后调用
+    void updateFolder(qint64 folderId);
+    //记事项移动后刷新原记事本和目标记事本
+    void onNoteMoved(qint32 noteId, qint64 fromFolderId, qint64 toFolderId);
 signals:
     //拖拽到当前记事本
     void dropNotesEnd(bool dropCancel);
@@ -66,6 +66,10 @@ void MiddleView::initModel()
     m_pSortViewFilter->setSourceModel(m_pDataModel);
 
     this->setModel(m_pSortViewFilter);
+
+    //记事项id索引随模型行增删同步，clearAll中整体清空
+    connect(m_pDataModel, &QStandardItemModel::rowsInserted, this, &MiddleView::onNoteRowsInserted);
+    connect(m_pDataModel, &QStandardItemModel::rowsAboutToBeRemoved, this, &MiddleView::onNoteRowsAboutToBeRemoved);
 }
 
 /**
@@ -129,9 +133,13 @@ qint64 MiddleView::getCurrentId()
 void MiddleView::addRowAtHead(VNoteItem *note)
 {
     if (nullptr != note) {
-        QStandardItem *item = StandardItemCommon::createStandardItem(note, StandardItemCommon::NOTEITEM);
-        m_pDataModel->insertRow(0, item);
-        sortView(false);
+        //添加通知已经插入该记事项并调整了位置
+        QStandardItem *item = m_noteItems.value(note->noteId, nullptr);
+        if (nullptr == item) {
+            item = StandardItemCommon::createStandardItem(note, StandardItemCommon::NOTEITEM);
+            m_pDataModel->insertRow(0, item);
+            sortView(false);
+        }
         QModelIndex index = m_pDataModel->index(item->row(), 0);
         DListView::setCurrentIndex(m_pSortViewFilter->mapFromSource(index));
         this->scrollTo(currentIndex());
@@ -154,12 +162,34 @@ void MiddleView::appendRow(VNoteItem *note)
     }
 }
 
+/**
+ * @brief MiddleView::appendRows
+ * 代理模型不动态排序，追加完成后由调用方排序一次
+ * @param notes
+ */
+void MiddleView::appendRows(const QList<VNoteItem *> &notes)
+{
+    QList<QStandardItem *> items;
+    items.reserve(notes.size());
+
+    for (auto note : notes) {
+        if (nullptr != note) {
+            items.append(StandardItemCommon::createStandardItem(note, StandardItemCommon::NOTEITEM));
+        }
+    }
+
+    if (!items.isEmpty()) {
+        m_pDataModel->invisibleRootItem()->appendRows(items);
+    }
+}
+
 /**
  * @brief MiddleView::clearAll
  */
 void MiddleView::clearAll()
 {
     m_pDataModel->clear();
+    m_noteItems.clear();
     update();
 }
 
@@ -215,11 +245,163 @@ QList<VNoteItem *> MiddleView::getCurrVNotedataList() const
  */
 void MiddleView::onNoteChanged()
 {
-    sortView();
+    //只有当前项被修改，位置不变时不重新排序
+    refreshNoteRow(currentIndex(), true);
     //初始化位置参数
     initPositionStatus(currentIndex().row());
 }
 
+/**
+ * @brief MiddleView::refreshNoteRow
+ * @param index 列表项索引
+ * @param adjustCurrentItemBar true 重新排序后调整当前滚动条
+ */
+void MiddleView::refreshNoteRow(const QModelIndex &index, bool adjustCurrentItemBar)
+{
+    if (!index.isValid()) {
+        return;
+    }
+
+    if (m_pSortViewFilter->isRowInOrder(index.row())) {
+        update(index);
+    } else {
+        sortView(adjustCurrentItemBar);
+    }
+}
+
+/**
+ * @brief MiddleView::noteIndex
+ * @param noteId 记事项id
+ * @return 列表项索引
+ */
+QModelIndex MiddleView::noteIndex(qint32 noteId) const
+{
+    QStandardItem *item = m_noteItems.value(noteId, nullptr);
+
+    if (nullptr == item) {
+        return QModelIndex();
+    }
+
+    return m_pSortViewFilter->mapFromSource(item->index());
+}
+
+/**
+ * @brief MiddleView::onNoteRowsInserted
+ * @param parent
+ * @param first 起始行
+ * @param last 结束行
+ */
+void MiddleView::onNoteRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    for (int i = first; i <= last; i++) {
+        QModelIndex index = m_pDataModel->index(i, 0, parent);
+        VNoteItem *note = reinterpret_cast<VNoteItem *>(StandardItemCommon::getStandardItemData(index));
+
+        if (nullptr != note) {
+            m_noteItems.insert(note->noteId, m_pDataModel->itemFromIndex(index));
+        }
+    }
+}
+
+/**
+ * @brief MiddleView::onNoteRowsAboutToBeRemoved
+ * @param parent
+ * @param first 起始行
+ * @param last 结束行
+ */
+void MiddleView::onNoteRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    for (int i = first; i <= last; i++) {
+        VNoteItem *note = reinterpret_cast<VNoteItem *>(
+            StandardItemCommon::getStandardItemData(m_pDataModel->index(i, 0, parent)));
+
+        if (nullptr != note) {
+            m_noteItems.remove(note->noteId);
+        }
+    }
+}
+
+/**
+ * @brief MiddleView::onNoteAdded
+ * 只处理当前记事本，新建笔记由addRowAtHead选中
+ * @param folderId 记事本id
+ * @param noteId 记事项id
+ */
+void MiddleView::onNoteAdded(qint64 folderId, qint32 noteId)
+{
+    if (folderId != m_currentId || m_noteItems.contains(noteId)) {
+        return;
+    }
+
+    VNoteItemOper noteOper;
+    VNoteItem *note = noteOper.getNote(noteId);
+
+    if (nullptr != note) {
+        appendRow(note);
+        refreshNoteRow(noteIndex(noteId));
+    }
+}
+
+/**
+ * @brief MiddleView::onNoteUpdated
+ * @param folderId 记事本id
+ * @param noteId 记事项id
+ * @param fields 修改的字段
+ */
+void MiddleView::onNoteUpdated(qint64 folderId, qint32 noteId, int fields)
+{
+    Q_UNUSED(folderId);
+    Q_UNUSED(fields);
+
+    QModelIndex index = noteIndex(noteId);
+    refreshNoteRow(index, index == currentIndex());
+}
+
+/**
+ * @brief MiddleView::onNoteMoved
+ * @param noteId 记事项id
+ * @param fromFolderId 原记事本id
+ * @param toFolderId 目标记事本id
+ */
+void MiddleView::onNoteMoved(qint32 noteId, qint64 fromFolderId, qint64 toFolderId)
+{
+    if (toFolderId == m_currentId) {
+        onNoteAdded(toFolderId, noteId);
+    } else if (-1 != m_currentId) {
+        //搜索结果不按记事本过滤，保留
+        onNoteDeleted(fromFolderId, noteId);
+    }
+}
+
+/**
+ * @brief MiddleView::onNoteDeleted
+ * @param folderId 记事本id
+ * @param noteId 记事项id
+ */
+void MiddleView::onNoteDeleted(qint64 folderId, qint32 noteId)
+{
+    Q_UNUSED(folderId);
+
+    QStandardItem *item = m_noteItems.value(noteId, nullptr);
+
+    if (nullptr != item) {
+        m_pDataModel->removeRow(item->row());
+    }
+}
+
+/**
+ * @brief MiddleView::onNotePinned
+ * @param folderId 记事本id
+ * @param noteId 记事项id
+ * @param isTop 是否置顶
+ */
+void MiddleView::onNotePinned(qint64 folderId, qint32 noteId, bool isTop)
+{
+    Q_UNUSED(isTop);
+
+    onNoteUpdated(folderId, noteId, 0);
+}
+
 /**
  * @brief MiddleView::rowCount
  * @return 记事项数目
@@ -349,8 +531,13 @@ void MiddleView::saveAs(SaveAsType type)
             defaultName += ".mp3";
         }
     }
+    //导出任务创建时固定正文，加载后续笔记时不会释放已加载的正文
     ExportNoteWorker *exportWorker = new ExportNoteWorker(
         exportDir, exportType, noteDataList, defaultName);
+    //导出线程中不访问数据库，先在主线程加载正文
+    for (auto noteData : noteDataList) {
+        VNoteItemOper(noteData).loadNoteBody();
+    }
     exportWorker->setAutoDelete(true);
     connect(exportWorker, &ExportNoteWorker::exportFinished, this, &MiddleView::onExportFinished);
     QThreadPool::globalInstance()->start(exportWorker);
@@ -682,6 +869,7 @@ bool MiddleView::haveText()
     for (auto index : selectedIndexes()) {
         VNoteItem *noteData = reinterpret_cast<VNoteItem *>(
             StandardItemCommon::getStandardItemData(index));
+        VNoteItemOper(noteData).loadNoteBody();
         if (noteData->haveText()) {
             return true;
         }
@@ -699,6 +887,7 @@ bool MiddleView::haveVoice()
     for (auto index : selectedIndexes()) {
         VNoteItem *noteData = reinterpret_cast<VNoteItem *>(
             StandardItemCommon::getStandardItemData(index));
+        VNoteItemOper(noteData).loadNoteBody();
         if (noteData->haveVoice()) {
             return true;
         }
@@ -1088,20 +1277,40 @@ void MiddleView::closeMenu()
 
 /**
  * @brief MiddleView::noteStickOnTop
+ * 选中的笔记一次写入数据库，全部已置顶时取消置顶，否则全部置顶
  */
 void MiddleView::noteStickOnTop()
 {
-    QModelIndex index = this->currentIndex();
-    VNoteItem *noteData = reinterpret_cast<VNoteItem *>(
-        StandardItemCommon::getStandardItemData(index));
-    if (noteData) {
-        VNoteItemOper noteOper(noteData);
-        if (noteOper.updateTop(!noteData->isTop)) {
-            sortView();
-            //刷新起始位置
-            m_currentRow = currentIndex().row();
+    QList<VNoteItem *> notes = getCurrVNotedataList();
+    notes.removeAll(nullptr);
+
+    if (notes.isEmpty()) {
+        return;
+    }
+
+    VNoteItemOper noteOper;
+    //置顶通知中已调整各项位置
+    if (noteOper.updateTop(notes, isAllSelectedTop() ? 0 : 1)) {
+        //刷新起始位置
+        m_currentRow = currentIndex().row();
+    }
+}
+
+/**
+ * @brief MiddleView::isAllSelectedTop
+ * @return true 选中的笔记都已置顶
+ */
+bool MiddleView::isAllSelectedTop()
+{
+    QList<VNoteItem *> notes = getCurrVNotedataList();
+
+    for (auto note : notes) {
+        if (nullptr != note && !note->isTop) {
+            return false;
         }
     }
+
+    return !notes.isEmpty();
 }
 
 /**
@@ -13,6 +13,7 @@
 #include <DLabel>
 
 #include <QDateTime>
+#include <QHash>
 
 DWIDGET_USE_NAMESPACE
 class MiddleViewDelegate;
@@ -74,6 +75,8 @@ public:
     void addRowAtHead(VNoteItem *note);
     //尾部追加记事项
     void appendRow(VNoteItem *note);
+    //尾部批量追加记事项，只触发一次行插入
+    void appendRows(const QList<VNoteItem *> &notes);
     //清除记事项
     void clearAll();
     //根据索引选中记事本
@@ -94,8 +97,10 @@ public:
     VNoteItem *getCurrVNotedata() const;
     //当前选中数据项列表
     QList<VNoteItem *> getCurrVNotedataList() const;
-    //置顶/取消置顶
+    //置顶/取消置顶，多选时一起修改
     void noteStickOnTop();
+    //选中的笔记是否都已置顶
+    bool isAllSelectedTop();
     //排序
     void sortView(bool adjustCurrentItemBar = true);
     //获取选中的笔记列表
@@ -137,6 +142,17 @@ public slots:
     void onRefresh();
     //文件导出完成
     void onExportFinished(int err);
+    //以下响应记事项变化通知，只更新受影响的行
+    //添加记事项
+    void onNoteAdded(qint64 folderId, qint32 noteId);
+    //记事项修改
+    void onNoteUpdated(qint64 folderId, qint32 noteId, int fields);
+    //记事项移动
+    void onNoteMoved(qint32 noteId, qint64 fromFolderId, qint64 toFolderId);
+    //删除记事项
+    void onNoteDeleted(qint64 folderId, qint32 noteId);
+    //置顶状态修改
+    void onNotePinned(qint64 folderId, qint32 noteId, bool isTop);
 
 protected:
     //鼠标事件
@@ -183,6 +199,13 @@ private:
     void changeRightView(bool isMultipleDetailPage = true);
     //初始化位置状态
     void initPositionStatus(int row);
+    //刷新一行，位置变化时才重新排序
+    void refreshNoteRow(const QModelIndex &index, bool adjustCurrentItemBar = false);
+    //通过记事项id查找列表项，不存在返回无效索引
+    QModelIndex noteIndex(qint32 noteId) const;
+    //模型行增删时同步记事项id索引
+    void onNoteRowsInserted(const QModelIndex &parent, int first, int last);
+    void onNoteRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
 
     bool m_onlyCurItemMenuEnable {false};
     qint64 m_currentId {-1};
@@ -192,6 +215,8 @@ private:
     VNoteRightMenu *m_noteMenu {nullptr};
 
     QStandardItemModel *m_pDataModel {nullptr};
+    //记事项id->模型中的列表项
+    QHash<qint32, QStandardItem *> m_noteItems;
     MiddleViewDelegate *m_pItemDelegate {nullptr};
     MiddleViewSortFilter *m_pSortViewFilter {nullptr};
     MoveView *m_MoveView {nullptr};
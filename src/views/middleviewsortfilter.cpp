@@ -31,6 +31,38 @@ void MiddleViewSortFilter::sortView(MiddleViewSortFilter::sortFeild feild,
     sort(column, order);
 }
 
+/**
+ * @brief MiddleViewSortFilter::isRowInOrder
+ * 未排序过时按插入顺序显示，视为有序
+ * @param row 行号
+ * @return true 不需要重新排序
+ */
+bool MiddleViewSortFilter::isRowInOrder(int row) const
+{
+    if (sortColumn() < 0) {
+        return true;
+    }
+
+    QModelIndex current = mapToSource(index(row, 0));
+    bool isDescending = (Qt::DescendingOrder == sortOrder());
+
+    if (row > 0) {
+        QModelIndex prev = mapToSource(index(row - 1, 0));
+        if (isDescending ? lessThan(prev, current) : lessThan(current, prev)) {
+            return false;
+        }
+    }
+
+    if (row < rowCount() - 1) {
+        QModelIndex next = mapToSource(index(row + 1, 0));
+        if (isDescending ? lessThan(current, next) : lessThan(next, current)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 /**
  * @brief MiddleViewSortFilter::lessThan
  * @param source_left
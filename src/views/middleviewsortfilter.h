@@ -23,6 +23,8 @@ public:
         sortFeild feild = modifyTime,
         int column = 0,
         Qt::SortOrder order = Qt::DescendingOrder);
+    //数据变化后该行是否仍在正确位置，只比较相邻行
+    bool isRowInOrder(int row) const;
 
 protected:
     //处理排序
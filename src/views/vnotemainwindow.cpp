@@ -27,10 +27,13 @@
 #include "common/setting.h"
 #include "common/performancemonitor.h"
 #include "common/jscontent.h"
+#include "common/vnotesearchindex.h"
 
 #include "db/vnotefolderoper.h"
 #include "db/vnoteitemoper.h"
+#include "db/vnotesavequeue.h"
 #include "db/vnotedbmanager.h"
+#include "db/dbquerystats.h"
 
 #include "dbus/dbuslogin1manager.h"
 
@@ -40,6 +43,9 @@
 #include "widgets/vnotepushbutton.h"
 #include "task/vnmainwnddelayinittask.h"
 #include "task/filecleanupworker.h"
+#include "task/backupdbworker.h"
+#include "task/dbmaintenanceworker.h"
+#include "task/searchindexworker.h"
 
 #ifdef IMPORT_OLD_VERSION_DATA
 #include "importolddata/upgradeview.h"
@@ -62,6 +68,7 @@
 #include <QScrollBar>
 #include <QLocale>
 #include <QDesktopServices>
+#include <QTimer>
 
 static OpsStateInterface *stateOperation = nullptr;
 
@@ -119,6 +126,18 @@ void VNoteMainWindow::initData()
 void VNoteMainWindow::initAppSetting()
 {
     stateOperation = OpsStateInterface::instance();
+
+    //数据加载前设置慢查询阈值
+    QVariant slowQueryMs = setting::instance()->getOption(VNOTE_DB_SLOW_QUERY_MS);
+    if (slowQueryMs.isValid()) {
+        DbQueryStats::instance()->setSlowQueryThreshold(slowQueryMs.toInt());
+    }
+
+    //正文缓存预算，单位MB，0不限制
+    QVariant bodyCacheMb = setting::instance()->getOption(VNOTE_BODY_CACHE_BUDGET_MB);
+    if (bodyCacheMb.isValid()) {
+        VNoteDataManager::instance()->setBodyCacheBudget(bodyCacheMb.toLongLong() * 1024 * 1024);
+    }
 }
 
 /**
@@ -129,6 +148,30 @@ void VNoteMainWindow::initConnections()
     connect(VNoteDataManager::instance(), &VNoteDataManager::onAllDatasReady,
             this, &VNoteMainWindow::onVNoteFoldersLoaded);
 
+    connect(VNoteDataManager::instance(), &VNoteDataManager::onNoteItemsBatchLoaded,
+            this, &VNoteMainWindow::onVNoteItemsBatchLoaded);
+
+    connect(VNoteDataManager::instance(), &VNoteDataManager::onNoteItemsLoaded,
+            this, &VNoteMainWindow::onVNoteItemsLoaded);
+
+    //记事项变化只更新受影响的列表项
+    connect(VNoteDataManager::instance(), &VNoteDataManager::noteAdded,
+            m_middleView, &MiddleView::onNoteAdded);
+    connect(VNoteDataManager::instance(), &VNoteDataManager::noteUpdated,
+            m_middleView, &MiddleView::onNoteUpdated);
+    connect(VNoteDataManager::instance(), &VNoteDataManager::noteMoved,
+            m_middleView, &MiddleView::onNoteMoved);
+    connect(VNoteDataManager::instance(), &VNoteDataManager::noteDeleted,
+            m_middleView, &MiddleView::onNoteDeleted);
+    connect(VNoteDataManager::instance(), &VNoteDataManager::notePinned,
+            m_middleView, &MiddleView::onNotePinned);
+    connect(VNoteDataManager::instance(), &VNoteDataManager::noteAdded,
+            m_leftView, &LeftView::updateFolder);
+    connect(VNoteDataManager::instance(), &VNoteDataManager::noteDeleted,
+            m_leftView, &LeftView::updateFolder);
+    connect(VNoteDataManager::instance(), &VNoteDataManager::noteMoved,
+            m_leftView, &LeftView::onNoteMoved);
+
     connect(m_noteSearchEdit, &DSearchEdit::editingFinished,
             this, &VNoteMainWindow::onVNoteSearch);
 
@@ -668,12 +711,129 @@ void VNoteMainWindow::onVNoteFoldersLoaded()
 
     PerformanceMonitor::initializeAppFinish();
 
+    //注册数据库定时备份，每小时检查一次是否到达备份间隔
+    if (nullptr == m_dbBackupTimer) {
+        m_dbBackupTimer = new QTimer(this);
+        m_dbBackupTimer->setInterval(60 * 60 * 1000);
+        connect(m_dbBackupTimer, &QTimer::timeout, this, &VNoteMainWindow::startDbBackupIfNeed);
+        m_dbBackupTimer->start();
+    }
+
+    startDbBackupIfNeed();
+
+    //注册数据库维护，启动时及删除操作后空闲2分钟检查
+    if (nullptr == m_dbMaintainTimer) {
+        m_dbMaintainTimer = new QTimer(this);
+        m_dbMaintainTimer->setSingleShot(true);
+        m_dbMaintainTimer->setInterval(2 * 60 * 1000);
+        connect(m_dbMaintainTimer, &QTimer::timeout, this, &VNoteMainWindow::startDbMaintenanceIfNeed);
+    }
+
+    startDbMaintenanceIfNeed();
+}
+
+/**
+ * @brief VNoteMainWindow::onVNoteItemsBatchLoaded
+ * 当前显示的记事本有新数据时追加到列表，不影响已选中的笔记
+ * @param notes 新加入的笔记
+ */
+void VNoteMainWindow::onVNoteItemsBatchLoaded(const QList<VNoteItem *> &notes)
+{
+    //刷新记事本列表中的笔记数量
+    m_leftView->viewport()->update();
+
+    if (stateOperation->isSearching()) {
+        return;
+    }
+
+    qint64 currentId = m_middleView->getCurrentId();
+    bool wasEmpty = (0 == m_middleView->rowCount());
+    bool hasNewRows = false;
+
+    for (auto note : notes) {
+        if (note->folderId == currentId) {
+            if (wasEmpty) {
+                hasNewRows = true;
+                break;
+            }
+
+            m_middleView->appendRow(note);
+            hasNewRows = true;
+        }
+    }
+
+    if (!hasNewRows) {
+        return;
+    }
+
+    if (wasEmpty) {
+        //空列表时按切换记事本的流程重新加载，刷新详情页
+        onVNoteFolderChange(m_leftView->currentIndex(), QModelIndex());
+    } else {
+        m_middleView->sortView(false);
+    }
+}
+
+/**
+ * @brief VNoteMainWindow::onVNoteItemsLoaded
+ * 文件清理需要所有笔记的引用信息，在全部加载后开始
+ */
+void VNoteMainWindow::onVNoteItemsLoaded()
+{
+#ifdef IMPORT_OLD_VERSION_DATA
+    if (m_fNeedUpgradeOldDb) {
+        return;
+    }
+#endif
+
     //注册文件清理工作
     FileCleanupWorker *pFileCleanupWorker =
-        new FileCleanupWorker(VNoteDataManager::instance()->getAllNotesInFolder(), this);
+        new FileCleanupWorker(VNoteDataManager::instance()->notesSnapshot(), this);
     pFileCleanupWorker->setAutoDelete(true);
     pFileCleanupWorker->setObjectName("FileCleanupWorker");
     QThreadPool::globalInstance()->start(pFileCleanupWorker);
+
+    //建立全文索引之外笔记的内存搜索索引
+    SearchIndexWorker *pSearchIndexWorker =
+        new SearchIndexWorker(VNoteDataManager::instance()->notesSnapshot(), this);
+    pSearchIndexWorker->setAutoDelete(true);
+    pSearchIndexWorker->setObjectName("SearchIndexWorker");
+    QThreadPool::globalInstance()->start(pSearchIndexWorker);
+}
+
+/**
+ * @brief VNoteMainWindow::startDbBackupIfNeed
+ */
+void VNoteMainWindow::startDbBackupIfNeed()
+{
+    QString dbPath = VNoteDbManager::instance()->databasePath();
+    int keepCount = setting::instance()->getOption(VNOTE_DB_BACKUP_KEEP_COUNT).toInt();
+    int intervalHours = setting::instance()->getOption(VNOTE_DB_BACKUP_INTERVAL).toInt();
+
+    if (dbPath.isEmpty() || keepCount <= 0 || intervalHours <= 0
+            || !BackupDbWorker::isBackupDue(dbPath, intervalHours)) {
+        return;
+    }
+
+    BackupDbWorker *pBackupDbWorker = new BackupDbWorker(dbPath, keepCount);
+    pBackupDbWorker->setAutoDelete(true);
+    pBackupDbWorker->setObjectName("BackupDbWorker");
+    QThreadPool::globalInstance()->start(pBackupDbWorker);
+}
+
+/**
+ * @brief VNoteMainWindow::startDbMaintenanceIfNeed
+ */
+void VNoteMainWindow::startDbMaintenanceIfNeed()
+{
+    if (!DbMaintenanceWorker::isMaintenanceDue()) {
+        return;
+    }
+
+    DbMaintenanceWorker *pDbMaintenanceWorker = new DbMaintenanceWorker();
+    pDbMaintenanceWorker->setAutoDelete(true);
+    pDbMaintenanceWorker->setObjectName("DbMaintenanceWorker");
+    QThreadPool::globalInstance()->start(pDbMaintenanceWorker);
 }
 
 /**
@@ -1188,8 +1348,8 @@ void VNoteMainWindow::onMenuAction(QAction *action)
         if (notesdataList.size()) {
             QModelIndex selectFolder = m_leftView->selectMoveFolder(notesdataList);
             m_leftView->setNumberOfNotes(m_middleView->count());
+            //移动通知中已移除笔记项
             if (selectFolder.isValid() && m_leftView->doNoteMove(notesdataList, selectFolder)) {
-                m_middleView->deleteModelIndexs(notesdataList);
                 //删除后设置选中
                 m_middleView->selectAfterRemoved();
             }
@@ -1217,7 +1377,7 @@ void VNoteMainWindow::onMenuAbout2Show()
         m_richTextEdit->updateNote();
 
         bool notMultipleSelected = !m_middleView->isMultipleSelected();
-        ActionManager::Instance()->visibleAction(ActionManager::NoteTop, notMultipleSelected);
+        ActionManager::Instance()->visibleAction(ActionManager::NoteTop, true);
         ActionManager::Instance()->visibleAction(ActionManager::NoteRename, notMultipleSelected);
 
         ActionManager::Instance()->resetCtxMenu(ActionManager::MenuType::NoteCtxMenu);
@@ -1253,18 +1413,20 @@ void VNoteMainWindow::onMenuAbout2Show()
         } else {
             VNoteItem *currNoteData = m_middleView->getCurrVNotedata();
             if (nullptr != currNoteData) {
+                VNoteItemOper(currNoteData).loadNoteBody();
                 //根据当前笔记是否有文本设置保存笔记二级菜单置灰状态
                 ActionManager::Instance()->saveNoteContextMenu()->setEnabled(currNoteData->haveText());
                 if (!currNoteData->haveVoice()) {
                     ActionManager::Instance()->enableAction(ActionManager::NoteSaveVoice, false);
                 }
-                if (currNoteData->isTop) {
-                    topAction->setText(DApplication::translate("NotesContextMenu", "Unstick"));
-                } else {
-                    topAction->setText(DApplication::translate("NotesContextMenu", "Sticky on Top"));
-                }
             }
         }
+        //多选时全部已置顶才显示取消置顶
+        if (m_middleView->isAllSelectedTop()) {
+            topAction->setText(DApplication::translate("NotesContextMenu", "Unstick"));
+        } else {
+            topAction->setText(DApplication::translate("NotesContextMenu", "Sticky on Top"));
+        }
     } else if (menu == ActionManager::Instance()->notebookContextMenu()) {
         ActionManager::Instance()->resetCtxMenu(ActionManager::MenuType::NotebookCtxMenu);
 
@@ -1371,6 +1533,10 @@ void VNoteMainWindow::delNotepad()
     VNoteFolderOper folderOper(data);
     folderOper.deleteVNoteFolder(data);
 
+    if (nullptr != m_dbMaintainTimer) {
+        m_dbMaintainTimer->start();
+    }
+
     if (0 == m_leftView->folderCount()) {
         switchWidget(WndHomePage);
     }
@@ -1441,9 +1607,11 @@ void VNoteMainWindow::delNote()
     if (noteDataList.size()) {
         //删除笔记之前先解除详情页绑定的笔记数据
         m_richTextEdit->unboundCurrentNoteData();
-        for (auto noteData : noteDataList) {
-            VNoteItemOper noteOper(noteData);
-            noteOper.deleteNote();
+        VNoteItemOper noteOper;
+        noteOper.deleteNotes(noteDataList);
+
+        if (nullptr != m_dbMaintainTimer) {
+            m_dbMaintainTimer->start();
         }
         //Refresh the middle view
         if (m_middleView->rowCount() <= 0 && stateOperation->isSearching()) {
@@ -1473,13 +1641,14 @@ int VNoteMainWindow::loadNotes(VNoteFolder *folder)
         VNOTE_ITEMS_MAP *notes = noteOper.getFolderNotes(folder->id);
         if (notes) {
             notes->lock.lockForRead();
-            for (auto it : notes->folderNotes) {
-                m_middleView->appendRow(it);
-            }
+            QList<VNoteItem *> folderNotes = notes->folderNotes.values();
             notes->lock.unlock();
 
+            //一次插入全部行，行索引由插入通知同步
+            m_middleView->appendRows(folderNotes);
+
             //Sort the view & set focus on first item
-            m_middleView->onNoteChanged();
+            m_middleView->sortView();
             m_middleView->setCurrentIndex(0);
         }
     } else {
@@ -1497,17 +1666,55 @@ int VNoteMainWindow::loadSearchNotes(const QString &key)
 {
     m_middleView->clearAll();
     m_middleView->setSearchKey(key);
-    VNOTE_ALL_NOTES_MAP *noteAll = VNoteDataManager::instance()->getAllNotesInFolder();
-    if (noteAll) {
-        noteAll->lock.lockForRead();
-        for (auto &foldeNotes : noteAll->notes) {
-            for (auto note : foldeNotes->folderNotes) {
-                if (note->search(key)) {
-                    m_middleView->appendRow(note);
+    //遍历快照不持有数据锁，加载正文期间不阻塞其他线程
+    VNOTE_NOTES_SNAPSHOT snapshot = VNoteDataManager::instance()->notesSnapshot();
+    if (!snapshot.isNull()) {
+        //未加密笔记使用数据库全文索引，其余笔记使用内存索引，避免逐条加载正文
+        VNoteItemOper noteOper;
+        QSet<qint32> matchedIds;
+        QSet<qint32> candidateIds;
+        bool isIndexed = noteOper.searchNotes(key, matchedIds);
+        bool isMemoryIndexed = VNoteSearchIndex::instance()->search(key, candidateIds);
+
+        //索引命中的笔记通过note_id直接定位
+        for (auto noteId : matchedIds) {
+            VNoteItem *note = noteOper.getNote(noteId);
+            if (nullptr != note) {
+                m_middleView->appendRow(note);
+            }
+        }
+
+        //内存索引只返回候选笔记，查询词不一定相邻，逐条确认
+        for (auto noteId : candidateIds) {
+            VNoteItem *note = matchedIds.contains(noteId) ? nullptr : noteOper.getNote(noteId);
+            if (nullptr == note) {
+                continue;
+            }
+            if (!note->noteTitle.contains(key, Qt::CaseInsensitive)) {
+                VNoteItemOper(note).loadNoteBody();
+            }
+            if (note->search(key)) {
+                m_middleView->appendRow(note);
+            }
+        }
+
+        //索引不可用或未建立完成时逐条匹配对应的笔记
+        if (!isIndexed || !isMemoryIndexed) {
+            for (auto &foldeNotes : snapshot->folderNotes) {
+                for (auto note : foldeNotes) {
+                    if (VNoteSearchIndex::isIndexedNote(note) ? isMemoryIndexed : isIndexed) {
+                        continue;
+                    }
+                    //标题不匹配时才需要正文
+                    if (!note->noteTitle.contains(key, Qt::CaseInsensitive)) {
+                        VNoteItemOper(note).loadNoteBody();
+                    }
+                    if (note->search(key)) {
+                        m_middleView->appendRow(note);
+                    }
                 }
             }
         }
-        noteAll->lock.unlock();
         if (m_middleView->rowCount() == 0) {
             m_middleView->setVisibleEmptySearch(true);
             m_stackedRightMainWidget->setCurrentWidget(m_rightViewHolder);
@@ -1858,6 +2065,11 @@ void VNoteMainWindow::release()
 
     VTextSpeechAndTrManager::onStopTextToSpeech();
     m_richTextEdit->updateNote();
+    //退出前写入所有待保存的笔记
+    VNoteSaveQueue::instance()->quit();
+    //未完成的备份和维护直接放弃，不阻塞退出
+    BackupDbWorker::requestStop();
+    DbMaintenanceWorker::requestStop();
 
     if (stateOperation->isVoice2Text()) {
         QScopedPointer<VNoteA2TManager> releaseA2TManger(m_a2tManager);
@@ -1954,10 +2166,8 @@ void VNoteMainWindow::onDropNote(bool dropCancel)
     QPoint point = m_leftView->mapFromGlobal(QCursor::pos());
     QModelIndex selectIndex = m_leftView->indexAt(point);
     m_leftView->setNumberOfNotes(m_middleView->count());
-    bool ret = m_leftView->doNoteMove(indexList, selectIndex);
-    if (ret) {
-        m_middleView->deleteModelIndexs(indexList);
-    }
+    //移动成功后移动通知中已移除笔记项
+    m_leftView->doNoteMove(indexList, selectIndex);
     //拖拽完成
     m_middleView->setDragSuccess(true);
 }
@@ -1977,8 +2187,8 @@ void VNoteMainWindow::handleMultipleOption(int id)
         if (notesdata.size()) {
             QModelIndex selectFolder = m_leftView->selectMoveFolder(notesdata);
             m_leftView->setNumberOfNotes(m_middleView->count());
+            //移动通知中已移除笔记项
             if (selectFolder.isValid() && m_leftView->doNoteMove(notesdata, selectFolder)) {
-                m_middleView->deleteModelIndexs(notesdata);
                 //移除后选中
                 m_middleView->selectAfterRemoved();
             }
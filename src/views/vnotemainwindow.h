@@ -40,6 +40,7 @@ class HomePage;
 class SplashView;
 class VoiceNoteItem;
 class DBusLogin1Manager;
+class QTimer;
 class VNMainWndDelayInitTask;
 class UpgradeView;
 //多选操作页面
@@ -145,6 +146,10 @@ protected:
 public slots:
     //记事本数据加载完成
     void onVNoteFoldersLoaded();
+    //首屏之后加载的一批笔记数据
+    void onVNoteItemsBatchLoaded(const QList<VNoteItem *> &notes);
+    //所有笔记数据加载完成
+    void onVNoteItemsLoaded();
     //当前记事本改变
     void onVNoteFolderChange(const QModelIndex &current, const QModelIndex &previous);
     //当前记事项改变
@@ -272,6 +277,10 @@ private:
     void showNotepadList();
     //更新2栏显示笔记本名称
     void updateFolderName(QString name = "");
+    //距上次备份超过间隔时在后台备份数据库
+    void startDbBackupIfNeed();
+    //可回收空间超过阈值时在后台维护数据库
+    void startDbMaintenanceIfNeed();
 
 private:
     DSearchEdit *m_noteSearchEdit {nullptr};
@@ -345,6 +354,10 @@ private:
     //Login session manager
     DBusLogin1Manager *m_pLogin1Manager {nullptr};
     QDBusPendingReply<QDBusUnixFileDescriptor> m_lockFd;
+    //定时检查是否需要备份数据库
+    QTimer *m_dbBackupTimer {nullptr};
+    //删除操作后空闲一段时间再检查是否需要维护数据库
+    QTimer *m_dbMaintainTimer {nullptr};
 
     friend class VNMainWndDelayInitTask;
 };
@@ -7,6 +7,7 @@
 #include "common/jscontent.h"
 #include "common/actionmanager.h"
 #include "common/vnoteitem.h"
+#include "common/vnotedatamanager.h"
 #include "common/metadataparser.h"
 #include "common/vtextspeechandtrmanager.h"
 #include "dialog/imageviewerdialog.h"
@@ -15,6 +16,7 @@
 #include "dialog/vnotemessagedialog.h"
 
 #include "db/vnoteitemoper.h"
+#include "db/vnotesavequeue.h"
 
 #include <DFileDialog>
 #include <DGuiApplicationHelper>
@@ -202,7 +204,8 @@ void WebRichTextEditor::updateNote()
             if (result.isValid()) {
                 m_noteData->htmlCode = result.toString();
                 VNoteItemOper noteOps(m_noteData);
-                if (!noteOps.updateNote()) {
+                //放入保存线程，界面不等待数据库写入
+                if (!noteOps.updateNoteAsync()) {
                     qInfo() << "Save note error";
                 }
             }
@@ -224,8 +227,10 @@ void WebRichTextEditor::unboundCurrentNoteData()
 {
     //停止更新定时器
     m_updateTimer->stop();
-    //手动更新
+    //手动更新，不再等待合并
     updateNote();
+    VNoteSaveQueue::instance()->commitSoon();
+    VNoteDataManager::instance()->unpinNoteBody(m_noteData);
     //绑定数据设置为空
     m_noteData = nullptr;
 }
@@ -707,7 +712,16 @@ void WebRichTextEditor::setData(VNoteItem *data, const QString &reg)
     if (m_noteData != data || reSet) { //笔记切换或清除搜索结果时设置笔记内容
         m_updateTimer->stop();
         updateNote();
+        //切换笔记时立即提交之前的修改
+        VNoteSaveQueue::instance()->commitSoon();
+        //编辑中的笔记正文不被缓存释放
+        if (m_noteData != data) {
+            VNoteDataManager::instance()->unpinNoteBody(m_noteData);
+            VNoteDataManager::instance()->pinNoteBody(data);
+        }
         m_noteData = data;
+        //启动时只加载了摘要，显示前加载正文
+        VNoteItemOper(data).loadNoteBody();
         if (m_loadFinshSign) {
             if (data->htmlCode.isEmpty()) {
                 emit JsContent::instance()->callJsInitData(data->metaDataRef().toString());
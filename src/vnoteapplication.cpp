@@ -7,6 +7,8 @@
 #include "globaldef.h"
 #include "setting.h"
 #include "eventlogutils.h"
+#include "db/dbquerystats.h"
+#include "common/vnotedatamanager.h"
 
 #include <DWidgetUtil>
 #include <DGuiApplicationHelper>
@@ -116,10 +118,17 @@ bool VNoteApplication::notify(QObject *obj, QEvent *event)
 void VNoteApplication::onNewProcessInstance(qint64 pid, const QStringList &arguments)
 {
     Q_UNUSED(pid);
-    Q_UNUSED(arguments);
 
-    //TODO:
-    //Parase comandline here
+    //新进程只请求输出数据库统计，不激活窗口
+    if (arguments.contains(VNOTE_DUMP_DB_STATS_OPTION)) {
+        qInfo().noquote() << DbQueryStats::instance()->dump();
+
+        VNOTE_BODY_CACHE_STATS bodyStats = VNoteDataManager::instance()->bodyCacheStats();
+        qInfo() << "Note body cache, hits:" << bodyStats.hits << "misses:" << bodyStats.misses
+                << "evictions:" << bodyStats.evictions << "notes:" << bodyStats.notesResident
+                << "bytes:" << bodyStats.bytesResident << "budget:" << bodyStats.budgetBytes;
+        return;
+    }
 
     activateWindow();
 }
@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "vnotedbbenchmark.h"
+#include "common/vnotedatamanager.h"
+#include "db/vnotedbmanager.h"
+#include "db/vnotesavequeue.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include <QThreadPool>
+
+#include <sqlite3.h>
+
+#include <cstdio>
+
+int main(int argc, char *argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    app.setOrganizationName("deepin");
+    app.setApplicationName("deepin-voice-note-benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Database benchmark for deepin-voice-note, results are written as json.");
+    parser.addHelpOption();
+
+    QCommandLineOption sizesOption("sizes", "Comma separated note counts of the generated databases.", "counts", "1000,10000,100000");
+    QCommandLineOption foldersOption("folders", "Folder count of the generated databases.", "count", "20");
+    QCommandLineOption iterationsOption("iterations", "Iterations of each operation.", "count", "10");
+    QCommandLineOption seedOption("seed", "Seed of the corpus generator.", "seed", "20231016");
+    QCommandLineOption outputOption("output", "Result file, stdout when not set.", "file");
+    QCommandLineOption workDirOption("work-dir", "Directory of the generated databases, a temporary directory when not set.", "dir");
+
+    parser.addOptions({sizesOption, foldersOption, iterationsOption, seedOption, outputOption, workDirOption});
+    parser.process(app);
+
+    //计时期间不输出普通日志
+    QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+
+    QTemporaryDir tempDir;
+    QString workDir = parser.isSet(workDirOption) ? parser.value(workDirOption) : tempDir.path();
+    quint32 seed = parser.value(seedOption).toUInt();
+
+    //记事本图标在加载数据时使用
+    VNoteDataManager::instance()->reqNoteDefIcons();
+    QThreadPool::globalInstance()->waitForDone();
+
+    VNoteDbBenchmark benchmark(workDir, seed,
+                               qMax(1, parser.value(foldersOption).toInt()),
+                               qMax(1, parser.value(iterationsOption).toInt()));
+    bool isOK = true;
+
+    for (auto it : parser.value(sizesOption).split(',', QString::SkipEmptyParts)) {
+        if (!benchmark.run(it.toInt())) {
+            qCritical() << "Benchmark failed, notes:" << it;
+            isOK = false;
+            break;
+        }
+    }
+
+    VNoteSaveQueue::instance()->quit();
+
+    QJsonObject report;
+    report.insert("benchmark", "deepin-voice-note-db");
+    report.insert("schemaVersion", VNoteDbManager::SCHEMA_VERSION);
+    report.insert("sqliteVersion", sqlite3_libversion());
+    report.insert("seed", static_cast<qint64>(seed));
+    report.insert("timestamp", QDateTime::currentDateTime().toString(Qt::ISODate));
+    report.insert("results", benchmark.results());
+
+    QByteArray reportData = QJsonDocument(report).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile reportFile(parser.value(outputOption));
+
+        if (!reportFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical() << "Open result file failed:" << reportFile.fileName();
+            return 1;
+        }
+
+        reportFile.write(reportData);
+    } else {
+        fwrite(reportData.constData(), 1, static_cast<size_t>(reportData.size()), stdout);
+    }
+
+    return isOK ? 0 : 1;
+}
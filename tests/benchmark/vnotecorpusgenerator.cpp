@@ -0,0 +1,213 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "vnotecorpusgenerator.h"
+#include "common/vnoteforlder.h"
+#include "common/vnoteitem.h"
+#include "common/metadataparser.h"
+#include "common/utils.h"
+#include "db/vnotedbmanager.h"
+#include "db/vnotefolderoper.h"
+#include "db/vnoteitemoper.h"
+
+#include <QVector>
+
+#include <DLog>
+
+namespace {
+//中英文混合词表，接近真实笔记的字符分布
+const QStringList &corpusWords()
+{
+    static const QStringList words = {
+        "会议", "记录", "项目", "进度", "需求", "讨论", "方案", "测试", "发布", "计划",
+        "今天", "明天", "客户", "反馈", "问题", "修复", "优化", "总结", "学习", "笔记",
+        "语音", "录音", "转写", "整理", "提醒", "购物", "清单", "旅行", "预算", "日程",
+        "meeting", "review", "release", "deadline", "budget", "design", "feature", "bug",
+        "performance", "database", "schedule", "todo", "draft", "summary", "idea", "report",
+    };
+
+    return words;
+}
+} // namespace
+
+/**
+ * @brief VNoteCorpusGenerator::VNoteCorpusGenerator
+ * @param seed 随机数种子
+ */
+VNoteCorpusGenerator::VNoteCorpusGenerator(quint32 seed)
+    : m_random(seed)
+    , m_baseTime(QDate(2022, 1, 1), QTime(8, 0))
+{
+}
+
+/**
+ * @brief VNoteCorpusGenerator::generate
+ * 笔记随机分布到各记事本，每NOTES_PER_TRANSACTION条提交一次
+ * @param folderCount 记事本数
+ * @param noteCount 笔记数
+ * @return true 成功
+ */
+bool VNoteCorpusGenerator::generate(int folderCount, int noteCount)
+{
+    QVector<qint64> folderIds;
+    VNoteFolderOper folderOper;
+
+    for (int i = 0; i < folderCount; i++) {
+        VNoteFolder folder;
+        folder.name = QString("Folder %1 %2").arg(i + 1).arg(makeText(2));
+        folder.createTime = m_baseTime.addSecs(i * 60);
+
+        VNoteFolder *newFolder = folderOper.addFolder(folder);
+
+        if (nullptr == newFolder) {
+            qCritical() << "Generate folder failed, index:" << i;
+            return false;
+        }
+
+        folderIds.append(newFolder->id);
+    }
+
+    VNoteDbManager *dbManager = VNoteDbManager::instance();
+    VNoteItemOper noteOper;
+    bool isOK = true;
+
+    if (!dbManager->beginTransaction()) {
+        qCritical() << "Generate notes failed: begin transaction failed";
+        return false;
+    }
+
+    for (int i = 0; i < noteCount && isOK; i++) {
+        VNoteItem note;
+        note.folderId = folderIds.at(randomInt(0, folderIds.size() - 1));
+        note.noteType = VNoteItem::VNT_Text;
+        note.noteTitle = makeText(randomInt(2, 6));
+        note.htmlCode = makeNoteHtml();
+        //两年内的随机时间
+        note.createTime = m_baseTime.addSecs(randomInt(0, 2 * 365 * 24 * 3600));
+        note.modifyTime = note.createTime;
+
+        isOK = (nullptr != noteOper.addNote(note));
+
+        if (isOK && (i + 1) % NOTES_PER_TRANSACTION == 0) {
+            //提交或开始失败时没有未结束的事务
+            if (!dbManager->commitTransaction() || !dbManager->beginTransaction()) {
+                qCritical() << "Generate notes failed: commit failed";
+                return false;
+            }
+        }
+    }
+
+    if (isOK) {
+        isOK = dbManager->commitTransaction();
+    } else {
+        qCritical() << "Generate notes failed";
+        dbManager->rollbackTransaction();
+    }
+
+    return isOK;
+}
+
+/**
+ * @brief VNoteCorpusGenerator::randomInt
+ * @param min 最小值
+ * @param max 最大值
+ * @return 随机数
+ */
+int VNoteCorpusGenerator::randomInt(int min, int max)
+{
+    std::uniform_int_distribution<int> distribution(min, max);
+    return distribution(m_random);
+}
+
+/**
+ * @brief VNoteCorpusGenerator::makeText
+ * @param wordCount 词数
+ * @return 文本
+ */
+QString VNoteCorpusGenerator::makeText(int wordCount)
+{
+    const QStringList &words = corpusWords();
+    QStringList text;
+
+    for (int i = 0; i < wordCount; i++) {
+        text.append(words.at(randomInt(0, words.size() - 1)));
+    }
+
+    return text.join(' ');
+}
+
+/**
+ * @brief VNoteCorpusGenerator::makeNoteHtml
+ * 多数笔记较短，少数较长，长笔记会触发元数据压缩
+ * @return html
+ */
+QString VNoteCorpusGenerator::makeNoteHtml()
+{
+    QString html;
+    int paragraphCount = (randomInt(0, 9) == 0) ? randomInt(20, 80) : randomInt(1, 8);
+
+    for (int i = 0; i < paragraphCount; i++) {
+        if (randomInt(0, 3) == 0) {
+            html += makeVoiceHtml();
+        }
+
+        QString text = makeText(randomInt(5, 40));
+
+        //部分段落包含搜索关键字，保证搜索有结果
+        if (randomInt(0, 4) == 0) {
+            const QStringList &keywords = searchKeywords();
+            text += " " + keywords.at(randomInt(0, keywords.size() - 1));
+        }
+
+        html += QString("<p>%1</p>").arg(text.toHtmlEscaped());
+    }
+
+    return html;
+}
+
+/**
+ * @brief VNoteCorpusGenerator::makeVoiceHtml
+ * @return 语音块html
+ */
+QString VNoteCorpusGenerator::makeVoiceHtml()
+{
+    static constexpr char const *VOICE_HTML_FMT = "<div class=\"li voiceBox\" contenteditable=\"false\" jsonKey=\"%1\">"
+                                                  "<div class='voiceInfoBox'><div class=\"demo\"><div class=\"voicebtn play\"></div>"
+                                                  "<div class=\"lf\"><div class=\"title\">%2</div><div class=\"minute padtop\">%3</div></div>"
+                                                  "<div class=\"lr\"><div class=\"icon\"><div class=\"wifi-symbol\"><div class=\"wifi-circle\"></div></div></div>"
+                                                  "<div class=\"time padtop\">%4</div></div></div><div class=\"translate\"></div></div></div>";
+
+    VNVoiceBlock voice;
+    voice.voiceTitle = QString("Voice %1").arg(++m_voiceIndex);
+    voice.voicePath = QString("/tmp/deepin-voice-note-benchmark/voice/%1.mp3").arg(m_voiceIndex);
+    voice.voiceSize = randomInt(1000, 600000);
+    voice.createTime = m_baseTime.addSecs(m_voiceIndex);
+    //约一半语音已转写
+    if (randomInt(0, 1)) {
+        voice.blockText = makeText(randomInt(10, 60));
+    }
+
+    QVariant voiceJson;
+    MetaDataParser metaParser;
+    metaParser.makeMetaData(&voice, voiceJson);
+
+    return QString(VOICE_HTML_FMT)
+        .arg(voiceJson.toString().toHtmlEscaped(),
+             voice.voiceTitle.toHtmlEscaped(),
+             voice.createTime.toString("yyyy-MM-dd HH:mm"),
+             Utils::formatMillisecond(voice.voiceSize));
+}
+
+/**
+ * @brief VNoteCorpusGenerator::searchKeywords
+ * @return 关键字列表
+ */
+const QStringList &VNoteCorpusGenerator::searchKeywords()
+{
+    static const QStringList keywords = {
+        "季度目标", "architecture", "周报汇总", "checkpoint", "报销流程",
+    };
+
+    return keywords;
+}
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef VNOTECORPUSGENERATOR_H
+#define VNOTECORPUSGENERATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+
+#include <random>
+
+//性能测试语料生成，相同种子生成相同的数据
+class VNoteCorpusGenerator
+{
+public:
+    explicit VNoteCorpusGenerator(quint32 seed);
+    //通过VNoteFolderOper/VNoteItemOper在当前数据库中生成记事本和笔记
+    bool generate(int folderCount, int noteCount);
+    //随机整数，包含min和max
+    int randomInt(int min, int max);
+    //生成wordCount个词组成的文本
+    QString makeText(int wordCount);
+    //生成一篇笔记的html，包含段落和语音块
+    QString makeNoteHtml();
+    //搜索关键字，保证在语料中出现
+    static const QStringList &searchKeywords();
+
+protected:
+    //生成语音块html，与编辑器的模板一致
+    QString makeVoiceHtml();
+
+    //每个事务插入的笔记数
+    static constexpr int NOTES_PER_TRANSACTION = 1000;
+
+    std::mt19937 m_random;
+    //笔记创建时间的起点，保证生成数据与运行时间无关
+    QDateTime m_baseTime;
+    int m_voiceIndex {0};
+};
+
+#endif // VNOTECORPUSGENERATOR_H
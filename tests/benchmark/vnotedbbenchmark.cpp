@@ -0,0 +1,656 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "vnotedbbenchmark.h"
+#include "common/vnotedatamanager.h"
+#include "common/vnoteforlder.h"
+#include "common/vnoteitem.h"
+#include "common/vnotesearchindex.h"
+#include "db/dbvisitor.h"
+#include "db/vnotedbmanager.h"
+#include "db/vnotefolderoper.h"
+#include "db/vnoteitemoper.h"
+#include "db/vnotesavequeue.h"
+#include "task/loadnoteitemsworker.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+
+#include <DLog>
+
+#include <algorithm>
+
+/**
+ * @brief VNoteDbBenchmark::VNoteDbBenchmark
+ * @param workDir 数据库文件存放目录
+ * @param seed 语料随机数种子
+ * @param folderCount 记事本数
+ * @param iterations 每项测试的执行次数
+ */
+VNoteDbBenchmark::VNoteDbBenchmark(const QString &workDir, quint32 seed, int folderCount, int iterations)
+    : m_workDir(workDir)
+    , m_folderCount(folderCount)
+    , m_iterations(iterations)
+    , m_generator(seed)
+{
+}
+
+/**
+ * @brief VNoteDbBenchmark::run
+ * 删除放在最后，其他测试项不改变笔记数量
+ * @param noteCount 笔记数
+ * @return true 成功
+ */
+bool VNoteDbBenchmark::run(int noteCount)
+{
+    if (!openDatabase(noteCount)) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!m_generator.generate(m_folderCount, noteCount)) {
+        return false;
+    }
+
+    addResult(noteCount, "generate", {timer.nsecsElapsed() / 1000000.0}, 0);
+
+    benchLoadFolders(noteCount);
+    benchLoadNotes(noteCount);
+    benchSearch(noteCount);
+    benchSearchIndex(noteCount);
+    benchCompression(noteCount);
+    benchSave(noteCount);
+    benchMove(noteCount);
+    benchDelete(noteCount);
+
+    return true;
+}
+
+/**
+ * @brief VNoteDbBenchmark::results
+ * @return 测试结果
+ */
+const QJsonArray &VNoteDbBenchmark::results() const
+{
+    return m_results;
+}
+
+/**
+ * @brief VNoteDbBenchmark::openDatabase
+ * 数据库路径由XDG_DATA_HOME决定，每种规模使用单独的目录
+ * @param noteCount 笔记数
+ * @return true 成功
+ */
+bool VNoteDbBenchmark::openDatabase(int noteCount)
+{
+    VNoteSaveQueue::instance()->flush();
+
+    QString dataHome = QDir(m_workDir).filePath(QString::number(noteCount));
+    QDir(dataHome).removeRecursively();
+    qputenv("XDG_DATA_HOME", dataHome.toLocal8Bit());
+    QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+
+    //笔记引用记事本，先释放笔记；之后的数据由生成语料时逐条添加
+    VNoteDataManager *dataManager = VNoteDataManager::instance();
+    QVector<VNoteItem *> oldNotes;
+
+    if (nullptr != dataManager->getAllNotesInFolder()) {
+        oldNotes = allNotes();
+    }
+
+    QScopedPointer<VNOTE_ALL_NOTES_MAP> oldNotesMap(dataManager->m_qspAllNotesMap.take());
+
+    if (!oldNotesMap.isNull()) {
+        for (auto folderNotes : oldNotesMap->notes) {
+            folderNotes->folderNotes.clear();
+            delete folderNotes;
+        }
+
+        oldNotesMap->notes.clear();
+        oldNotesMap->noteIndex.clear();
+    }
+
+    dataManager->updateSnapshotNotes([](QHash<qint64, QVector<VNoteItem *>> &folderNotes) {
+        folderNotes.clear();
+    });
+    //合并一个空批次即得到新的空数据
+    dataManager->onNotesBatchLoaded(new VNOTE_ALL_NOTES_MAP());
+
+    for (auto note : oldNotes) {
+        dataManager->releaseNote(note);
+    }
+
+    VNOTE_FOLDERS_MAP *foldersMap = new VNOTE_FOLDERS_MAP();
+    foldersMap->autoRelease = true;
+    dataManager->onFoldersLoaded(foldersMap);
+
+    VNoteSearchIndex::instance()->clear();
+
+    if (0 != VNoteDbManager::instance()->initVNoteDb(false)) {
+        qCritical() << "Open benchmark database failed:" << dataHome;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteDbBenchmark::allNotes
+ * @return 所有笔记
+ */
+QVector<VNoteItem *> VNoteDbBenchmark::allNotes()
+{
+    QVector<VNoteItem *> notes;
+    VNOTE_ALL_NOTES_MAP *notesMap = VNoteDataManager::instance()->getAllNotesInFolder();
+
+    for (auto folderNotes : notesMap->notes) {
+        for (auto note : folderNotes->folderNotes) {
+            notes.append(note);
+        }
+    }
+
+    std::sort(notes.begin(), notes.end(), [](const VNoteItem *left, const VNoteItem *right) {
+        return left->noteId < right->noteId;
+    });
+
+    return notes;
+}
+
+/**
+ * @brief VNoteDbBenchmark::pickNotes
+ * @param count 笔记数
+ * @return 选中的笔记
+ */
+QList<VNoteItem *> VNoteDbBenchmark::pickNotes(int count)
+{
+    QVector<VNoteItem *> notes = allNotes();
+    QList<VNoteItem *> pickedNotes;
+
+    for (int i = 0; i < count && i < notes.size(); i++) {
+        std::swap(notes[i], notes[m_generator.randomInt(i, notes.size() - 1)]);
+        pickedNotes.append(notes[i]);
+    }
+
+    return pickedNotes;
+}
+
+/**
+ * @brief VNoteDbBenchmark::measure
+ * @param noteCount 笔记数
+ * @param operation 测试项名称
+ * @param func 计时的操作，返回false计为失败
+ * @param setup 每次计时前的准备工作
+ */
+void VNoteDbBenchmark::measure(int noteCount, const QString &operation, const std::function<bool()> &func,
+                               const std::function<void()> &setup)
+{
+    QVector<double> elapsedMs;
+    int failures = 0;
+    QElapsedTimer timer;
+
+    for (int i = 0; i < m_iterations; i++) {
+        if (setup) {
+            setup();
+        }
+
+        timer.start();
+        bool isOK = func();
+        elapsedMs.append(timer.nsecsElapsed() / 1000000.0);
+
+        if (!isOK) {
+            failures++;
+        }
+    }
+
+    addResult(noteCount, operation, elapsedMs, failures);
+}
+
+/**
+ * @brief VNoteDbBenchmark::addResult
+ * @param noteCount 笔记数
+ * @param operation 测试项名称
+ * @param elapsedMs 每次的耗时
+ * @param failures 失败次数
+ */
+void VNoteDbBenchmark::addResult(int noteCount, const QString &operation, QVector<double> elapsedMs, int failures)
+{
+    if (elapsedMs.isEmpty()) {
+        return;
+    }
+
+    std::sort(elapsedMs.begin(), elapsedMs.end());
+
+    double total = 0;
+    for (auto it : elapsedMs) {
+        total += it;
+    }
+
+    QJsonObject result;
+    result.insert("notes", noteCount);
+    result.insert("folders", m_folderCount);
+    result.insert("operation", operation);
+    result.insert("iterations", elapsedMs.size());
+    result.insert("failures", failures);
+    result.insert("minMs", elapsedMs.first());
+    result.insert("medianMs", elapsedMs.at(elapsedMs.size() / 2));
+    result.insert("meanMs", total / elapsedMs.size());
+    result.insert("maxMs", elapsedMs.last());
+
+    m_results.append(result);
+
+    qWarning() << "Benchmark" << noteCount << operation << "median(ms):" << elapsedMs.at(elapsedMs.size() / 2);
+}
+
+/**
+ * @brief VNoteDbBenchmark::addSizeResult
+ * @param noteCount 笔记数
+ * @param operation 测试项名称
+ * @param bytes 文件大小
+ */
+void VNoteDbBenchmark::addSizeResult(int noteCount, const QString &operation, qint64 bytes)
+{
+    QJsonObject result;
+    result.insert("notes", noteCount);
+    result.insert("folders", m_folderCount);
+    result.insert("operation", operation);
+    result.insert("bytes", bytes);
+
+    m_results.append(result);
+
+    qWarning() << "Benchmark" << noteCount << operation << "bytes:" << bytes;
+}
+
+/**
+ * @brief VNoteDbBenchmark::benchLoadFolders
+ * @param noteCount 笔记数
+ */
+void VNoteDbBenchmark::benchLoadFolders(int noteCount)
+{
+    measure(noteCount, "load_folders", []() {
+        VNoteFolderOper folderOper;
+        QScopedPointer<VNOTE_FOLDERS_MAP> foldersMap(folderOper.loadVNoteFolders());
+        return !foldersMap->folders.isEmpty();
+    });
+}
+
+/**
+ * @brief VNoteDbBenchmark::benchLoadNotes
+ * 分别测试一次加载全部笔记和分批加载的首批笔记
+ * @param noteCount 笔记数
+ */
+void VNoteDbBenchmark::benchLoadNotes(int noteCount)
+{
+    measure(noteCount, "load_notes", []() {
+        VNoteItemOper noteOper;
+        QScopedPointer<VNOTE_ALL_NOTES_MAP> notesMap(noteOper.loadAllVNotes());
+        return !notesMap->notes.isEmpty();
+    });
+
+    measure(noteCount, "load_notes_first_batch", []() {
+        VNOTE_NOTES_RANGE range;
+        range.limit = LoadNoteItemsWorker::NOTES_BATCH_SIZE;
+
+        VNoteItemOper noteOper;
+        QScopedPointer<VNOTE_ALL_NOTES_MAP> notesMap(noteOper.loadVNotes(range));
+        return !notesMap->notes.isEmpty();
+    });
+}
+
+/**
+ * @brief VNoteDbBenchmark::benchSearch
+ * @param noteCount 笔记数
+ */
+void VNoteDbBenchmark::benchSearch(int noteCount)
+{
+    int keywordIndex = 0;
+
+    measure(noteCount, "search", [&keywordIndex]() {
+        const QStringList &keywords = VNoteCorpusGenerator::searchKeywords();
+        QSet<qint32> noteIds;
+
+        VNoteItemOper noteOper;
+        return noteOper.searchNotes(keywords.at(keywordIndex++ % keywords.size()), noteIds) && !noteIds.isEmpty();
+    });
+}
+
+/**
+ * @brief VNoteDbBenchmark::benchSearchIndex
+ * 内存索引与逐条匹配对比，索引建立只计一次；逐条匹配与原搜索流程一致，标题不匹配时加载正文
+ * @param noteCount 笔记数
+ */
+void VNoteDbBenchmark::benchSearchIndex(int noteCount)
+{
+    VNoteDbManager *dbManager = VNoteDbManager::instance();
+    QVector<VNoteItem *> notes = allNotes();
+    VNoteSearchIndex searchIndex;
+    int failures = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (auto note : notes) {
+        VNoteItem body;
+        body.noteId = note->noteId;
+
+        NoteBodyQryDbVisitor noteBodyVisitor(dbManager->getVNoteDb(), &body, &body);
+
+        if (!dbManager->queryData(&noteBodyVisitor)) {
+            failures++;
+            continue;
+        }
+
+        searchIndex.updateNote(note->noteId, note->noteTitle, body.searchText());
+    }
+
+    searchIndex.setReady(true);
+
+    addResult(noteCount, "search_index_build", {timer.nsecsElapsed() / 1000000.0}, failures);
+
+    int keywordIndex = 0;
+
+    measure(noteCount, "search_index", [&searchIndex, &keywordIndex]() {
+        const QStringList &keywords = VNoteCorpusGenerator::searchKeywords();
+        QSet<qint32> noteIds;
+
+        return searchIndex.search(keywords.at(keywordIndex++ % keywords.size()), noteIds) && !noteIds.isEmpty();
+    });
+
+    keywordIndex = 0;
+
+    measure(noteCount, "search_scan", [&notes, &keywordIndex]() {
+        const QStringList &keywords = VNoteCorpusGenerator::searchKeywords();
+        const QString &keyword = keywords.at(keywordIndex++ % keywords.size());
+        int matchedCount = 0;
+
+        for (auto note : notes) {
+            if (!note->noteTitle.contains(keyword, Qt::CaseInsensitive)) {
+                VNoteItemOper(note).loadNoteBody();
+            }
+
+            if (note->search(keyword)) {
+                matchedCount++;
+            }
+        }
+
+        return matchedCount > 0;
+    });
+}
+
+/**
+ * @brief VNoteDbBenchmark::benchSave
+ * 正文加载不计时，只计同步保存的耗时
+ * @param noteCount 笔记数
+ */
+void VNoteDbBenchmark::benchSave(int noteCount)
+{
+    VNoteItem *note = nullptr;
+
+    measure(
+        noteCount, "save", [&note]() {
+            VNoteItemOper noteOper(note);
+            return noteOper.updateNote();
+        },
+        [this, &note]() {
+            note = pickNotes(1).first();
+
+            VNoteItemOper noteOper(note);
+            noteOper.loadNoteBody();
+
+            note->htmlCode += QString("<p>%1</p>").arg(m_generator.makeText(20));
+        });
+}
+
+/**
+ * @brief VNoteDbBenchmark::benchMove
+ * 只修改数据库中的记事本id，每次计时前把上一批笔记移回原记事本
+ * @param noteCount 笔记数
+ */
+void VNoteDbBenchmark::benchMove(int noteCount)
+{
+    QList<VNoteItem *> movedNotes;
+    QVector<qint64> oldFolderIds;
+
+    auto restoreNotes = [&movedNotes, &oldFolderIds]() {
+        if (movedNotes.isEmpty()) {
+            return;
+        }
+
+        for (int i = 0; i < movedNotes.size(); i++) {
+            movedNotes[i]->folderId = oldFolderIds[i];
+        }
+
+        VNoteItemOper noteOper;
+        noteOper.updateFolderId(movedNotes);
+    };
+
+    measure(
+        noteCount, "move", [&movedNotes]() {
+            VNoteItemOper noteOper;
+            return noteOper.updateFolderId(movedNotes);
+        },
+        [this, &movedNotes, &oldFolderIds, &restoreNotes]() {
+            restoreNotes();
+
+            movedNotes = pickNotes(BATCH_NOTES);
+            oldFolderIds.clear();
+
+            qint64 targetFolderId = movedNotes.first()->folderId;
+
+            for (auto note : movedNotes) {
+                oldFolderIds.append(note->folderId);
+                note->folderId = targetFolderId;
+            }
+        });
+
+    restoreNotes();
+}
+
+/**
+ * @brief VNoteDbBenchmark::benchDelete
+ * @param noteCount 笔记数
+ */
+void VNoteDbBenchmark::benchDelete(int noteCount)
+{
+    QList<VNoteItem *> deleteNotes;
+
+    measure(
+        noteCount, "delete", [&deleteNotes]() {
+            VNoteItemOper noteOper;
+            return noteOper.deleteNotes(deleteNotes);
+        },
+        [this, &deleteNotes]() {
+            deleteNotes = pickNotes(BATCH_NOTES);
+        });
+}
+
+/**
+ * @brief VNoteDbBenchmark::copyDatabase
+ * 副本执行VACUUM后再统计大小，两种格式都不含空闲页
+ * @param fileName 副本文件名
+ * @param uncompress 是否改写为不压缩的元数据
+ * @return 副本路径，失败时为空
+ */
+QString VNoteDbBenchmark::copyDatabase(const QString &fileName, bool uncompress)
+{
+    //WAL中的数据写回主文件后才能直接复制
+    QSqlQuery checkpointQuery(VNoteDbManager::instance()->getVNoteDb());
+    if (!checkpointQuery.exec("PRAGMA wal_checkpoint(TRUNCATE);")) {
+        return QString();
+    }
+
+    QString dbPath = VNoteDbManager::instance()->databasePath();
+    QString copyPath = QFileInfo(dbPath).dir().filePath(fileName);
+
+    QFile::remove(copyPath);
+
+    if (!QFile::copy(dbPath, copyPath)) {
+        qCritical() << "Copy benchmark database failed:" << copyPath;
+        return QString();
+    }
+
+    bool isOK = true;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", fileName);
+        db.setDatabaseName(copyPath);
+
+        if (db.open()) {
+            QSqlQuery query(db);
+
+            if (uncompress) {
+                //按未压缩时的格式写回：普通笔记为文本，加密笔记为原文的base64
+                //与迁移一致，先取id再逐条改写，不在查询过程中修改同一张表
+                QString idsSql = QString("SELECT %1 FROM %2;")
+                                     .arg(DBNote::noteColumnsName[DBNote::note_id])
+                                     .arg(VNoteDbManager::NOTES_TABLE_NAME);
+                QString selectSql = QString("SELECT %1,%2 FROM %3 WHERE %4=?;")
+                                        .arg(DBNote::noteColumnsName[DBNote::meta_data])
+                                        .arg(DBNote::noteColumnsName[DBNote::encrypt])
+                                        .arg(VNoteDbManager::NOTES_TABLE_NAME)
+                                        .arg(DBNote::noteColumnsName[DBNote::note_id]);
+                QString updateSql = QString("UPDATE %1 SET %2=? WHERE %3=?;")
+                                        .arg(VNoteDbManager::NOTES_TABLE_NAME)
+                                        .arg(DBNote::noteColumnsName[DBNote::meta_data])
+                                        .arg(DBNote::noteColumnsName[DBNote::note_id]);
+
+                QVector<qint32> noteIds;
+                isOK = query.exec(idsSql);
+
+                while (isOK && query.next()) {
+                    noteIds.append(query.value(0).toInt());
+                }
+
+                query.finish();
+
+                QSqlQuery updateQuery(db);
+                isOK = isOK && db.transaction() && query.prepare(selectSql) && updateQuery.prepare(updateSql);
+
+                for (int j = 0; isOK && j < noteIds.size(); j++) {
+                    query.bindValue(0, noteIds.at(j));
+                    isOK = query.exec() && query.next();
+
+                    if (isOK) {
+                        bool encrypt = query.value(1).toInt();
+                        QString metaData = DbVisitor::unpackMetaData(query.value(0), encrypt);
+                        query.finish();
+
+                        updateQuery.bindValue(0, encrypt ? QVariant(QString(metaData.toLocal8Bit().toBase64())) : QVariant(metaData));
+                        updateQuery.bindValue(1, noteIds.at(j));
+                        isOK = updateQuery.exec();
+                    }
+                }
+
+                isOK = isOK && db.commit();
+            }
+
+            isOK = isOK && query.exec("PRAGMA journal_mode=DELETE;") && query.exec("VACUUM;");
+            query.finish();
+            db.close();
+        } else {
+            isOK = false;
+        }
+    }
+
+    QSqlDatabase::removeDatabase(fileName);
+
+    if (!isOK) {
+        qCritical() << "Prepare benchmark database failed:" << copyPath;
+        return QString();
+    }
+
+    return copyPath;
+}
+
+/**
+ * @brief VNoteDbBenchmark::benchCompression
+ * 两个副本在单独的连接上用相同的语句读取，计时包含解压
+ * @param noteCount 笔记数
+ */
+void VNoteDbBenchmark::benchCompression(int noteCount)
+{
+    QVector<qint32> bodyNoteIds;
+
+    for (auto note : pickNotes(BATCH_NOTES)) {
+        bodyNoteIds.append(note->noteId);
+    }
+
+    const QString scanSql = QString("SELECT %1,%2 FROM %3;")
+                                .arg(DBNote::noteColumnsName[DBNote::meta_data])
+                                .arg(DBNote::noteColumnsName[DBNote::encrypt])
+                                .arg(VNoteDbManager::NOTES_TABLE_NAME);
+    const QString bodySql = QString("SELECT %1,%2 FROM %3 WHERE %4=?;")
+                                .arg(DBNote::noteColumnsName[DBNote::meta_data])
+                                .arg(DBNote::noteColumnsName[DBNote::encrypt])
+                                .arg(VNoteDbManager::NOTES_TABLE_NAME)
+                                .arg(DBNote::noteColumnsName[DBNote::note_id]);
+
+    for (int i = 0; i < 2; i++) {
+        bool uncompress = (1 == i);
+        QString suffix = uncompress ? "uncompressed" : "compressed";
+        QString copyPath = copyDatabase(QString("benchmark_%1.db").arg(suffix), uncompress);
+
+        if (copyPath.isEmpty()) {
+            continue;
+        }
+
+        addSizeResult(noteCount, "db_size_" + suffix, QFileInfo(copyPath).size());
+
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", copyPath);
+            db.setDatabaseName(copyPath);
+            db.open();
+
+            measure(noteCount, "full_scan_" + suffix, [&db, &scanSql]() {
+                QSqlQuery query(db);
+                int bodyCount = 0;
+
+                if (!query.exec(scanSql)) {
+                    return false;
+                }
+
+                while (query.next()) {
+                    if (!DbVisitor::unpackMetaData(query.value(0), query.value(1).toInt()).isEmpty()) {
+                        bodyCount++;
+                    }
+                }
+
+                return bodyCount > 0;
+            });
+
+            measure(noteCount, "body_load_" + suffix, [&db, &bodySql, &bodyNoteIds]() {
+                QSqlQuery query(db);
+                int bodyCount = 0;
+
+                if (!query.prepare(bodySql)) {
+                    return false;
+                }
+
+                for (auto noteId : bodyNoteIds) {
+                    query.bindValue(0, noteId);
+
+                    if (query.exec() && query.next()
+                        && !DbVisitor::unpackMetaData(query.value(0), query.value(1).toInt()).isEmpty()) {
+                        bodyCount++;
+                    }
+                }
+
+                return bodyCount == bodyNoteIds.size();
+            });
+
+            db.close();
+        }
+
+        QSqlDatabase::removeDatabase(copyPath);
+        QFile::remove(copyPath);
+    }
+}
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef VNOTEDBBENCHMARK_H
+#define VNOTEDBBENCHMARK_H
+
+#include "vnotecorpusgenerator.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QVector>
+
+#include <functional>
+
+struct VNoteItem;
+
+//数据库性能测试，通过VNoteDbManager/VNoteItemOper的实际调用路径计时
+class VNoteDbBenchmark
+{
+public:
+    VNoteDbBenchmark(const QString &workDir, quint32 seed, int folderCount, int iterations);
+    //生成noteCount条笔记的数据库并执行所有测试项
+    bool run(int noteCount);
+    //所有测试结果
+    const QJsonArray &results() const;
+
+protected:
+    //切换到新的数据库文件并清空内存数据
+    bool openDatabase(int noteCount);
+    //内存中的所有笔记，按id排序，保证随机选取可复现
+    QVector<VNoteItem *> allNotes();
+    //随机选取count条不重复的笔记
+    QList<VNoteItem *> pickNotes(int count);
+    //执行iterations次，每次计时前调用setup(不计时)
+    void measure(int noteCount, const QString &operation, const std::function<bool()> &func,
+                 const std::function<void()> &setup = nullptr);
+    //记录一项结果，耗时单位毫秒
+    void addResult(int noteCount, const QString &operation, QVector<double> elapsedMs, int failures);
+    //记录一项数据库文件大小结果，单位字节
+    void addSizeResult(int noteCount, const QString &operation, qint64 bytes);
+
+    void benchLoadFolders(int noteCount);
+    void benchLoadNotes(int noteCount);
+    void benchSearch(int noteCount);
+    //内存搜索索引与逐条匹配对比
+    void benchSearchIndex(int noteCount);
+    void benchSave(int noteCount);
+    void benchMove(int noteCount);
+    void benchDelete(int noteCount);
+    //同一语料压缩与不压缩元数据的文件大小、全表扫描和正文加载对比
+    void benchCompression(int noteCount);
+    //复制当前数据库，uncompress为true时改写为不压缩的元数据，返回副本路径
+    QString copyDatabase(const QString &fileName, bool uncompress);
+
+    //移动和删除每次操作的笔记数
+    static constexpr int BATCH_NOTES = 100;
+
+    QString m_workDir;
+    int m_folderCount {0};
+    int m_iterations {0};
+    VNoteCorpusGenerator m_generator;
+    QJsonArray m_results;
+};
+
+#endif // VNOTEDBBENCHMARK_H
@@ -134,3 +134,18 @@ TEST_F(UT_Utils, UT_Utils_filteredFileName_001)
     EXPECT_EQ("qs", Utils::filteredFileName("\\q/s"));
     EXPECT_EQ("d saf  sa", Utils::filteredFileName("d saf / sa"));
 }
+
+TEST_F(UT_Utils, UT_Utils_contentHash_001)
+{
+    EXPECT_EQ(Utils::contentHash("<p>note</p>"), Utils::contentHash("<p>note</p>"));
+    EXPECT_NE(Utils::contentHash("<p>note</p>"), Utils::contentHash("<p>note.</p>"));
+    EXPECT_NE(0, Utils::contentHash(""));
+}
+
+TEST_F(UT_Utils, UT_Utils_htmlToPlainText_001)
+{
+    EXPECT_EQ("line1\nline2\n\n", Utils::htmlToPlainText("<p>line1</p><P class=\"a\">line2<BR/></P>"));
+    EXPECT_EQ("a<b> & \"c\" 'd' e", Utils::htmlToPlainText("a&lt;b&gt;&nbsp;&amp; &quot;c&quot; &#39;d&#x27;&#160;e"));
+    EXPECT_EQ("&unknown; & a<b", Utils::htmlToPlainText("&unknown; & a<b"));
+    EXPECT_EQ("text", Utils::htmlToPlainText("<style>p{}</style><!-- note --><script>var a = '<p>';</script>text"));
+}
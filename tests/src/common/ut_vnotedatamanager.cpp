@@ -10,6 +10,11 @@
 #include "vnoteitemoper.h"
 #include "vnotefolderoper.h"
 
+#include <QSignalSpy>
+#include <QCoreApplication>
+
+#include <thread>
+
 UT_VnoteDataManager::UT_VnoteDataManager()
 {
 }
@@ -83,15 +88,54 @@ TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_onFoldersLoaded_001)
     EXPECT_EQ(nullptr, vnotedatamanager.m_pForldesLoadThread);
 }
 
-TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_onAllNotesLoaded_001)
+TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_onNotesLoadFinished_001)
 {
+    //没有笔记时不会收到任何批次，加载结束时数据同样可用
     VNoteDataManager vnotedatamanager;
-    vnotedatamanager.m_qspAllNotesMap.reset(new VNOTE_ALL_NOTES_MAP);
-    VNOTE_ALL_NOTES_MAP *notes = vnotedatamanager.getAllNotesInFolder();
+    vnotedatamanager.m_fDataState = 1;
+    vnotedatamanager.onNotesLoadFinished();
+    EXPECT_EQ(nullptr, vnotedatamanager.m_pNotesLoadThread);
+    EXPECT_TRUE(vnotedatamanager.isAllDatasReady());
+    EXPECT_NE(nullptr, vnotedatamanager.getAllNotesInFolder());
+}
+
+TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_onNotesBatchLoaded_001)
+{
+    VNoteDataManager vnotedatamanager;
+    vnotedatamanager.m_fDataState = 1;
+
+    VNOTE_ALL_NOTES_MAP *batch = new VNOTE_ALL_NOTES_MAP;
+    batch->autoRelease = true;
     VNOTE_ITEMS_MAP *items = new VNOTE_ITEMS_MAP;
-    items->folderNotes.insert(0, new VNoteItem);
-    notes->notes.insert(0, items);
-    vnotedatamanager.onAllNotesLoaded(notes);
+    items->autoRelease = true;
+    VNoteItem *note = new VNoteItem;
+    note->noteId = 1;
+    note->folderId = 1;
+    items->folderNotes.insert(note->noteId, note);
+    batch->notes.insert(1, items);
+    vnotedatamanager.onNotesBatchLoaded(batch);
+    EXPECT_TRUE(vnotedatamanager.isAllDatasReady());
+    EXPECT_EQ(note, vnotedatamanager.getNote(1, 1));
+
+    //已存在的笔记保留内存中的对象
+    batch = new VNOTE_ALL_NOTES_MAP;
+    batch->autoRelease = true;
+    items = new VNOTE_ITEMS_MAP;
+    items->autoRelease = true;
+    VNoteItem *dupNote = new VNoteItem;
+    dupNote->noteId = 1;
+    dupNote->folderId = 1;
+    VNoteItem *newNote = new VNoteItem;
+    newNote->noteId = 2;
+    newNote->folderId = 1;
+    items->folderNotes.insert(dupNote->noteId, dupNote);
+    items->folderNotes.insert(newNote->noteId, newNote);
+    batch->notes.insert(1, items);
+    vnotedatamanager.onNotesBatchLoaded(batch);
+    EXPECT_EQ(note, vnotedatamanager.getNote(1, 1));
+    EXPECT_EQ(2, vnotedatamanager.folderNotesCount(1));
+
+    vnotedatamanager.onNotesLoadFinished();
     EXPECT_EQ(nullptr, vnotedatamanager.m_pNotesLoadThread);
 }
 
@@ -100,3 +144,238 @@ TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_reqNoteDefIcons_001)
     VNoteDataManager vnotedatamanager;
     vnotedatamanager.reqNoteDefIcons();
 }
+
+TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_notesSnapshot_001)
+{
+    VNoteDataManager vnotedatamanager;
+
+    VNOTE_ALL_NOTES_MAP *notes = new VNOTE_ALL_NOTES_MAP;
+    notes->autoRelease = true;
+    VNOTE_ITEMS_MAP *items = new VNOTE_ITEMS_MAP;
+    items->autoRelease = true;
+    VNoteItem *note = new VNoteItem;
+    note->noteId = 1;
+    note->folderId = 1;
+    items->folderNotes.insert(note->noteId, note);
+    notes->notes.insert(1, items);
+    vnotedatamanager.onNotesBatchLoaded(notes);
+
+    VNOTE_NOTES_SNAPSHOT snapshot = vnotedatamanager.notesSnapshot();
+    ASSERT_FALSE(snapshot.isNull());
+    EXPECT_EQ(1, snapshot->folderNotes.value(1).size());
+    EXPECT_EQ(snapshot, vnotedatamanager.notesSnapshot());
+
+    //删除后旧快照中的笔记仍然有效
+    vnotedatamanager.releaseNote(vnotedatamanager.delNote(1, 1));
+    EXPECT_EQ(1, snapshot->folderNotes.value(1).size());
+    EXPECT_EQ(1, snapshot->folderNotes.value(1).first()->noteId);
+
+    VNOTE_NOTES_SNAPSHOT newSnapshot = vnotedatamanager.notesSnapshot();
+    EXPECT_NE(snapshot, newSnapshot);
+    EXPECT_TRUE(newSnapshot->folderNotes.value(1).isEmpty());
+}
+
+TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_getNote_001)
+{
+    VNoteDataManager vnotedatamanager;
+
+    VNOTE_ALL_NOTES_MAP *notes = new VNOTE_ALL_NOTES_MAP;
+    notes->autoRelease = true;
+    VNOTE_ITEMS_MAP *srcItems = new VNOTE_ITEMS_MAP;
+    srcItems->autoRelease = true;
+    VNOTE_ITEMS_MAP *destItems = new VNOTE_ITEMS_MAP;
+    destItems->autoRelease = true;
+    VNoteItem *note = new VNoteItem;
+    note->noteId = 5;
+    note->folderId = 1;
+    srcItems->folderNotes.insert(note->noteId, note);
+    notes->notes.insert(1, srcItems);
+    notes->notes.insert(2, destItems);
+    vnotedatamanager.onNotesBatchLoaded(notes);
+    EXPECT_EQ(note, vnotedatamanager.getNote(5));
+    EXPECT_EQ(note, vnotedatamanager.getNote(1, 5));
+    EXPECT_EQ(nullptr, vnotedatamanager.getNote(2, 5));
+
+    //移动记事本后索引仍然有效
+    srcItems->folderNotes.remove(note->noteId);
+    note->folderId = 2;
+    destItems->folderNotes.insert(note->noteId, note);
+    EXPECT_EQ(note, vnotedatamanager.getNote(5));
+    EXPECT_EQ(note, vnotedatamanager.getNote(2, 5));
+
+    vnotedatamanager.releaseNote(vnotedatamanager.delNote(2, 5));
+    EXPECT_EQ(nullptr, vnotedatamanager.getNote(5));
+}
+
+TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_touchNoteBody_001)
+{
+    VNoteDataManager vnotedatamanager;
+
+    VNOTE_ALL_NOTES_MAP *notes = new VNOTE_ALL_NOTES_MAP;
+    notes->autoRelease = true;
+    VNOTE_ITEMS_MAP *items = new VNOTE_ITEMS_MAP;
+    items->autoRelease = true;
+    VNoteItem *note1 = new VNoteItem;
+    note1->noteId = 1;
+    note1->folderId = 1;
+    note1->htmlCode = QString(100, 'a');
+    VNoteItem *note2 = new VNoteItem;
+    note2->noteId = 2;
+    note2->folderId = 1;
+    note2->htmlCode = QString(100, 'b');
+    items->folderNotes.insert(note1->noteId, note1);
+    items->folderNotes.insert(note2->noteId, note2);
+    notes->notes.insert(1, items);
+    vnotedatamanager.onNotesBatchLoaded(notes);
+
+    //只能容纳一条笔记的正文
+    vnotedatamanager.setBodyCacheBudget(note1->bodySize());
+    vnotedatamanager.touchNoteBody(note1, false);
+    vnotedatamanager.touchNoteBody(note2, true);
+    EXPECT_FALSE(note1->bodyLoaded);
+    EXPECT_TRUE(note1->htmlCode.isEmpty());
+    EXPECT_TRUE(note2->bodyLoaded);
+
+    VNOTE_BODY_CACHE_STATS stats = vnotedatamanager.bodyCacheStats();
+    EXPECT_EQ(1, stats.hits);
+    EXPECT_EQ(1, stats.misses);
+    EXPECT_EQ(1, stats.evictions);
+    EXPECT_EQ(1, stats.notesResident);
+    EXPECT_EQ(note2->bodySize(), stats.bytesResident);
+
+    //固定的正文不被释放
+    note1->htmlCode = QString(100, 'a');
+    note1->bodyLoaded = true;
+    vnotedatamanager.pinNoteBody(note2);
+    vnotedatamanager.touchNoteBody(note1, false);
+    EXPECT_TRUE(note2->bodyLoaded);
+    vnotedatamanager.unpinNoteBody(note2);
+
+    //临时对象不计入缓存
+    VNoteItem tmpNote;
+    tmpNote.noteId = 1;
+    vnotedatamanager.touchNoteBody(&tmpNote, true);
+    EXPECT_EQ(2, vnotedatamanager.bodyCacheStats().notesResident);
+}
+
+TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_touchNoteBody_002)
+{
+    VNoteDataManager vnotedatamanager;
+
+    VNOTE_ALL_NOTES_MAP *notes = new VNOTE_ALL_NOTES_MAP;
+    notes->autoRelease = true;
+    VNOTE_ITEMS_MAP *items = new VNOTE_ITEMS_MAP;
+    items->autoRelease = true;
+    VNoteItem *note1 = new VNoteItem;
+    note1->noteId = 1;
+    note1->folderId = 1;
+    note1->htmlCode = QString(100, 'a');
+    VNoteItem *note2 = new VNoteItem;
+    note2->noteId = 2;
+    note2->folderId = 1;
+    note2->htmlCode = QString(100, 'b');
+    items->folderNotes.insert(note1->noteId, note1);
+    items->folderNotes.insert(note2->noteId, note2);
+    notes->notes.insert(1, items);
+    vnotedatamanager.onNotesBatchLoaded(notes);
+
+    vnotedatamanager.setBodyCacheBudget(note1->bodySize());
+    vnotedatamanager.touchNoteBody(note1, false);
+
+    //后台线程访问正文时不释放，排队到界面线程
+    std::thread worker([&vnotedatamanager, note2]() {
+        vnotedatamanager.touchNoteBody(note2, false);
+    });
+    worker.join();
+    EXPECT_TRUE(note1->bodyLoaded);
+    EXPECT_TRUE(vnotedatamanager.m_evictionScheduled);
+
+    QCoreApplication::sendPostedEvents(&vnotedatamanager, QEvent::MetaCall);
+    EXPECT_FALSE(vnotedatamanager.m_evictionScheduled);
+    EXPECT_FALSE(note1->bodyLoaded);
+    EXPECT_EQ(1, vnotedatamanager.bodyCacheStats().notesResident);
+}
+
+TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_moveNotes_001)
+{
+    VNoteDataManager vnotedatamanager;
+
+    VNOTE_FOLDERS_MAP *folders = new VNOTE_FOLDERS_MAP;
+    folders->autoRelease = true;
+    VNoteFolder *srcFolder = new VNoteFolder;
+    srcFolder->id = 1;
+    VNoteFolder *destFolder = new VNoteFolder;
+    destFolder->id = 2;
+    folders->folders.insert(srcFolder->id, srcFolder);
+    folders->folders.insert(destFolder->id, destFolder);
+    vnotedatamanager.onFoldersLoaded(folders);
+
+    VNOTE_ALL_NOTES_MAP *notes = new VNOTE_ALL_NOTES_MAP;
+    notes->autoRelease = true;
+    VNOTE_ITEMS_MAP *items = new VNOTE_ITEMS_MAP;
+    items->autoRelease = true;
+    VNoteItem *oldNote = new VNoteItem;
+    oldNote->noteId = 1;
+    oldNote->folderId = 1;
+    oldNote->modifyTime = QDateTime(QDate(2022, 1, 1), QTime(8, 0));
+    VNoteItem *newNote = new VNoteItem;
+    newNote->noteId = 2;
+    newNote->folderId = 1;
+    newNote->modifyTime = QDateTime(QDate(2023, 1, 1), QTime(8, 0));
+    items->folderNotes.insert(oldNote->noteId, oldNote);
+    items->folderNotes.insert(newNote->noteId, newNote);
+    notes->notes.insert(1, items);
+    vnotedatamanager.onNotesBatchLoaded(notes);
+    EXPECT_EQ(2, srcFolder->getNotesCount());
+    EXPECT_EQ(newNote->modifyTime, srcFolder->lastNoteModifyTime);
+
+    EXPECT_TRUE(vnotedatamanager.moveNotes({newNote}, destFolder->id));
+    EXPECT_EQ(destFolder->id, newNote->folderId);
+    EXPECT_EQ(1, srcFolder->getNotesCount());
+    EXPECT_EQ(oldNote->modifyTime, srcFolder->lastNoteModifyTime);
+    EXPECT_EQ(1, destFolder->getNotesCount());
+    EXPECT_EQ(newNote->modifyTime, destFolder->lastNoteModifyTime);
+    EXPECT_EQ(newNote, vnotedatamanager.getNote(destFolder->id, newNote->noteId));
+
+    vnotedatamanager.releaseNote(vnotedatamanager.delNote(srcFolder->id, oldNote->noteId));
+    EXPECT_EQ(0, srcFolder->getNotesCount());
+    EXPECT_FALSE(srcFolder->lastNoteModifyTime.isValid());
+}
+
+TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_noteChanged_001)
+{
+    VNoteDataManager vnotedatamanager;
+    QSignalSpy addedSpy(&vnotedatamanager, &VNoteDataManager::noteAdded);
+    QSignalSpy updatedSpy(&vnotedatamanager, &VNoteDataManager::noteUpdated);
+    QSignalSpy movedSpy(&vnotedatamanager, &VNoteDataManager::noteMoved);
+    QSignalSpy deletedSpy(&vnotedatamanager, &VNoteDataManager::noteDeleted);
+    QSignalSpy pinnedSpy(&vnotedatamanager, &VNoteDataManager::notePinned);
+
+    VNOTE_ALL_NOTES_MAP *notes = new VNOTE_ALL_NOTES_MAP;
+    notes->autoRelease = true;
+    vnotedatamanager.onNotesBatchLoaded(notes);
+
+    VNoteItem *note = new VNoteItem;
+    note->noteId = 1;
+    note->folderId = 1;
+    vnotedatamanager.addNote(note);
+    ASSERT_EQ(1, addedSpy.count());
+    EXPECT_EQ(note->noteId, addedSpy.first().at(1).toInt());
+
+    vnotedatamanager.notifyNoteUpdated(note, VNoteDataManager::NoteTitleField);
+    ASSERT_EQ(1, updatedSpy.count());
+    EXPECT_EQ(static_cast<int>(VNoteDataManager::NoteTitleField), updatedSpy.first().at(2).toInt());
+
+    note->isTop = 1;
+    vnotedatamanager.notifyNotePinned(note);
+    ASSERT_EQ(1, pinnedSpy.count());
+    EXPECT_TRUE(pinnedSpy.first().at(2).toBool());
+
+    vnotedatamanager.moveNotes({note}, 2);
+    ASSERT_EQ(1, movedSpy.count());
+    EXPECT_EQ(1, movedSpy.first().at(1).toLongLong());
+    EXPECT_EQ(2, movedSpy.first().at(2).toLongLong());
+
+    vnotedatamanager.releaseNote(vnotedatamanager.delNote(2, note->noteId));
+    EXPECT_EQ(1, deletedSpy.count());
+}
@@ -6,6 +6,7 @@
 #include "ut_vnoteitem.h"
 #include "vnoteitem.h"
 #include "vnoteforlder.h"
+#include "vnoteitempool.h"
 
 UT_VnoteItem::UT_VnoteItem()
 {
@@ -36,6 +37,28 @@ TEST_F(UT_VnoteItem, UT_VnoteItem_search_001)
     EXPECT_TRUE(vnoteitem.search("1234")) << "search htmlcode";
 }
 
+TEST_F(UT_VnoteItem, UT_VnoteItem_updatePlainText_001)
+{
+    VNoteItem vnoteitem;
+    vnoteitem.htmlCode = "<p>1234</p>";
+    vnoteitem.updatePlainText();
+    EXPECT_EQ("1234\n", vnoteitem.m_plainText);
+    EXPECT_EQ("1234\n", vnoteitem.searchText());
+
+    VNoteItem snapshot;
+    snapshot.htmlCode = vnoteitem.htmlCode;
+    snapshot.copyPlainText(vnoteitem);
+    EXPECT_EQ("1234\n", snapshot.searchText());
+
+    vnoteitem.htmlCode = "<p>5678</p>";
+    EXPECT_EQ("5678\n", vnoteitem.searchText()) << "stale cache";
+    EXPECT_TRUE(vnoteitem.search("5678"));
+    EXPECT_EQ("5678\n", vnoteitem.m_plainText);
+
+    vnoteitem.releaseBody();
+    EXPECT_TRUE(vnoteitem.m_plainText.isEmpty());
+}
+
 TEST_F(UT_VnoteItem, UT_VnoteItem_folder_001)
 {
     VNoteItem vnoteitem;
@@ -170,3 +193,53 @@ TEST_F(UT_VnoteItem, UT_VnoteItem_operator_001)
     VNoteItem vnoteitem;
     qDebug() << "" << vnoteitem;
 }
+
+TEST_F(UT_VnoteItem, UT_VnoteItem_operatorNew_001)
+{
+    int usedCount = VNoteItemPool::usedCount();
+
+    //先占满已有块的空闲位置，之后的对象都在新块中
+    QVector<VNoteItem *> fillers;
+    while (nullptr != VNoteItemPool::s_availableHead) {
+        fillers.append(new VNoteItem);
+    }
+
+    int chunkCount = VNoteItemPool::chunkCount();
+    QVector<VNoteItem *> notes;
+    for (int i = 0; i < VNoteItemPool::ITEMS_PER_CHUNK * 2; i++) {
+        notes.append(new VNoteItem);
+    }
+    EXPECT_EQ(chunkCount + 2, VNoteItemPool::chunkCount());
+    EXPECT_EQ(usedCount + fillers.size() + notes.size(), VNoteItemPool::usedCount());
+
+    //块内对象全部释放后归还整块，保留一个空块备用
+    qDeleteAll(notes);
+    EXPECT_EQ(chunkCount + 1, VNoteItemPool::chunkCount());
+
+    qDeleteAll(fillers);
+    EXPECT_EQ(usedCount, VNoteItemPool::usedCount());
+    EXPECT_LT(0, VNoteItemPool::chunkCount());
+}
+
+TEST_F(UT_VnoteItem, UT_VnoteItem_operatorNew_002)
+{
+    //占满所有块，包括备用块
+    QVector<VNoteItem *> fillers;
+    while (nullptr != VNoteItemPool::s_availableHead) {
+        fillers.append(new VNoteItem);
+    }
+
+    int chunkCount = VNoteItemPool::chunkCount();
+
+    //在块边界反复创建、释放不重复申请块
+    for (int i = 0; i < 3; i++) {
+        VNoteItem *note = new VNoteItem;
+        EXPECT_EQ(chunkCount + 1, VNoteItemPool::chunkCount());
+        delete note;
+        EXPECT_EQ(chunkCount + 1, VNoteItemPool::chunkCount());
+        EXPECT_EQ(1, VNoteItemPool::s_emptyChunkCount);
+    }
+
+    qDeleteAll(fillers);
+    EXPECT_GE(1, VNoteItemPool::s_emptyChunkCount);
+}
@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_vnotesearchindex.h"
+#include "vnotesearchindex.h"
+
+UT_VNoteSearchIndex::UT_VNoteSearchIndex()
+{
+}
+
+TEST_F(UT_VNoteSearchIndex, UT_VNoteSearchIndex_tokenize_001)
+{
+    QStringList terms = VNoteSearchIndex::tokenize("Release v2, 项目进度!");
+    EXPECT_TRUE(terms.contains("release"));
+    EXPECT_TRUE(terms.contains("v2"));
+    EXPECT_TRUE(terms.contains("项"));
+    EXPECT_TRUE(terms.contains("项目"));
+    EXPECT_TRUE(terms.contains("目进"));
+    EXPECT_TRUE(terms.contains("进度"));
+    EXPECT_FALSE(terms.contains("项目进度"));
+    EXPECT_TRUE(VNoteSearchIndex::tokenize(",.!").isEmpty());
+}
+
+TEST_F(UT_VNoteSearchIndex, UT_VNoteSearchIndex_search_001)
+{
+    VNoteSearchIndex searchIndex;
+    QSet<qint32> noteIds;
+
+    searchIndex.updateNote(1, "Weekly report", "项目进度 database review");
+    searchIndex.updateNote(2, "Shopping", "budget 清单");
+    EXPECT_FALSE(searchIndex.search("report", noteIds));
+
+    searchIndex.setReady(true);
+    EXPECT_TRUE(searchIndex.search("rep", noteIds));
+    EXPECT_EQ(QSet<qint32>({1}), noteIds);
+
+    //词中间的子串同样命中
+    noteIds.clear();
+    EXPECT_TRUE(searchIndex.search("EPOR", noteIds));
+    EXPECT_EQ(QSet<qint32>({1}), noteIds);
+
+    noteIds.clear();
+    EXPECT_TRUE(searchIndex.search("进度 data", noteIds));
+    EXPECT_EQ(QSet<qint32>({1}), noteIds);
+
+    noteIds.clear();
+    EXPECT_TRUE(searchIndex.search("单", noteIds));
+    EXPECT_EQ(QSet<qint32>({2}), noteIds);
+
+    noteIds.clear();
+    EXPECT_TRUE(searchIndex.search("report budget", noteIds));
+    EXPECT_TRUE(noteIds.isEmpty());
+    EXPECT_FALSE(searchIndex.search("#", noteIds));
+}
+
+TEST_F(UT_VNoteSearchIndex, UT_VNoteSearchIndex_updateNote_001)
+{
+    VNoteSearchIndex searchIndex;
+    QSet<qint32> noteIds;
+
+    //建立索引前只更新标题的笔记不加入索引，后台加入时使用新标题
+    searchIndex.updateTitle(1, "draft");
+    EXPECT_FALSE(searchIndex.contains(1));
+
+    searchIndex.updateNote(1, "untitled", "meeting", false);
+    searchIndex.updateNote(1, "old", "old", false);
+    searchIndex.setReady(true);
+    EXPECT_TRUE(searchIndex.search("draft meeting", noteIds));
+    EXPECT_TRUE(noteIds.contains(1));
+
+    searchIndex.updateTitle(1, "summary");
+    noteIds.clear();
+    EXPECT_TRUE(searchIndex.search("draft", noteIds));
+    EXPECT_TRUE(noteIds.isEmpty());
+    EXPECT_TRUE(searchIndex.search("summary meeting", noteIds));
+    EXPECT_TRUE(noteIds.contains(1));
+
+    searchIndex.removeNote(1);
+    EXPECT_FALSE(searchIndex.contains(1));
+    EXPECT_EQ(0, searchIndex.termCount());
+}
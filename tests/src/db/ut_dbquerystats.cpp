@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_dbquerystats.h"
+#include "db/dbquerystats.h"
+#include "db/dbvisitor.h"
+#include "db/vnotedbmanager.h"
+
+UT_DbQueryStats::UT_DbQueryStats()
+{
+}
+
+TEST_F(UT_DbQueryStats, UT_DbQueryStats_bucketIndex_001)
+{
+    EXPECT_EQ(0, DbQueryStats::bucketIndex(999));
+    EXPECT_EQ(1, DbQueryStats::bucketIndex(1000));
+    EXPECT_EQ(11, DbQueryStats::bucketIndex(1500000));
+    EXPECT_EQ(DbQueryStats::BUCKET_COUNT - 1, DbQueryStats::bucketIndex(3600000000000LL));
+}
+
+TEST_F(UT_DbQueryStats, UT_DbQueryStats_record_001)
+{
+    DbQueryStats *stats = DbQueryStats::instance();
+    stats->reset();
+
+    qint64 id = 0;
+    MaxIdFolderDbVisitor visitor(VNoteDbManager::instance()->getVNoteDb(), nullptr, &id);
+    EXPECT_TRUE(VNoteDbManager::instance()->queryData(&visitor));
+
+    int threshold = stats->slowQueryThreshold();
+    stats->setSlowQueryThreshold(1);
+    stats->checkSlowQuery(&visitor, "SELECT 1", 2000000);
+    stats->setSlowQueryThreshold(threshold);
+
+    QString dump = stats->dump();
+    EXPECT_TRUE(dump.contains("MaxIdFolderDbVisitor slow:1"));
+    EXPECT_TRUE(dump.contains("prepare count:1"));
+    EXPECT_TRUE(dump.contains("exec count:1"));
+    EXPECT_TRUE(dump.contains("visitorData count:1"));
+
+    stats->reset();
+    EXPECT_FALSE(stats->dump().contains("MaxIdFolderDbVisitor"));
+}
@@ -8,6 +8,7 @@
 #include "vnotedbmanager.h"
 #include "common/vnoteitem.h"
 #include "common/vnoteforlder.h"
+#include "globaldef.h"
 
 UT_DbVisitor::UT_DbVisitor()
 {
@@ -185,3 +186,158 @@ TEST_F(UT_DbVisitor, UT_DbVisitor_DelNoteDbVisitor_002)
     delete note;
     delete dbvisitor;
 }
+
+TEST_F(UT_DbVisitor, UT_DbVisitor_dbvBindValues_001)
+{
+    VNoteFolder *folder = new VNoteFolder;
+    VNoteItem *note = new VNoteItem();
+    note->setFolder(folder);
+    note->noteTitle = "it's a note";
+    DbVisitor *dbvisitor;
+    QSqlDatabase db = VNoteDbManager::instance()->getVNoteDb();
+    dbvisitor = new RenameNoteDbVisitor(db, nullptr, nullptr);
+    dbvisitor->param.newNote = note;
+    EXPECT_TRUE(dbvisitor->prepareSqls());
+    EXPECT_EQ(dbvisitor->dbvSqls().size(), dbvisitor->dbvBindValues().size());
+    EXPECT_FALSE(dbvisitor->dbvSqls().first().contains(note->noteTitle));
+    EXPECT_EQ(note->noteTitle, dbvisitor->dbvBindValues().first().first().toString());
+    delete folder;
+    delete note;
+    delete dbvisitor;
+}
+
+TEST_F(UT_DbVisitor, UT_DbVisitor_DelNotesDbVisitor_001)
+{
+    VNoteFolder *folder = new VNoteFolder;
+    QList<VNoteItem *> notes;
+    for (int i = 0; i < DbVisitor::MAX_IN_IDS + 3; i++) {
+        VNoteItem *note = new VNoteItem();
+        note->noteId = i;
+        note->setFolder(folder);
+        notes.append(note);
+    }
+    DbVisitor *dbvisitor;
+    QSqlDatabase db = VNoteDbManager::instance()->getVNoteDb();
+    dbvisitor = new DelNotesDbVisitor(db, nullptr, nullptr);
+    EXPECT_FALSE(dbvisitor->prepareSqls());
+    dbvisitor->param.notes = &notes;
+    EXPECT_TRUE(dbvisitor->prepareSqls());
+    //两批id，第二批补齐到4个
+    EXPECT_EQ(DbVisitor::MAX_IN_IDS, dbvisitor->dbvBindValues().at(0).size());
+    EXPECT_EQ(4, dbvisitor->dbvBindValues().at(1).size());
+    EXPECT_EQ(4, dbvisitor->dbvSqls().at(1).count('?'));
+    EXPECT_EQ(1, dbvisitor->dbvSqls().last().count("UPDATE"));
+    qDeleteAll(notes);
+    delete folder;
+    delete dbvisitor;
+}
+
+TEST_F(UT_DbVisitor, UT_DbVisitor_UpdateNotesFolderIdDbVisitor_001)
+{
+    VNoteItem *note = new VNoteItem();
+    note->folderId = 2;
+    note->noteId = 3;
+    QList<VNoteItem *> notes {note};
+    DbVisitor *dbvisitor;
+    QSqlDatabase db = VNoteDbManager::instance()->getVNoteDb();
+    dbvisitor = new UpdateNotesFolderIdDbVisitor(db, &notes, nullptr);
+    EXPECT_TRUE(dbvisitor->prepareSqls());
+    //笔记更新和目标记事本的修改时间各一条
+    EXPECT_EQ(2, dbvisitor->dbvSqls().size());
+    EXPECT_EQ(QVariantList({2, 3}), dbvisitor->dbvBindValues().first());
+    EXPECT_EQ(2, dbvisitor->dbvBindValues().last().last().toLongLong());
+    delete note;
+    delete dbvisitor;
+}
+
+TEST_F(UT_DbVisitor, UT_DbVisitor_UpdateNotesTopDbVisitor_001)
+{
+    VNoteItem *note = new VNoteItem();
+    note->isTop = 1;
+    QList<VNoteItem *> notes {note};
+    DbVisitor *dbvisitor;
+    QSqlDatabase db = VNoteDbManager::instance()->getVNoteDb();
+    dbvisitor = new UpdateNotesTopDbVisitor(db, nullptr, nullptr);
+    EXPECT_FALSE(dbvisitor->prepareSqls());
+    dbvisitor->param.notes = &notes;
+    EXPECT_TRUE(dbvisitor->prepareSqls());
+    EXPECT_EQ(1, dbvisitor->dbvBindValues().first().first().toInt());
+    delete note;
+    delete dbvisitor;
+}
+
+TEST_F(UT_DbVisitor, UT_DbVisitor_packMetaData_001)
+{
+    QString smallMeta("{\"htmlCode\":\"<p>note</p>\"}");
+    EXPECT_EQ(QVariant::String, DbVisitor::packMetaData(smallMeta, false).type());
+    EXPECT_EQ(smallMeta, DbVisitor::unpackMetaData(DbVisitor::packMetaData(smallMeta, false), false));
+    EXPECT_EQ(smallMeta, DbVisitor::unpackMetaData(DbVisitor::packMetaData(smallMeta, true), true));
+
+    QString largeMeta = QString("{\"htmlCode\":\"%1\"}").arg(QString("<p>voice note 语音笔记</p>").repeated(500));
+    QVariant packed = DbVisitor::packMetaData(largeMeta, false);
+    EXPECT_EQ(QVariant::ByteArray, packed.type());
+    EXPECT_LT(packed.toByteArray().size(), largeMeta.toUtf8().size() / 4);
+    EXPECT_EQ(largeMeta, DbVisitor::unpackMetaData(packed, false));
+
+    //加密数据压缩后再base64，仍小于原数据
+    QVariant encrypted = DbVisitor::packMetaData(largeMeta, true);
+    EXPECT_EQ(QVariant::String, encrypted.type());
+    EXPECT_LT(encrypted.toString().size(), largeMeta.size());
+    EXPECT_EQ(largeMeta, DbVisitor::unpackMetaData(encrypted, true));
+}
+
+TEST_F(UT_DbVisitor, UT_DbVisitor_toDbTime_001)
+{
+    QDateTime time = QDateTime::currentDateTime();
+    QVariant stored = DbVisitor::toDbTime(time);
+    EXPECT_EQ(time, DbVisitor::fromDbTime(stored));
+    EXPECT_EQ(0, DbVisitor::toDbTime(QDateTime()));
+    EXPECT_FALSE(DbVisitor::fromDbTime(QVariant()).isValid());
+
+    //第4版表结构之前的文本格式
+    QString timeStr = time.toString(VNOTE_TIME_FMT);
+    EXPECT_EQ(QDateTime::fromString(timeStr, VNOTE_TIME_FMT), DbVisitor::fromDbTime(timeStr));
+}
+
+TEST_F(UT_DbVisitor, UT_DbVisitor_SearchNoteDbVisitor_001)
+{
+    QSet<qint32> noteIds;
+    QString keyword;
+    DbVisitor *dbvisitor;
+    QSqlDatabase db = VNoteDbManager::instance()->getVNoteDb();
+    dbvisitor = new SearchNoteDbVisitor(db, &keyword, &noteIds);
+    EXPECT_FALSE(dbvisitor->prepareSqls());
+    keyword = "a_";
+    EXPECT_TRUE(dbvisitor->prepareSqls());
+    EXPECT_EQ(QString("%a\\_%"), dbvisitor->dbvBindValues().last().first().toString());
+    //非ASCII字母的大小写组合都参与匹配
+    keyword = QString::fromUtf8("é");
+    EXPECT_TRUE(dbvisitor->prepareSqls());
+    EXPECT_EQ(4, dbvisitor->dbvBindValues().last().size());
+    EXPECT_TRUE(dbvisitor->dbvBindValues().last().contains(QString::fromUtf8("%É%")));
+    //按字符计数，两个辅助平面字符不使用trigram索引
+    keyword = QString::fromUtf8("\xF0\x9F\x98\x80\xF0\x9F\x98\x80");
+    EXPECT_TRUE(dbvisitor->prepareSqls());
+    EXPECT_EQ(QString("%%1%").arg(keyword), dbvisitor->dbvBindValues().last().first().toString());
+    keyword = "te\"st";
+    EXPECT_TRUE(dbvisitor->prepareSqls());
+    EXPECT_EQ(QString("\"te\"\"st\""), dbvisitor->dbvBindValues().last().first().toString());
+    EXPECT_TRUE(dbvisitor->visitorData());
+    delete dbvisitor;
+}
+
+TEST_F(UT_DbVisitor, UT_DbVisitor_NoteBodyQryDbVisitor_001)
+{
+    VNoteItem *note = new VNoteItem();
+    note->noteId = 1;
+    DbVisitor *dbvisitor;
+    QSqlDatabase db = VNoteDbManager::instance()->getVNoteDb();
+    dbvisitor = new NoteBodyQryDbVisitor(db, nullptr, note);
+    EXPECT_FALSE(dbvisitor->prepareSqls());
+    dbvisitor->param.newNote = note;
+    EXPECT_TRUE(dbvisitor->prepareSqls());
+    EXPECT_EQ(note->noteId, dbvisitor->dbvBindValues().first().first().toInt());
+    EXPECT_FALSE(dbvisitor->visitorData());
+    delete note;
+    delete dbvisitor;
+}
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_vnotedbconnectionpool.h"
+#include "db/vnotedbconnectionpool.h"
+
+#include <QDir>
+#include <QThread>
+
+UT_VNoteDbConnectionPool::UT_VNoteDbConnectionPool()
+{
+}
+
+TEST_F(UT_VNoteDbConnectionPool, UT_VNoteDbConnectionPool_connection_001)
+{
+    VNoteDbConnectionPool pool(QDir::tempPath() + "/ut_connectionpool.db", "ut_connectionpool");
+    pool.setConnectionPragmas({"PRAGMA synchronous=NORMAL;"});
+    EXPECT_FALSE(pool.hasConnection());
+
+    VNoteDbConnectionPool::Connection *conn = pool.connection();
+    EXPECT_TRUE(pool.hasConnection());
+    EXPECT_TRUE(conn->db.isOpen());
+    //同一线程复用连接
+    EXPECT_EQ(conn, pool.connection());
+
+    pool.releaseConnection();
+    EXPECT_FALSE(pool.hasConnection());
+}
+
+TEST_F(UT_VNoteDbConnectionPool, UT_VNoteDbConnectionPool_connection_002)
+{
+    VNoteDbConnectionPool pool(QDir::tempPath() + "/ut_connectionpool.db", "ut_connectionpool");
+    QString mainConnection = pool.connection()->connectionName;
+    QString threadConnection;
+
+    QThread *thread = QThread::create([&]() {
+        threadConnection = pool.connection()->connectionName;
+    });
+    thread->start();
+    thread->wait();
+    delete thread;
+
+    //不同线程使用不同连接，线程退出后释放
+    EXPECT_NE(mainConnection, threadConnection);
+    EXPECT_FALSE(QSqlDatabase::contains(threadConnection));
+}
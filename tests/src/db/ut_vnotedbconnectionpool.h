@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_VNOTEDBCONNECTIONPOOL_H
+#define UT_VNOTEDBCONNECTIONPOOL_H
+
+#include "gtest/gtest.h"
+#include <QTest>
+#include <QObject>
+
+class UT_VNoteDbConnectionPool : public QObject
+    , public ::testing::Test
+{
+    Q_OBJECT
+public:
+    UT_VNoteDbConnectionPool();
+};
+
+#endif // UT_VNOTEDBCONNECTIONPOOL_H
@@ -17,6 +17,23 @@ static bool stub_true()
     return true;
 }
 
+static bool stub_false()
+{
+    return false;
+}
+
+static int stub_zero()
+{
+    return 0;
+}
+
+static int g_migrateCount = 0;
+static bool stub_migrate()
+{
+    ++g_migrateCount;
+    return true;
+}
+
 UT_VNoteDbManager::UT_VNoteDbManager()
 {
 }
@@ -24,7 +41,7 @@ UT_VNoteDbManager::UT_VNoteDbManager()
 TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_initVNoteDb_001)
 {
     VNoteDbManager::instance()->initVNoteDb();
-    EXPECT_TRUE(VNoteDbManager::instance()->m_vnoteDB.isValid());
+    EXPECT_TRUE(VNoteDbManager::instance()->getVNoteDb().isValid());
 }
 
 TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_getVNoteDb_001)
@@ -76,3 +93,103 @@ TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_createTablesIfNeed_001)
     VNoteDbManager *instance = VNoteDbManager::instance();
     instance->createTablesIfNeed();
 }
+
+TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_cachedQuery_001)
+{
+    VNoteDbManager *instance = VNoteDbManager::instance();
+    VNoteItem note;
+    UpdateNoteTopDbVisitor visitor(instance->getVNoteDb(), &note, nullptr);
+    EXPECT_TRUE(instance->updateData(&visitor));
+    QSqlQuery *stmt = instance->cachedQuery(visitor.dbvSqls().first());
+    EXPECT_FALSE(nullptr == stmt);
+    EXPECT_EQ(stmt, instance->cachedQuery(visitor.dbvSqls().first()));
+}
+
+TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_transaction_001)
+{
+    VNoteDbManager *instance = VNoteDbManager::instance();
+    EXPECT_TRUE(instance->beginTransaction());
+    EXPECT_TRUE(instance->beginTransaction());
+    instance->rollbackTransaction();
+    //外层事务已失败时不能开始新的操作
+    EXPECT_FALSE(instance->beginTransaction());
+    EXPECT_EQ(1, instance->m_transactionDepth);
+    //内层回滚后外层提交失败
+    EXPECT_FALSE(instance->commitTransaction());
+    EXPECT_EQ(0, instance->m_transactionDepth);
+    EXPECT_TRUE(instance->beginTransaction());
+    EXPECT_TRUE(instance->commitTransaction());
+}
+
+TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_isReadOnly_001)
+{
+    VNoteDbManager *instance = VNoteDbManager::instance();
+    qint64 id = 0;
+    MaxIdFolderDbVisitor queryVisitor(instance->getVNoteDb(), nullptr, &id);
+    EXPECT_TRUE(queryVisitor.prepareSqls());
+    EXPECT_TRUE(instance->isOwnConnection(&queryVisitor));
+    EXPECT_TRUE(instance->isReadOnly(&queryVisitor));
+
+    MaxIdFolderDbVisitor resetVisitor(instance->getVNoteDb(), nullptr, &id);
+    resetVisitor.extraData().data.flag = true;
+    EXPECT_TRUE(resetVisitor.prepareSqls());
+    EXPECT_FALSE(instance->isReadOnly(&resetVisitor));
+}
+
+TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_upgradeSchemaIfNeed_001)
+{
+    VNoteDbManager *instance = VNoteDbManager::instance();
+    EXPECT_TRUE(instance->upgradeSchemaIfNeed());
+    EXPECT_EQ(VNoteDbManager::SCHEMA_VERSION, instance->schemaVersion());
+    //已是最新版本时重复执行不做修改
+    EXPECT_TRUE(instance->upgradeSchemaIfNeed());
+    EXPECT_EQ(VNoteDbManager::SCHEMA_VERSION, instance->schemaVersion());
+}
+
+TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_upgradeSchemaIfNeed_002)
+{
+    //开始事务失败时不执行任何升级步骤
+    VNoteDbManager *instance = VNoteDbManager::instance();
+    Stub stub;
+    g_migrateCount = 0;
+    stub.set(ADDR(VNoteDbManager, schemaVersion), stub_zero);
+    stub.set(ADDR(VNoteDbManager, migrateToV1), stub_migrate);
+    stub.set(ADDR(QSqlDatabase, transaction), stub_false);
+    EXPECT_FALSE(instance->upgradeSchemaIfNeed());
+    EXPECT_EQ(0, g_migrateCount);
+}
+
+TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_buildFullTextIndex_001)
+{
+    VNoteDbManager *instance = VNoteDbManager::instance();
+    EXPECT_TRUE(instance->upgradeSchemaIfPending());
+
+    if (!instance->hasFullTextTable()) {
+        EXPECT_FALSE(instance->buildFullTextIndex());
+        return;
+    }
+
+    //模拟导入未完成，搜索不使用全文索引
+    instance->m_hasFullTextIndex.storeRelease(0);
+    EXPECT_FALSE(instance->hasFullTextIndex());
+    EXPECT_TRUE(instance->buildFullTextIndex());
+    EXPECT_TRUE(instance->hasFullTextIndex());
+}
+
+TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_maintenance_001)
+{
+    VNoteDbManager *instance = VNoteDbManager::instance();
+    int serial = instance->writeSerial();
+    EXPECT_TRUE(instance->beginTransaction());
+    EXPECT_TRUE(instance->commitTransaction());
+    EXPECT_EQ(serial + 1, instance->writeSerial());
+
+    EXPECT_LE(0, instance->freeSpaceBytes());
+    EXPECT_TRUE(instance->analyze());
+    EXPECT_TRUE(instance->quickCheck());
+
+    //新建的数据库建表前已设置增量清理模式，不需要转换
+    if (instance->isIncrementalVacuum()) {
+        EXPECT_TRUE(instance->incrementalVacuum(16));
+    }
+}
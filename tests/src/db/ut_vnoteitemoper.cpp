@@ -27,6 +27,14 @@ static VNoteItem *stub_null()
     return nullptr;
 }
 
+static int s_moveNotesCount = 0;
+
+static bool stub_moveNotes()
+{
+    s_moveNotesCount++;
+    return true;
+}
+
 UT_VNoteItemOper::UT_VNoteItemOper()
 {
 }
@@ -35,9 +43,9 @@ void UT_VNoteItemOper::SetUp()
 {
     VNOTE_ALL_NOTES_MAP *notes = VNoteDataManager::instance()->getAllNotesInFolder();
     if (notes && !notes->notes.isEmpty()) {
-        VNOTE_ITEMS_MAP *tmp = notes->notes.first();
+        VNOTE_ITEMS_MAP *tmp = notes->notes.begin().value();
         if (tmp && !tmp->folderNotes.isEmpty()) {
-            m_note = tmp->folderNotes.first();
+            m_note = tmp->folderNotes.begin().value();
         }
     }
 
@@ -74,6 +82,7 @@ TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_updateNote_001)
 {
     Stub stub;
     stub.set(ADDR(VNoteDbManager, updateData), stub_false);
+    m_note->contentHash = 0;
     EXPECT_FALSE(m_vnoteitemoper->updateNote());
 }
 
@@ -84,6 +93,20 @@ TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_updateNote_002)
     EXPECT_TRUE(m_vnoteitemoper->updateNote());
 }
 
+TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_updateNote_003)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteDbManager, updateData), stub_true);
+    m_note->contentHash = 0;
+    EXPECT_TRUE(m_vnoteitemoper->updateNote());
+    EXPECT_NE(0, m_note->contentHash);
+    //内容未变化，不访问数据库
+    QDateTime modifyTime = m_note->modifyTime;
+    stub.set(ADDR(VNoteDbManager, updateData), stub_false);
+    EXPECT_TRUE(m_vnoteitemoper->updateNote());
+    EXPECT_EQ(modifyTime, m_note->modifyTime);
+}
+
 TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_addNote_001)
 {
     Stub stub;
@@ -151,6 +174,19 @@ TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_deleteNote_002)
     EXPECT_TRUE(op.deleteNote());
 }
 
+TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_deleteNotes_001)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteDbManager, deleteData), stub_false);
+    qint32 maxNoteId = m_note->folder()->maxNoteIdRef();
+    QList<VNoteItem *> notes;
+    notes.append(m_note);
+    EXPECT_FALSE(m_vnoteitemoper->deleteNotes(notes));
+    EXPECT_EQ(maxNoteId, m_note->folder()->maxNoteIdRef());
+    EXPECT_TRUE(m_vnoteitemoper->getNote(m_note->folderId, m_note->noteId));
+    EXPECT_FALSE(m_vnoteitemoper->deleteNotes(QList<VNoteItem *>()));
+}
+
 TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_getDefaultVoiceName_001)
 {
     m_vnoteitemoper->getDefaultVoiceName();
@@ -191,6 +227,64 @@ TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_updateFolderId_002)
     EXPECT_TRUE(m_vnoteitemoper->updateFolderId(m_note));
 }
 
+TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_updateFolderId_003)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteDbManager, updateData), stub_false);
+    QList<VNoteItem *> notes;
+    notes.append(m_note);
+    EXPECT_FALSE(m_vnoteitemoper->updateFolderId(notes));
+}
+
+TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_moveNotes_001)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteDbManager, updateData), stub_false);
+    stub.set(ADDR(VNoteDataManager, moveNotes), stub_moveNotes);
+    s_moveNotesCount = 0;
+    VNoteItem note;
+    note.noteId = 1;
+    note.folderId = 1;
+    EXPECT_FALSE(m_vnoteitemoper->moveNotes({&note}, 2));
+    EXPECT_EQ(1, note.folderId);
+    EXPECT_EQ(0, s_moveNotesCount);
+
+    stub.set(ADDR(VNoteDbManager, updateData), stub_true);
+    EXPECT_TRUE(m_vnoteitemoper->moveNotes({&note}, 2));
+    EXPECT_EQ(1, note.folderId);
+    EXPECT_EQ(1, s_moveNotesCount);
+}
+
+TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_updateTop_004)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteDbManager, updateData), stub_false);
+    int isTop = m_note->isTop;
+    QList<VNoteItem *> notes;
+    notes.append(m_note);
+    EXPECT_FALSE(m_vnoteitemoper->updateTop(notes, isTop));
+    EXPECT_FALSE(m_vnoteitemoper->updateTop(notes, !isTop));
+    EXPECT_EQ(isTop, m_note->isTop);
+}
+
+TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_loadNoteBody_001)
+{
+    VNoteItemOper op;
+    EXPECT_FALSE(op.loadNoteBody());
+    VNoteItem tmpNote;
+    VNoteItemOper loadedOp(&tmpNote);
+    EXPECT_TRUE(loadedOp.loadNoteBody());
+    tmpNote.bodyLoaded = false;
+    EXPECT_FALSE(loadedOp.updateNote());
+}
+
+TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_searchNotes_001)
+{
+    QSet<qint32> noteIds;
+    EXPECT_FALSE(m_vnoteitemoper->searchNotes("", noteIds));
+    EXPECT_EQ(VNoteDbManager::instance()->hasFullTextIndex(), m_vnoteitemoper->searchNotes("test", noteIds));
+}
+
 TEST_F(UT_VNoteItemOper, UT_VNoteItemOper_getNote_001)
 {
     EXPECT_TRUE(m_vnoteitemoper->getNote(m_note->folderId, m_note->noteId));
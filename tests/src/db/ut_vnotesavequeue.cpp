@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_vnotesavequeue.h"
+#include "db/vnotesavequeue.h"
+#include "db/vnotedbmanager.h"
+#include "common/vnoteitem.h"
+
+#include <QTimer>
+#include <stub.h>
+
+static bool stub_true()
+{
+    return true;
+}
+
+static bool stub_false()
+{
+    return false;
+}
+
+static int g_scheduleCount = 0;
+static void stub_scheduleCommit(void *, int)
+{
+    ++g_scheduleCount;
+}
+
+UT_VNoteSaveQueue::UT_VNoteSaveQueue()
+{
+}
+
+void UT_VNoteSaveQueue::SetUp()
+{
+    m_savequeue = new VNoteSaveQueue;
+    //不启动保存线程，由用例手动提交
+    m_savequeue->m_commitScheduled = true;
+}
+
+void UT_VNoteSaveQueue::TearDown()
+{
+    delete m_savequeue;
+}
+
+TEST_F(UT_VNoteSaveQueue, UT_VNoteSaveQueue_enqueue_001)
+{
+    VNoteItem note;
+    note.noteId = 1;
+    m_savequeue->enqueue(nullptr);
+    EXPECT_EQ(0, m_savequeue->pendingCount());
+    m_savequeue->enqueue(&note);
+    note.htmlCode = "test";
+    m_savequeue->enqueue(&note);
+    EXPECT_EQ(1, m_savequeue->pendingCount());
+    EXPECT_EQ(QString("test"), m_savequeue->m_pendingNotes.value(1)->htmlCode);
+
+    Stub stub;
+    stub.set(ADDR(VNoteDbManager, updateData), stub_true);
+    EXPECT_TRUE(m_savequeue->flush());
+    EXPECT_EQ(0, m_savequeue->pendingCount());
+}
+
+TEST_F(UT_VNoteSaveQueue, UT_VNoteSaveQueue_commitSoon_001)
+{
+    VNoteItem note;
+    note.noteId = 1;
+
+    Stub stub;
+    g_scheduleCount = 0;
+    stub.set(ADDR(VNoteSaveQueue, scheduleCommit), stub_scheduleCommit);
+    m_savequeue->m_commitScheduled = false;
+
+    //保存只重新开始合并等待，不立即提交
+    m_savequeue->enqueue(&note);
+    m_savequeue->enqueue(&note);
+    EXPECT_TRUE(m_savequeue->m_coalesceTimer->isActive());
+    EXPECT_EQ(0, g_scheduleCount);
+
+    m_savequeue->commitSoon();
+    m_savequeue->commitSoon();
+    EXPECT_EQ(1, g_scheduleCount);
+
+    m_savequeue->m_commitScheduled = true;
+    stub.set(ADDR(VNoteDbManager, updateData), stub_true);
+    EXPECT_TRUE(m_savequeue->flush());
+}
+
+TEST_F(UT_VNoteSaveQueue, UT_VNoteSaveQueue_flush_001)
+{
+    VNoteItem note;
+    note.noteId = 1;
+    m_savequeue->enqueue(&note);
+
+    Stub stub;
+    g_scheduleCount = 0;
+    stub.set(ADDR(VNoteSaveQueue, scheduleCommit), stub_scheduleCommit);
+    stub.set(ADDR(VNoteDbManager, updateData), stub_false);
+    m_savequeue->m_commitScheduled = false;
+    EXPECT_FALSE(m_savequeue->flush());
+    EXPECT_EQ(1, m_savequeue->pendingCount());
+    //失败后安排延迟重试
+    EXPECT_TRUE(m_savequeue->m_commitScheduled);
+    EXPECT_EQ(1, g_scheduleCount);
+    stub.set(ADDR(VNoteDbManager, updateData), stub_true);
+    EXPECT_TRUE(m_savequeue->flush());
+    EXPECT_EQ(0, m_savequeue->pendingCount());
+}
+
+TEST_F(UT_VNoteSaveQueue, UT_VNoteSaveQueue_discard_001)
+{
+    VNoteItem note;
+    note.noteId = 1;
+    note.setMetadata(QVariant(QString("pending")));
+    m_savequeue->enqueue(&note);
+
+    QVariant metaData;
+    EXPECT_FALSE(m_savequeue->pendingMetaData(2, metaData));
+    EXPECT_TRUE(m_savequeue->pendingMetaData(1, metaData));
+    EXPECT_EQ(QString("pending"), metaData.toString());
+
+    EXPECT_TRUE(m_savequeue->discard(1));
+    EXPECT_EQ(0, m_savequeue->pendingCount());
+    EXPECT_FALSE(m_savequeue->pendingMetaData(1, metaData));
+    EXPECT_FALSE(m_savequeue->discard(1));
+
+    //正在提交的快照只标记，不再读取
+    VNoteItem *committing = new VNoteItem();
+    committing->noteId = 3;
+    m_savequeue->m_committingNotes.insert(3, committing);
+    EXPECT_TRUE(m_savequeue->pendingMetaData(3, metaData));
+    EXPECT_TRUE(m_savequeue->discard(3));
+    EXPECT_TRUE(m_savequeue->m_supersededNotes.contains(3));
+    EXPECT_FALSE(m_savequeue->pendingMetaData(3, metaData));
+    m_savequeue->m_committingNotes.clear();
+    m_savequeue->m_supersededNotes.clear();
+    delete committing;
+}
@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_VNOTESAVEQUEUE_H
+#define UT_VNOTESAVEQUEUE_H
+
+#include "gtest/gtest.h"
+#include <QTest>
+#include <QObject>
+
+class VNoteSaveQueue;
+class UT_VNoteSaveQueue : public QObject
+    , public ::testing::Test
+{
+    Q_OBJECT
+public:
+    UT_VNoteSaveQueue();
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+
+protected:
+    VNoteSaveQueue *m_savequeue {nullptr};
+};
+
+#endif // UT_VNOTESAVEQUEUE_H
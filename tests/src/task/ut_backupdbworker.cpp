@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_backupdbworker.h"
+#include "task/backupdbworker.h"
+#include "db/vnotedbmanager.h"
+
+#include <QFile>
+#include <QDir>
+
+UT_BackupDbWorker::UT_BackupDbWorker()
+{
+}
+
+TEST_F(UT_BackupDbWorker, UT_BackupDbWorker_run_001)
+{
+    QString dbPath = VNoteDbManager::instance()->databasePath();
+    ASSERT_FALSE(dbPath.isEmpty());
+
+    BackupDbWorker worker(dbPath, 1);
+    worker.run();
+
+    QStringList files = BackupDbWorker::backupFiles(dbPath);
+    ASSERT_EQ(1, files.size());
+    EXPECT_FALSE(BackupDbWorker::isBackupDue(dbPath, 24));
+    EXPECT_TRUE(BackupDbWorker::isBackupDue(dbPath, 0));
+
+    QFile::remove(files.first());
+    EXPECT_TRUE(BackupDbWorker::isBackupDue(dbPath, 24));
+}
+
+TEST_F(UT_BackupDbWorker, UT_BackupDbWorker_removeExpiredBackups_001)
+{
+    QString dbPath = VNoteDbManager::instance()->databasePath();
+    QDir backupDir(BackupDbWorker::backupDirPath(dbPath));
+    backupDir.mkpath(backupDir.path());
+
+    QString baseName = QFileInfo(dbPath).completeBaseName();
+    QStringList names = {baseName + "-20200101000000.db", baseName + "-20200102000000.db"};
+
+    for (auto name : names) {
+        QFile file(backupDir.filePath(name));
+        file.open(QIODevice::WriteOnly);
+    }
+
+    BackupDbWorker worker(dbPath, 1);
+    worker.removeExpiredBackups();
+
+    QStringList files = BackupDbWorker::backupFiles(dbPath);
+    ASSERT_EQ(1, files.size());
+    EXPECT_EQ(backupDir.filePath(names.last()), files.first());
+
+    QFile::remove(files.first());
+}
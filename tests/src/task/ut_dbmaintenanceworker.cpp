@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_dbmaintenanceworker.h"
+#include "task/dbmaintenanceworker.h"
+#include "db/vnotedbmanager.h"
+
+#include <stub.h>
+
+#include <QSignalSpy>
+
+static bool stub_false()
+{
+    return false;
+}
+
+static qint64 stub_freeSpaceBytes()
+{
+    return 4096;
+}
+
+static int g_vacuumCount = 0;
+static bool stub_incrementalVacuum(void *, int)
+{
+    ++g_vacuumCount;
+    return true;
+}
+
+UT_DbMaintenanceWorker::UT_DbMaintenanceWorker()
+{
+}
+
+TEST_F(UT_DbMaintenanceWorker, UT_DbMaintenanceWorker_run_001)
+{
+    DbMaintenanceWorker worker(true);
+    QSignalSpy spy(&worker, &DbMaintenanceWorker::maintenanceFinished);
+    worker.run();
+
+    ASSERT_EQ(1, spy.count());
+    EXPECT_LE(0, spy.at(0).at(0).toLongLong());
+    EXPECT_FALSE(spy.at(0).at(2).toBool());
+    EXPECT_EQ(0, DbMaintenanceWorker::s_running.loadAcquire());
+}
+
+TEST_F(UT_DbMaintenanceWorker, UT_DbMaintenanceWorker_isInterrupted_001)
+{
+    DbMaintenanceWorker worker;
+    worker.m_writeSerial = VNoteDbManager::instance()->writeSerial();
+    EXPECT_FALSE(worker.isInterrupted());
+
+    //有新的写事务时停止
+    VNoteDbManager::instance()->beginTransaction();
+    VNoteDbManager::instance()->commitTransaction();
+    EXPECT_TRUE(worker.isInterrupted());
+}
+
+TEST_F(UT_DbMaintenanceWorker, UT_DbMaintenanceWorker_run_002)
+{
+    //非增量模式的老数据库不回收空间，也不转换
+    Stub stub;
+    stub.set(ADDR(VNoteDbManager, isIncrementalVacuum), stub_false);
+    stub.set(ADDR(VNoteDbManager, freeSpaceBytes), stub_freeSpaceBytes);
+    stub.set(ADDR(VNoteDbManager, incrementalVacuum), stub_incrementalVacuum);
+    g_vacuumCount = 0;
+
+    DbMaintenanceWorker worker;
+    QSignalSpy spy(&worker, &DbMaintenanceWorker::maintenanceFinished);
+    worker.run();
+
+    ASSERT_EQ(1, spy.count());
+    EXPECT_EQ(0, spy.at(0).at(0).toLongLong());
+    EXPECT_EQ(0, g_vacuumCount);
+}
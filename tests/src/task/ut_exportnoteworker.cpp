@@ -14,10 +14,10 @@ void UT_ExportNoteWorker::SetUp()
 {
     VNOTE_ALL_NOTES_MAP *notes = VNoteDataManager::instance()->getAllNotesInFolder();
     if (notes && !notes->notes.isEmpty()) {
-        VNOTE_ITEMS_MAP *tmp = notes->notes.first();
+        VNOTE_ITEMS_MAP *tmp = notes->notes.begin().value();
         if (tmp && !tmp->folderNotes.isEmpty()) {
-            m_noteList.push_back(tmp->folderNotes.first());
-            for (auto it : tmp->folderNotes.first()->datas.dataConstRef()) {
+            m_noteList.push_back(tmp->folderNotes.begin().value());
+            for (auto it : tmp->folderNotes.begin().value()->datas.dataConstRef()) {
                 if (it->getType() == VNoteBlock::Voice) {
                     m_block = it;
                     break;
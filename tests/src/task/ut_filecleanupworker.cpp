@@ -13,26 +13,37 @@ UT_FileCleanupWorker::UT_FileCleanupWorker()
 
 void UT_FileCleanupWorker::SetUp()
 {
-    qspAllNotesMap = new VNOTE_ALL_NOTES_MAP();
-    voiceItem = new VNOTE_ITEMS_MAP();
-    qspAllNotesMap->notes.insert(0, voiceItem);
+    VNOTE_ALL_NOTES_MAP *notesMap = new VNOTE_ALL_NOTES_MAP();
+    notesMap->autoRelease = true;
+    VNOTE_ITEMS_MAP *voiceItem = new VNOTE_ITEMS_MAP();
+    voiceItem->autoRelease = true;
+    notesMap->notes.insert(0, voiceItem);
     VNoteItem *note = new VNoteItem();
+    note->noteId = 0;
+    note->folderId = 0;
     note->htmlCode = "<div> <p> </div>";
-    voiceItem->folderNotes.insert(0, note);
-    voiceItem->autoRelease = true;
+    voiceItem->folderNotes.insert(note->noteId, note);
     VNoteItem *note2 = new VNoteItem();
-    voiceItem->folderNotes.insert(1, note2);
-    qspAllNotesMap->autoRelease = true;
+    note2->noteId = 1;
+    note2->folderId = 0;
+    voiceItem->folderNotes.insert(note2->noteId, note2);
+
+    //通过数据管理发布快照，与清理任务实际使用的快照一致
+    dataManager = new VNoteDataManager();
+    dataManager->onNotesBatchLoaded(notesMap);
+    snapshot = dataManager->notesSnapshot();
 }
 
 void UT_FileCleanupWorker::TearDown()
 {
-    delete qspAllNotesMap;
+    snapshot.reset();
+    delete dataManager;
+    dataManager = nullptr;
 }
 
 TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_run_001)
 {
-    FileCleanupWorker *work = new FileCleanupWorker(nullptr);
+    FileCleanupWorker *work = new FileCleanupWorker(VNOTE_NOTES_SNAPSHOT());
     work->run();
 
     delete work;
@@ -40,28 +51,30 @@ TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_run_001)
 
 TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_run_002)
 {
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    ASSERT_FALSE(snapshot.isNull());
+    EXPECT_EQ(2, snapshot->folderNotes.value(0).size());
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     work->run();
     delete work;
 }
 
 TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_cleanVoice_001)
 {
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     work->cleanVoice();
     delete work;
 }
 
 TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_cleanPicture_001)
 {
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     work->cleanPicture();
     delete work;
 }
 
 TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_fillVoiceSet_001)
 {
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
     QDir(dirPath).mkdir("/voicenote");
     work->fillVoiceSet();
@@ -73,7 +86,7 @@ TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_fillVoiceSet_001)
 
 TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_fillPictureSet_001)
 {
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
     QDir(dirPath).mkdir("/images");
     work->fillPictureSet();
@@ -85,7 +98,7 @@ TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_fillPictureSet_001)
 
 TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_scanAllNotes_001)
 {
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     work->scanAllNotes();
 
     delete work;
@@ -93,7 +106,7 @@ TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_scanAllNotes_001)
 
 TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_removeVoicePathBySet_001)
 {
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     work->removeVoicePathBySet("");
     work->removeVoicePathBySet("/test");
     delete work;
@@ -101,7 +114,7 @@ TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_removeVoicePathBySet_001)
 
 TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_removePicturePathBySet_001)
 {
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     work->removePicturePathBySet("");
     work->removePicturePathBySet("/test");
     delete work;
@@ -109,7 +122,7 @@ TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_removePicturePathBySet_001)
 
 TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_scanVoiceByHtml_001)
 {
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     work->scanVoiceByHtml("");
 
     work->scanVoiceByHtml("test");
@@ -120,14 +133,14 @@ TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_scanVoiceByHtml_002)
 {
     QString metadata = "<div jsonkey=\"/test/test/voicenote/sad23.mp3\"> </div>";
 
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     work->scanVoiceByHtml(metadata);
     delete work;
 }
 
 TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_scanPictureByHtml_001)
 {
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     work->scanPictureByHtml("");
 
     work->scanPictureByHtml("test");
@@ -138,7 +151,7 @@ TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_scanPictureByHtml_002)
 {
     QString metadata = "<div <img src=\"/test/test/images/test.jpg\"> </div>";
 
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     work->scanPictureByHtml(metadata);
     delete work;
 }
@@ -148,7 +161,7 @@ TEST_F(UT_FileCleanupWorker, UT_FileCleanupWorker_scanVoiceByBlocks_001)
     VNOTE_DATAS note;
     VNVoiceBlock *voice = new VNVoiceBlock();
     note.voiceBlocks.push_back(voice);
-    FileCleanupWorker *work = new FileCleanupWorker(qspAllNotesMap);
+    FileCleanupWorker *work = new FileCleanupWorker(snapshot);
     work->scanVoiceByBlocks(note);
     delete voice;
     delete work;
@@ -8,6 +8,7 @@
 
 #include "filecleanupworker.h"
 #include "common/vnoteitem.h"
+#include "common/vnotedatamanager.h"
 #include "gtest/gtest.h"
 #include <QTest>
 #include <QObject>
@@ -24,8 +25,8 @@ protected:
     virtual void TearDown() override;
 
 private:
-    VNOTE_ALL_NOTES_MAP *qspAllNotesMap {nullptr};
-    VNOTE_ITEMS_MAP *voiceItem {nullptr};
+    VNoteDataManager *dataManager {nullptr};
+    VNOTE_NOTES_SNAPSHOT snapshot;
 };
 
 #endif // UT_FILECLEANUPWORKER_H
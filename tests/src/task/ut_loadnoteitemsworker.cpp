@@ -5,6 +5,17 @@
 
 #include "ut_loadnoteitemsworker.h"
 #include "task/loadnoteitemsworker.h"
+#include "db/vnoteitemoper.h"
+#include <stub.h>
+
+#include <QSignalSpy>
+
+static QList<VNOTE_NOTES_RANGE> g_loadRanges;
+static VNOTE_ALL_NOTES_MAP *stub_loadVNotes(void *, const VNOTE_NOTES_RANGE &range)
+{
+    g_loadRanges.append(range);
+    return new VNOTE_ALL_NOTES_MAP();
+}
 
 UT_LoadNoteItemsWorker::UT_LoadNoteItemsWorker(QObject *parent)
     : QObject(parent)
@@ -23,6 +34,32 @@ void UT_LoadNoteItemsWorker::onNoteLoad(VNOTE_ALL_NOTES_MAP *notesMap)
 TEST_F(UT_LoadNoteItemsWorker, UT_LoadNoteItemsWorker_run_001)
 {
     LoadNoteItemsWorker work;
-    connect(&work, &LoadNoteItemsWorker::onAllNotesLoaded, this, &UT_LoadNoteItemsWorker::onNoteLoad);
+    connect(&work, &LoadNoteItemsWorker::onNotesBatchLoaded, this, &UT_LoadNoteItemsWorker::onNoteLoad);
+    work.run();
+}
+
+TEST_F(UT_LoadNoteItemsWorker, UT_LoadNoteItemsWorker_run_002)
+{
+    LoadNoteItemsWorker work(1);
+    QSignalSpy spy(&work, &LoadNoteItemsWorker::onAllNotesLoaded);
+    connect(&work, &LoadNoteItemsWorker::onNotesBatchLoaded, this, &UT_LoadNoteItemsWorker::onNoteLoad);
     work.run();
+    EXPECT_EQ(1, spy.count());
+}
+
+TEST_F(UT_LoadNoteItemsWorker, UT_LoadNoteItemsWorker_run_003)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteItemOper, loadVNotes), stub_loadVNotes);
+    g_loadRanges.clear();
+
+    //优先记事本同样分批加载
+    LoadNoteItemsWorker work(1);
+    work.run();
+
+    ASSERT_EQ(2, g_loadRanges.size());
+    EXPECT_EQ(1, g_loadRanges.at(0).folderId);
+    EXPECT_EQ(LoadNoteItemsWorker::NOTES_BATCH_SIZE, g_loadRanges.at(0).limit);
+    EXPECT_EQ(1, g_loadRanges.at(1).excludeFolderId);
+    EXPECT_EQ(LoadNoteItemsWorker::NOTES_BATCH_SIZE, g_loadRanges.at(1).limit);
 }
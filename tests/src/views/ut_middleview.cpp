@@ -257,6 +257,22 @@ TEST_F(UT_MiddleView, appendRow)
     delete noteData1;
 }
 
+TEST_F(UT_MiddleView, appendRows)
+{
+    MiddleView middleview;
+    VNoteItem *noteData = new VNoteItem;
+    noteData->noteId = 1;
+    VNoteItem *noteData1 = new VNoteItem;
+    noteData1->noteId = 2;
+    middleview.appendRows({noteData, nullptr, noteData1});
+    EXPECT_EQ(2, middleview.rowCount());
+    EXPECT_TRUE(middleview.noteIndex(1).isValid());
+    EXPECT_TRUE(middleview.noteIndex(2).isValid());
+    middleview.clearAll();
+    delete noteData;
+    delete noteData1;
+}
+
 TEST_F(UT_MiddleView, rowCount)
 {
     MiddleView middleview;
@@ -499,6 +515,17 @@ TEST_F(UT_MiddleView, getCurrVNotedataList)
     EXPECT_FALSE(notes.isEmpty());
 }
 
+TEST_F(UT_MiddleView, noteStickOnTop)
+{
+    m_middleView->selectAll();
+    bool isAllTop = m_middleView->isAllSelectedTop();
+    //多选时一起置顶或取消置顶
+    m_middleView->noteStickOnTop();
+    EXPECT_NE(isAllTop, m_middleView->isAllSelectedTop());
+    m_middleView->noteStickOnTop();
+    EXPECT_EQ(isAllTop, m_middleView->isAllSelectedTop());
+}
+
 TEST_F(UT_MiddleView, getCurrVNotedata)
 {
     m_middleView->setCurrentIndex(0);